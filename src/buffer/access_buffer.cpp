@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_buffer.cpp
+//
+// Identification: src/buffer/access_buffer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/access_buffer.h"
+
+namespace bustub {
+
+// A record fits in one word: the page id in the high half, then the frame id, the access flag and the access type.
+static constexpr uint64_t ACCESS_TYPE_BITS = 3;
+static constexpr uint64_t FRAME_ID_SHIFT = ACCESS_TYPE_BITS + 1;
+static constexpr uint64_t MAX_FRAMES = uint64_t{1} << (32 - FRAME_ID_SHIFT);
+
+AccessBuffer::AccessBuffer(size_t capacity) {
+  capacity_ = 1;
+  while (capacity_ < capacity) {
+    capacity_ *= 2;
+  }
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+auto AccessBuffer::Pack(const AccessRecord &record) -> uint64_t {
+  BUSTUB_ASSERT(record.frame_id_ >= 0 && static_cast<uint64_t>(record.frame_id_) < MAX_FRAMES, "frame id too large");
+  return static_cast<uint64_t>(static_cast<uint32_t>(record.page_id_)) << 32 |
+         static_cast<uint64_t>(record.frame_id_) << FRAME_ID_SHIFT |
+         static_cast<uint64_t>(record.is_access_) << ACCESS_TYPE_BITS | static_cast<uint64_t>(record.access_type_);
+}
+
+auto AccessBuffer::Unpack(uint64_t entry) -> AccessRecord {
+  return {static_cast<frame_id_t>((entry & 0xffffffff) >> FRAME_ID_SHIFT), static_cast<page_id_t>(entry >> 32),
+          ((entry >> ACCESS_TYPE_BITS) & 1) != 0,
+          static_cast<AccessType>(entry & ((uint64_t{1} << ACCESS_TYPE_BITS) - 1))};
+}
+
+auto AccessBuffer::Push(const AccessRecord &record) -> bool {
+  uint64_t position = tail_.fetch_add(1, std::memory_order_relaxed);
+  slots_[position & (capacity_ - 1)].store(Pack(record), std::memory_order_release);
+  return position + 1 - head_.load(std::memory_order_relaxed) >= capacity_ / 2;
+}
+
+void AccessBuffer::Drain(const std::function<void(const AccessRecord &)> &apply) {
+  uint64_t tail = tail_.load(std::memory_order_acquire);
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  // Records older than one lap have been overwritten.
+  if (tail - head > capacity_) {
+    head = tail - capacity_;
+  }
+  for (; head < tail; head++) {
+    // A slot may still be empty if its producer has not stored its record yet; that record is seen next lap.
+    uint64_t entry = slots_[head & (capacity_ - 1)].exchange(EMPTY, std::memory_order_acq_rel);
+    if (entry != EMPTY) {
+      apply(Unpack(entry));
+    }
+  }
+  head_.store(tail, std::memory_order_relaxed);
+}
+
+}  // namespace bustub
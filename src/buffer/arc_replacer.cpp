@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : node_store_(num_frames) {}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  bool from_recent = EvictFromRecent(recent_size_, !recent_frames_.empty(), !frequent_frames_.empty());
+  auto &candidates = from_recent ? recent_frames_ : frequent_frames_;
+  if (candidates.empty()) {
+    return false;
+  }
+  *frame_id = candidates.begin()->second;
+  candidates.erase(candidates.begin());
+  Drop(*frame_id, true);
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  ARCNode &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.list_ == List::None) {
+    // A miss. A page found in a ghost list tells which list should have kept it.
+    size_t capacity = node_store_.size();
+    node.list_ = List::Recent;
+    if (page_id != INVALID_PAGE_ID && recent_ghosts_.Erase(page_id) && !is_scan) {
+      size_t delta = std::max<size_t>(frequent_ghosts_.Size() / (recent_ghosts_.Size() + 1), 1);
+      target_ = std::min(target_ + delta, capacity);
+      node.list_ = List::Frequent;
+    } else if (page_id != INVALID_PAGE_ID && frequent_ghosts_.Erase(page_id) && !is_scan) {
+      size_t delta = std::max<size_t>(recent_ghosts_.Size() / (frequent_ghosts_.Size() + 1), 1);
+      target_ -= std::min(target_, delta);
+      node.list_ = List::Frequent;
+    }
+    node.key_ = ++current_timestamp_;
+    node.page_id_ = page_id;
+    (node.list_ == List::Recent ? recent_size_ : frequent_size_)++;
+    TrimGhosts();
+    return;
+  }
+  if (is_scan) {
+    return;
+  }
+  // A hit moves the frame to the most recently used end of T2.
+  if (node.is_evictable_) {
+    EvictionSetOf(node.list_).erase({node.key_, frame_id});
+  }
+  if (node.list_ == List::Recent) {
+    recent_size_--;
+    frequent_size_++;
+    node.list_ = List::Frequent;
+  }
+  node.key_ = ++current_timestamp_;
+  if (node.is_evictable_) {
+    frequent_frames_.emplace(node.key_, frame_id);
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  ARCNode &node = node_store_[frame_id];
+  if (node.list_ == List::None || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictionSetOf(node.list_).emplace(node.key_, frame_id);
+  } else {
+    EvictionSetOf(node.list_).erase({node.key_, frame_id});
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  ARCNode &node = node_store_[frame_id];
+  if (node.list_ == List::None) {
+    return;
+  }
+  if (!node.is_evictable_) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  EvictionSetOf(node.list_).erase({node.key_, frame_id});
+  Drop(frame_id, false);
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return recent_frames_.size() + frequent_frames_.size();
+}
+
+auto ARCReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  auto recent_it = recent_frames_.begin();
+  auto frequent_it = frequent_frames_.begin();
+  size_t recent_size = recent_size_;
+  while (frames.size() < max_frames) {
+    bool has_recent = recent_it != recent_frames_.end();
+    bool has_frequent = frequent_it != frequent_frames_.end();
+    if (!has_recent && !has_frequent) {
+      break;
+    }
+    if (EvictFromRecent(recent_size, has_recent, has_frequent)) {
+      frames.push_back((recent_it++)->second);
+      recent_size--;
+    } else {
+      frames.push_back((frequent_it++)->second);
+    }
+  }
+  return frames;
+}
+
+auto ARCReplacer::GetTarget() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return target_;
+}
+
+void ARCReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid frame id");
+  }
+}
+
+void ARCReplacer::Drop(frame_id_t frame_id, bool remember) {
+  ARCNode &node = node_store_[frame_id];
+  bool is_recent = node.list_ == List::Recent;
+  (is_recent ? recent_size_ : frequent_size_)--;
+  if (remember && node.page_id_ != INVALID_PAGE_ID) {
+    (is_recent ? recent_ghosts_ : frequent_ghosts_).PushBack(node.page_id_);
+    TrimGhosts();
+  }
+  node = ARCNode{};
+}
+
+void ARCReplacer::TrimGhosts() {
+  size_t capacity = node_store_.size();
+  while (recent_ghosts_.Size() > 0 && recent_size_ + recent_ghosts_.Size() > capacity) {
+    recent_ghosts_.PopFront();
+  }
+  while (frequent_ghosts_.Size() > 0 &&
+         recent_size_ + frequent_size_ + recent_ghosts_.Size() + frequent_ghosts_.Size() > 2 * capacity) {
+    frequent_ghosts_.PopFront();
+  }
+}
+
+}  // namespace bustub
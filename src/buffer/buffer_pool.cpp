@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool.cpp
+//
+// Identification: src/buffer/buffer_pool.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool.h"
+
+#include <algorithm>
+
+#include "buffer/hot_page_list.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+auto BufferPool::RegisterReadAhead(NextPageIdFn next_page_id) -> std::shared_ptr<ReadAheadScan> {
+  return std::make_shared<ReadAheadScan>(std::move(next_page_id));
+}
+
+void BufferPool::ReadAhead(const std::shared_ptr<ReadAheadScan> &scan, page_id_t page_id) {
+  size_t window = GetReadAheadWindow();
+  if (scan == nullptr || window == 0 || page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  {
+    std::scoped_lock scan_latch(scan->latch_);
+    scan->pages_scanned_++;
+    if (scan->pages_prefetched_ < scan->pages_scanned_) {
+      // first page of the scan, or the scan overtook the read-ahead thread: continue from where the scan is
+      scan->pages_prefetched_ = scan->pages_scanned_;
+      scan->last_prefetched_ = page_id;
+    }
+    // refill only once half of the window has been consumed, so that the thread loads pages in runs
+    if (scan->queued_ || scan->last_prefetched_ == INVALID_PAGE_ID ||
+        scan->pages_prefetched_ >= scan->pages_scanned_ + window / 2) {
+      return;
+    }
+    scan->queued_ = true;
+  }
+  std::call_once(read_ahead_started_, [this] { read_ahead_thread_ = std::thread([this] { ReadAheadWorker(); }); });
+  read_ahead_queue_.Put(scan);
+}
+
+void BufferPool::ReadAheadWorker() {
+  while (true) {
+    auto scan = read_ahead_queue_.Get();
+    if (!scan.has_value()) {
+      return;
+    }
+    auto &state = **scan;
+    while (true) {
+      page_id_t page_id;
+      {
+        std::scoped_lock scan_latch(state.latch_);
+        if (state.last_prefetched_ == INVALID_PAGE_ID ||
+            state.pages_prefetched_ >= state.pages_scanned_ + GetReadAheadWindow()) {
+          state.queued_ = false;
+          break;
+        }
+        page_id = state.last_prefetched_;
+      }
+
+      // The last prefetched page is normally still in the pool, look up its successor and load it.
+      page_id_t next_page_id = INVALID_PAGE_ID;
+      Page *page = FetchPage(page_id, AccessType::Scan);
+      if (page != nullptr) {
+        page->RLatch();
+        next_page_id = state.next_page_id_(page->GetData());
+        page->RUnlatch();
+        UnpinPage(page_id, false, AccessType::Scan);
+      }
+      Page *next_page = next_page_id == INVALID_PAGE_ID ? nullptr : FetchPage(next_page_id, AccessType::Scan);
+      if (next_page != nullptr) {
+        UnpinPage(next_page_id, false, AccessType::Scan);
+      }
+
+      std::scoped_lock scan_latch(state.latch_);
+      if (state.last_prefetched_ != page_id) {
+        // the scan moved past us in the meantime and reset the cursor
+        continue;
+      }
+      if (next_page == nullptr) {
+        // end of the chain, or no frame to load the page into
+        state.last_prefetched_ = INVALID_PAGE_ID;
+        state.queued_ = false;
+        break;
+      }
+      state.last_prefetched_ = next_page_id;
+      state.pages_prefetched_++;
+    }
+  }
+}
+
+void BufferPool::StopReadAhead() {
+  if (read_ahead_thread_.joinable()) {
+    read_ahead_queue_.Put(std::nullopt);
+    read_ahead_thread_.join();
+  }
+}
+
+auto BufferPool::DumpHotPages(const std::string &file_name) -> bool {
+  return HotPageList::Write(file_name, GetHotPages(GetPoolSize()));
+}
+
+void BufferPool::StartHotPageDumper(const std::string &file_name, std::chrono::milliseconds interval) {
+  std::scoped_lock lock(hot_page_latch_);
+  BUSTUB_ENSURE(!hot_page_thread_.joinable(), "hot page dumper is already running");
+  hot_page_stop_ = false;
+  hot_page_thread_ = std::thread([this, file_name, interval] { HotPageDumperWorker(file_name, interval); });
+}
+
+void BufferPool::StopHotPageDumper() {
+  {
+    std::scoped_lock lock(hot_page_latch_);
+    if (!hot_page_thread_.joinable()) {
+      return;
+    }
+    hot_page_stop_ = true;
+  }
+  hot_page_cv_.notify_one();
+  hot_page_thread_.join();
+}
+
+void BufferPool::HotPageDumperWorker(const std::string &file_name, std::chrono::milliseconds interval) {
+  std::unique_lock<std::mutex> lock(hot_page_latch_);
+  while (!hot_page_cv_.wait_for(lock, interval, [this] { return hot_page_stop_; })) {
+    lock.unlock();
+    DumpHotPages(file_name);
+    lock.lock();
+  }
+}
+
+auto BufferPool::StartPrewarm(const std::string &file_name, size_t budget) -> size_t {
+  BUSTUB_ENSURE(!prewarm_.valid(), "prewarm is already running");
+  budget = std::min(budget, GetPoolSize());
+  auto *free_page_map = disk_manager_->GetFreePageMap();
+  std::vector<page_id_t> page_ids;
+  for (auto page_id : HotPageList::Read(file_name)) {
+    if (page_ids.size() >= budget) {
+      break;
+    }
+    // The list may be older than the database file, skip the pages deallocated or compacted away since.
+    if (page_id >= 0 && page_id < free_page_map->GetNumPages() && !free_page_map->IsFree(page_id)) {
+      page_ids.push_back(page_id);
+    }
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  page_ids.erase(std::unique(page_ids.begin(), page_ids.end()), page_ids.end());
+
+  size_t num_pages = page_ids.size();
+  prewarm_stop_ = false;
+  prewarm_ = std::async(std::launch::async, [this, page_ids = std::move(page_ids)] {
+    size_t loaded = 0;
+    for (auto page_id : page_ids) {
+      if (prewarm_stop_) {
+        break;
+      }
+      if (PrewarmPage(page_id)) {
+        loaded++;
+      }
+    }
+    return loaded;
+  });
+  return num_pages;
+}
+
+auto BufferPool::WaitForPrewarm() -> size_t { return prewarm_.valid() ? prewarm_.get() : 0; }
+
+void BufferPool::StopPrewarm() {
+  prewarm_stop_ = true;
+  WaitForPrewarm();
+}
+
+}  // namespace bustub
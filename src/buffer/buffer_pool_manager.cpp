@@ -12,291 +12,771 @@
 
 #include "buffer/buffer_pool_manager.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
 #include "common/exception.h"
 #include "common/macros.h"
 #include "storage/page/page_guard.h"
 namespace bustub {
 
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, ReplacerType replacer_type, size_t num_io_workers)
+    : BufferPoolManager(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_type, num_io_workers) {}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                     DiskManager *disk_manager, size_t replacer_k, LogManager *log_manager,
+                                     ReplacerType replacer_type, size_t num_io_workers)
+    : BufferPool(disk_manager),
+      pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_scheduler_(std::make_unique<DiskScheduler>(disk_manager, num_io_workers)),
+      log_manager_(log_manager),
+      page_table_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "a standalone buffer pool is a single instance");
+  BUSTUB_ASSERT(instance_index < num_instances, "instance index must be smaller than the number of instances");
   // TODO(students): remove this line after you have implemented the buffer pool manager
   // throw NotImplementedException(
   //     "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
   //     "exception line in `buffer_pool_manager.cpp`.");
   // std::cout << pool_size << "    " << replacer_k << std::endl;
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+  // we allocate a consecutive memory space for the buffer pool, and the frames in one arena
+  frame_arena_ = std::make_unique<FrameArena>(pool_size_);
+  pages_ = static_cast<Page *>(operator new[](pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_arena_->GetFrame(i));
+  }
+  io_cv_ = std::vector<std::condition_variable>(pool_size_);
+  switch (replacer_type) {
+    case ReplacerType::LRUK:
+      replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+      break;
+    case ReplacerType::LRU:
+      replacer_ = std::make_unique<LRUReplacer>(pool_size);
+      break;
+    case ReplacerType::Clock:
+      replacer_ = std::make_unique<ClockReplacer>(pool_size);
+      break;
+    case ReplacerType::TwoQueue:
+      replacer_ = std::make_unique<TwoQueueReplacer>(pool_size);
+      break;
+    case ReplacerType::ARC:
+      replacer_ = std::make_unique<ARCReplacer>(pool_size);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
 }
-void BufferPoolManager::PrintPage() {
-  for (auto ii : page_table_) {
-    std::cout << ii.first << "   " << ii.second << "   ";
+
+BufferPoolManager::~BufferPoolManager() {
+  StopHotPageDumper();
+  StopPrewarm();
+  StopFlusher();
+  StopReadAhead();
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
   }
-  std::cout << std::endl;
+  operator delete[](pages_);
 }
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
 
 auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
-  // std::cout << "NewPage";
-  if (free_list_.empty() && replacer_->now_knode_.empty()) {
-    // throw std::logic_error("50  error");
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  if (!GetVictimFrame(&frame_id)) {
     return nullptr;
   }
+  *page_id = AllocatePage();
+  ReplaceFrame(lock, frame_id, *page_id);
 
-  frame_id_t new_frame_id;
-  if (!free_list_.empty()) {
-    new_frame_id = free_list_.front();
-    free_list_.pop_front();
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  FinishIo(frame_id);
+  return page;
+}
 
-  } else if (replacer_->Evict(&new_frame_id)) {
-    Page *vic = &pages_[new_frame_id];
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  frame_id_t frame_id;
+  if (PinResident(page_id, &frame_id)) {
+    stats_.Increment(BufferPoolCounters::Counter::Hit);
+    RecordLater({frame_id, page_id, true, access_type});
+    return &pages_[frame_id];
+  }
 
-    if (vic->IsDirty()) {
-      disk_manager_->WritePage(vic->GetPageId(), vic->GetData());
+  auto lock = LockLatch();
+  if (FindFrame(page_id, lock, &frame_id)) {
+    stats_.Increment(BufferPoolCounters::Counter::Hit);
+    Page *page = &pages_[frame_id];
+    replacer_->RecordAccess(frame_id, access_type, page_id);
+    if (page->pin_count_++ == 0) {
+      replacer_->SetEvictable(frame_id, false);
     }
-    page_table_.erase(vic->GetPageId());
-  } else {
-    // throw std::logic_error("67  error");
+    return page;
+  }
+
+  if (!GetVictimFrame(&frame_id)) {
     return nullptr;
   }
-  *page_id = AllocatePage();
-  // std::cout << *page_id << std::endl;
-  Page *new_page = &pages_[new_frame_id];
+  ReplaceFrame(lock, frame_id, page_id, access_type);
+  stats_.Increment(BufferPoolCounters::Counter::Miss);
+
+  // The frame is pinned and marked as under I/O, so nobody else touches its data while the latch is released.
+  Page *page = &pages_[frame_id];
+  lock.unlock();
+  ReadIntoFrame(page, page_id);
+  lock.lock();
+  FinishIo(frame_id);
+  return page;
+}
 
-  new_page->ResetMemory();  // 提供好的成员函数，直接调用就行
+auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].page_id_ != page_id ||
+      pages_[frame_id].io_in_progress_) {
+    // The lock-free lookup may miss while the page table is rearranged, ask again under the latch. Once the page is
+    // found the latch is not needed anymore: the caller's pin keeps the frame in place.
+    std::unique_lock<std::mutex> lock(latch_);
+    if (!FindFrame(page_id, lock, &frame_id)) {
+      return false;
+    }
+  }
+  Page &page = pages_[frame_id];
+  if (page.pin_count_ <= 0) {
+    return false;
+  }
+  if (is_dirty) {
+    page.is_dirty_ = true;
+  }
+  return UnpinResident(frame_id);
+}
 
-  new_page->is_dirty_ = false;
+auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID || !FindFrame(page_id, lock, &frame_id)) {
+    return false;
+  }
+  if (pages_[frame_id].IsDirty()) {
+    WriteBack(lock, {frame_id});
+  }
+  return true;
+}
+
+void BufferPoolManager::FlushAllPages() {
+  std::unique_lock<std::mutex> lock(latch_);
+  // Frames under I/O are skipped: they are either being read (and thus clean) or their previous page is already being
+  // written back.
+  std::vector<frame_id_t> frames;
+  for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+    Page &page = pages_[frame_id];
+    if (page.page_id_ != INVALID_PAGE_ID && !page.io_in_progress_ && page.IsDirty()) {
+      frames.push_back(static_cast<frame_id_t>(frame_id));
+    }
+  }
+  WriteBack(lock, frames);
+  lock.unlock();
+  disk_manager_->GetFreePageMap()->Flush();
+}
 
-  new_page->page_id_ = *page_id;
+auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (!FindFrame(page_id, lock, &frame_id)) {
+    DeallocatePage(page_id);
+    return true;
+  }
 
-  new_page->pin_count_++;
+  Page *page = &pages_[frame_id];
+  if (!ClaimFrame(frame_id)) {
+    return false;
+  }
 
-  replacer_->RecordAccess(new_frame_id);
+  if (page->IsDirty()) {
+    // Lookups of the page wait for the frame's I/O while the latch is released, as in ReplaceFrame().
+    page->io_in_progress_ = true;
+    lock.unlock();
+    FlushLog(page->GetLSN());
+    DoIo(true, page_id, page->GetData());
+    lock.lock();
+    FinishIo(frame_id);
+  }
 
-  page_table_.emplace(new_page->GetPageId(), new_frame_id);
-  // PrintPage();
-  // std::cout << std::this_thread::get_id() << "NewPage   " << replacer_->node_store_.size() << "  "
-  //           << replacer_->now_knode_.size() << std::endl;
-  // replacer_->now_knode_.size() << std::endl;
-  return new_page;
+  DetachView(frame_id, page_id);
+  page->ResetMemory();
+  page->is_dirty_ = false;
+  page->rec_lsn_ = INVALID_LSN;
+  page->page_id_ = INVALID_PAGE_ID;
+  page->pin_count_ = 0;
+  free_list_.push_back(frame_id);
+  // The replacer may not have heard of the last unpin yet.
+  replacer_->SetEvictable(frame_id, true);
+  replacer_->Remove(frame_id);
+  page_table_.Erase(page_id);
+  DeallocatePage(page_id);
+
+  return true;
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
-  // Page *new_page = nullptr;
-  // std::cout << std::this_thread::get_id() << "FetchPage" << page_id << std::endl;
-  if (page_table_.count(page_id) != 0) {
-    frame_id_t frame_id = page_table_[page_id];
-    replacer_->RecordAccess(frame_id);
-    Page *p = &pages_[frame_id];
-    if (p->pin_count_ == 0) {  // 注意因为由unpin减为0时 需要将其Evictable 设为false
-      replacer_->SetEvictable(frame_id, false);
+auto BufferPoolManager::FindFrame(page_id_t page_id, std::unique_lock<std::mutex> &lock, frame_id_t *frame_id)
+    -> bool {
+  while (true) {
+    frame_id_t candidate;
+    if (!page_table_.Find(page_id, &candidate)) {
+      return false;
     }
-    p->pin_count_++;
-    // PrintPage();
-    // std::cout << p->pin_count_ << std::endl;
-    return p;
-  }
-  if (free_list_.empty() && replacer_->now_knode_.empty()) {
-    // PrintPage();
-    // throw std::logic_error("108  error");
-    return nullptr;
+    if (!pages_[candidate].io_in_progress_) {
+      *frame_id = candidate;
+      return true;
+    }
+    // The mapping may change while we sleep (e.g. a write-back finished and the old page id is gone), so look the
+    // page up again once the I/O is done.
+    auto start = BufferPoolCounters::Clock::now();
+    io_cv_[candidate].wait(lock, [&] { return !pages_[candidate].io_in_progress_; });
+    stats_.Increment(BufferPoolCounters::Counter::PinWait);
+    stats_.RecordLatency(BufferPoolCounters::Latency::PinWait, start);
   }
-  // for (auto i : replacer_->now_knode_) {
-  //   std::cout << i << "   ";
-  // }
-  // std::cout << std::endl;
-  frame_id_t new_frame_id;
+}
+
+auto BufferPoolManager::GetVictimFrame(frame_id_t *frame_id) -> bool {
   if (!free_list_.empty()) {
-    new_frame_id = free_list_.front();
+    *frame_id = free_list_.front();
     free_list_.pop_front();
-  } else {
-    replacer_->Evict(&new_frame_id);
-    Page *vic = &pages_[new_frame_id];
+    // A hit that looked the frame up before its page was deleted may still hold a pin on it for a moment.
+    while (!ClaimFrame(*frame_id)) {
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  DrainAccessBuffer();
+  bool synced = false;
+  while (true) {
+    if (!replacer_->Evict(frame_id)) {
+      if (synced) {
+        return false;
+      }
+      // Some unpin may have fallen off the access buffer, look at the pin counts before giving up.
+      SyncEvictable();
+      synced = true;
+      continue;
+    }
+    if (ClaimFrame(*frame_id)) {
+      stats_.Increment(BufferPoolCounters::Counter::Eviction);
+      return true;
+    }
+    // A hit pinned the frame since the replacer last heard of it. The replacer forgot the frame when it picked it,
+    // track it again and look for another one.
+    Page &page = pages_[*frame_id];
+    replacer_->RecordAccess(*frame_id, AccessType::Unknown, page.page_id_);
+    replacer_->SetEvictable(*frame_id, page.pin_count_ == 0);
+  }
+}
+
+auto BufferPoolManager::ClaimFrame(frame_id_t frame_id) -> bool {
+  int pin_count = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(pin_count, -1);
+}
 
-    if (vic->IsDirty()) {
-      disk_manager_->WritePage(vic->GetPageId(), vic->GetData());
+auto BufferPoolManager::PinResident(page_id_t page_id, frame_id_t *frame_id) -> bool {
+  if (!page_table_.Find(page_id, frame_id)) {
+    return false;
+  }
+  Page &page = pages_[*frame_id];
+  int pin_count = page.pin_count_.load();
+  do {
+    if (pin_count < 0) {
+      return false;
     }
-    page_table_.erase(vic->GetPageId());
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+
+  // The frame cannot be reassigned while we hold the pin, but it may have been before we got it.
+  if (page.page_id_ == page_id && !page.io_in_progress_) {
+    return true;
   }
-  // frame_id_t new_frame_id;  //接受返回的那个页框号
+  UnpinResident(*frame_id);
+  return false;
+}
 
-  // if (replacer_->Evict(&new_frame_id)) {
+auto BufferPoolManager::UnpinResident(frame_id_t frame_id) -> bool {
+  Page &page = pages_[frame_id];
+  int pin_count = page.pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
+    RecordLater({frame_id, page.page_id_, false, AccessType::Unknown});
+  }
+  return true;
+}
 
-  //   new_page = &pages_[new_frame_id];
+void BufferPoolManager::RecordLater(const AccessRecord &record) {
+  if (access_buffer_.Push(record)) {
+    // Never wait for the latch on a hit, whoever holds it will drain the buffer soon enough.
+    std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+    if (lock.owns_lock()) {
+      DrainAccessBuffer();
+    }
+  }
+}
 
-  // } else if (!free_list_.empty()) {
+void BufferPoolManager::DrainAccessBuffer() {
+  access_buffer_.Drain([this](const AccessRecord &record) {
+    Page &page = pages_[record.frame_id_];
+    if (page.page_id_ != record.page_id_ || page.io_in_progress_) {
+      // the frame moved on to another page since
+      return;
+    }
+    if (record.is_access_) {
+      replacer_->RecordAccess(record.frame_id_, record.access_type_, record.page_id_);
+    }
+    replacer_->SetEvictable(record.frame_id_, page.pin_count_ == 0);
+  });
+}
 
-  //   new_frame_id = free_list_.front();
+void BufferPoolManager::SyncEvictable() {
+  for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+    Page &page = pages_[frame_id];
+    if (page.page_id_ != INVALID_PAGE_ID && !page.io_in_progress_) {
+      replacer_->SetEvictable(static_cast<frame_id_t>(frame_id), page.pin_count_ == 0);
+    }
+  }
+}
 
-  //   free_list_.pop_front();
+void BufferPoolManager::ReplaceFrame(std::unique_lock<std::mutex> &lock, frame_id_t frame_id, page_id_t page_id,
+                                     AccessType access_type) {
+  Page *page = &pages_[frame_id];
+  page_id_t old_page_id = page->page_id_;
+  bool write_back = old_page_id != INVALID_PAGE_ID && page->is_dirty_;
+  bool is_view = page->data_ != frame_arena_->GetFrame(frame_id);
+  if (old_page_id != INVALID_PAGE_ID && !write_back) {
+    page_table_.Erase(old_page_id);
+  }
 
-  //   new_page = &pages_[new_frame_id];
+  // Publish the new page right away, so that concurrent requests for it wait for this I/O instead of starting their
+  // own. While a dirty victim is written back it also stays mapped, for the same reason. The frame is marked as under
+  // I/O before the claim is released, so that a hit pinning it afterwards backs off to the locked path and waits.
+  lsn_t old_rec_lsn = page->rec_lsn_.exchange(INVALID_LSN);
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->io_in_progress_ = true;
+  page->pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  replacer_->RecordAccess(frame_id, access_type, page_id);
+
+  if (write_back) {
+    // The flusher did not keep up, let it know we had to pay for a write.
+    dirty_evictions_++;
+    flusher_cv_.notify_one();
+    if (old_rec_lsn != INVALID_LSN) {
+      writes_in_flight_[old_page_id] = old_rec_lsn;
+    }
+    lock.unlock();
+    FlushLog(page->GetLSN());
+    DoIo(true, old_page_id, page->GetData());
+    lock.lock();
+    writes_in_flight_.erase(old_page_id);
+    page_table_.Erase(old_page_id);
+  }
+  if (is_view) {
+    // A modified view has just been written back, but a view written back earlier (by the flusher, FlushPage() or
+    // FlushAllPages()) still holds its private copy too. Drop it in both cases, or the copies pile up beyond the pool.
+    DetachView(frame_id, old_page_id);
+  }
+}
 
-  // } else {
+void BufferPoolManager::WriteBack(std::unique_lock<std::mutex> &lock, const std::vector<frame_id_t> &frames) {
+  if (frames.empty()) {
+    return;
+  }
+  // Pin the frames so that they are not evicted while the latch is released. As in FlusherWorker(), the dirty flags
+  // and recLSNs are cleared up front, and the dirty page table takes the recLSNs from writes_in_flight_ meanwhile.
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> futures;
+  std::vector<page_id_t> page_ids;
+  lsn_t max_lsn = INVALID_LSN;
+  for (auto frame_id : frames) {
+    Page &page = pages_[frame_id];
+    if (page.pin_count_++ == 0) {
+      replacer_->SetEvictable(frame_id, false);
+    }
+    page.is_dirty_ = false;
+    if (lsn_t rec_lsn = page.rec_lsn_.exchange(INVALID_LSN); rec_lsn != INVALID_LSN) {
+      writes_in_flight_[page.GetPageId()] = rec_lsn;
+      page_ids.push_back(page.GetPageId());
+    }
+    max_lsn = std::max(max_lsn, page.GetLSN());
+    auto promise = disk_scheduler_->CreatePromise();
+    futures.push_back(promise.get_future());
+    requests.push_back({true, page.GetData(), page.GetPageId(), std::move(promise)});
+  }
+  lock.unlock();
+
+  // Issue all writes as one batch and wait for them together.
+  FlushLog(max_lsn);
+  auto start = BufferPoolCounters::Clock::now();
+  disk_scheduler_->Schedule(std::move(requests));
+  for (auto &future : futures) {
+    AwaitIo(true, future, start);
+  }
 
-  //   return nullptr;
+  lock.lock();
+  for (auto frame_id : frames) {
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
+  for (auto page_id : page_ids) {
+    writes_in_flight_.erase(page_id);
+  }
+}
 
-  // }
-  // if (new_page->IsDirty()) {
+void BufferPoolManager::DetachView(frame_id_t frame_id, page_id_t page_id) {
+  Page &page = pages_[frame_id];
+  char *frame = frame_arena_->GetFrame(frame_id);
+  if (page.data_ == frame) {
+    return;
+  }
+  disk_manager_->ReleasePageView(page_id);
+  page.data_ = frame;
+}
 
-  //   disk_manager_->WritePage(new_page->GetPageId(), new_page->GetData());
+void BufferPoolManager::ReadIntoFrame(Page *page, page_id_t page_id) {
+  if (char *view = disk_manager_->GetPageView(page_id); view != nullptr) {
+    // Zero copy: the frame shows the mapped page, which the kernel reads in on first access.
+    page->data_ = view;
+  } else {
+    page->ResetMemory();
+    DoIo(false, page_id, page->data_);
+  }
+}
 
-  // }
+auto BufferPoolManager::ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool> {
+  auto promise = disk_scheduler_->CreatePromise();
+  auto future = promise.get_future();
+  disk_scheduler_->Schedule({is_write, data, page_id, std::move(promise)});
+  return future;
+}
 
-  // page_table_.erase(new_page->GetPageId());
-  Page *new_page = &pages_[new_frame_id];
+auto BufferPoolManager::AwaitIo(bool is_write, std::future<bool> &future, BufferPoolCounters::Clock::time_point start)
+    -> bool {
+  bool success = future.get();
+  if (is_write) {
+    stats_.Increment(BufferPoolCounters::Counter::DirtyFlush);
+  }
+  stats_.RecordLatency(is_write ? BufferPoolCounters::Latency::Write : BufferPoolCounters::Latency::Read, start);
+  return success;
+}
 
-  new_page->ResetMemory();  // 提供好的成员函数，直接调用就行
+auto BufferPoolManager::DoIo(bool is_write, page_id_t page_id, char *data) -> bool {
+  auto start = BufferPoolCounters::Clock::now();
+  auto future = ScheduleIo(is_write, page_id, data);
+  return AwaitIo(is_write, future, start);
+}
 
-  new_page->is_dirty_ = false;
+void BufferPoolManager::FlushLog(lsn_t page_lsn) {
+  if (log_manager_ != nullptr && enable_logging && page_lsn != INVALID_LSN) {
+    log_manager_->Flush(page_lsn);
+  }
+}
 
-  new_page->page_id_ = page_id;
+auto BufferPoolManager::LockLatch() -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    auto start = BufferPoolCounters::Clock::now();
+    lock.lock();
+    stats_.Increment(BufferPoolCounters::Counter::PinWait);
+    stats_.RecordLatency(BufferPoolCounters::Latency::PinWait, start);
+  }
+  return lock;
+}
 
-  new_page->pin_count_++;
+void BufferPoolManager::StartFlusher(double clean_fraction, std::chrono::milliseconds interval) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ENSURE(!flusher_thread_.joinable(), "flusher is already running");
+  flusher_clean_fraction_ = clean_fraction;
+  flusher_interval_ = interval;
+  flusher_stop_ = false;
+  if (flusher_buffers_ == nullptr) {
+    flusher_buffers_ = std::make_unique<Page[]>(FLUSHER_BATCH_SIZE);
+  }
+  flusher_thread_ = std::thread([this] { FlusherWorker(); });
+}
 
-  replacer_->RecordAccess(new_frame_id);
+void BufferPoolManager::StopFlusher() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!flusher_thread_.joinable()) {
+      return;
+    }
+    flusher_stop_ = true;
+  }
+  flusher_cv_.notify_one();
+  flusher_thread_.join();
+}
 
-  page_table_.emplace(new_page->GetPageId(), new_frame_id);
-  disk_manager_->ReadPage(page_id, new_page->data_);
-  // PrintPage();
-  // std::cout << std::this_thread::get_id() << "Fetct Page   " << replacer_->node_store_.size() << "  "
-  //           << replacer_->now_knode_.size() << std::endl;
-  // replacer_->now_knode_.size() << std::endl;
-  return new_page;
+auto BufferPoolManager::GetFlusherStats() -> FlusherStats {
+  return {flush_rounds_.load(), pages_flushed_.load(), dirty_evictions_.load()};
 }
 
-auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
-  // std::cout << "UnpinPage" << page_id << "   " << is_dirty << std::endl;
-  if (page_table_.count(page_id) == 0) {
-    // PrintPage();
-    return false;
+auto BufferPoolManager::GetStats() -> BufferPoolStats { return stats_.Snapshot(); }
+
+void BufferPoolManager::ResetStats() { stats_.Reset(); }
+
+auto BufferPoolManager::GetHotPages(size_t max_pages) -> std::vector<page_id_t> {
+  std::scoped_lock lock(latch_);
+  DrainAccessBuffer();
+  auto eviction_order = replacer_->EvictionOrder(pool_size_);
+  std::vector<bool> evictable(pool_size_, false);
+  for (auto frame_id : eviction_order) {
+    evictable[frame_id] = true;
   }
-  Page &page = pages_[page_table_[page_id]];
-  if (page.pin_count_ == 0) {
-    // PrintPage();
-    return false;
+
+  // The pages in use right now come first, then the others from the last the replacer would evict.
+  std::vector<page_id_t> page_ids;
+  for (size_t frame_id = 0; frame_id < pool_size_ && page_ids.size() < max_pages; frame_id++) {
+    if (pages_[frame_id].page_id_ != INVALID_PAGE_ID && !evictable[frame_id]) {
+      page_ids.push_back(pages_[frame_id].page_id_);
+    }
   }
-  // replacer_->RecordAccess(page_table_[page_id]);
-  page.is_dirty_ = page.IsDirty() || is_dirty;
-  page.pin_count_--;
-  if (page.pin_count_ == 0) {
-    replacer_->SetEvictable(page_table_[page_id], true);
+  for (auto it = eviction_order.rbegin(); it != eviction_order.rend() && page_ids.size() < max_pages; ++it) {
+    if (pages_[*it].page_id_ != INVALID_PAGE_ID) {
+      page_ids.push_back(pages_[*it].page_id_);
+    }
   }
-  // PrintPage();
-  // std::cout << std::this_thread::get_id() << "UnpinPage   " << replacer_->node_store_.size() << "  "
-  //       << replacer_->now_knode_.size() << std::endl;
-  // std::cout << std::this_thread::get_id() << "Unpin finish" << std::endl;
-  return true;
+  return page_ids;
 }
 
-auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
-  if (page_table_.count(page_id) == 0 || page_id == INVALID_PAGE_ID) {
+auto BufferPoolManager::PrewarmPage(page_id_t page_id) -> bool {
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  // Whatever traffic fetched since the start is a better guess than the list, never evict it.
+  if (free_list_.empty() || page_table_.Find(page_id, &frame_id)) {
     return false;
   }
-  // std::cout << "FlushPage"
-  //           << "  " << page_id << std::endl;
-  // replacer_->RecordAccess(page_table_[page_id]);
-  Page &page = pages_[page_table_[page_id]];
-  if (page.IsDirty()) {
-    disk_manager_->WritePage(page.GetPageId(), page.GetData());
+  BUSTUB_ENSURE(GetVictimFrame(&frame_id), "the free list is not empty");
+  ReplaceFrame(lock, frame_id, page_id, AccessType::Scan);
+
+  Page *page = &pages_[frame_id];
+  lock.unlock();
+  ReadIntoFrame(page, page_id);
+  lock.lock();
+  FinishIo(frame_id);
+  // A hit may have pinned the page as soon as its I/O was done.
+  if (--page->pin_count_ == 0) {
+    replacer_->SetEvictable(frame_id, true);
   }
-  page.is_dirty_ = false;
   return true;
 }
 
-void BufferPoolManager::FlushAllPages() {
-  std::lock_guard<std::mutex> lock(latch_);
-  // std::cout << "FlushAllPages" << std::endl;
-  for (auto nn : page_table_) {
-    frame_id_t frame_id = nn.second;
-    // replacer_->RecordAccess(frame_id);
-    Page &page = pages_[frame_id];
-    if (page.IsDirty()) {
-      disk_manager_->WritePage(page.GetPageId(), page.GetData());
+void BufferPoolManager::FlusherWorker() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!flusher_stop_) {
+    auto frames = PickFramesToFlush();
+    if (frames.empty()) {
+      flusher_cv_.wait_for(lock, flusher_interval_);
+      continue;
+    }
+
+    // Pin the frames so that they are not evicted while we copy them. A page modified after its copy is taken is
+    // marked dirty again by its writer, so the dirty flag can be cleared right away. So can the recLSN, which the
+    // dirty page table takes from writes_in_flight_ until the write is done.
+    std::vector<page_id_t> page_ids;
+    for (auto frame_id : frames) {
+      Page &page = pages_[frame_id];
+      page.pin_count_++;
+      page.is_dirty_ = false;
+      if (lsn_t rec_lsn = page.rec_lsn_.exchange(INVALID_LSN); rec_lsn != INVALID_LSN) {
+        writes_in_flight_[page.GetPageId()] = rec_lsn;
+        page_ids.push_back(page.GetPageId());
+      }
+      replacer_->SetEvictable(frame_id, false);
+    }
+    lock.unlock();
+
+    // Copy the frames one at a time under their read latch, never holding two latches at once. The writes are queued
+    // before the frames are unpinned, so any later write back or read of the same page is ordered after them.
+    std::vector<DiskRequest> requests;
+    std::vector<std::future<bool>> futures;
+    lsn_t max_lsn = INVALID_LSN;
+    for (size_t i = 0; i < frames.size(); i++) {
+      Page &page = pages_[frames[i]];
+      char *copy = flusher_buffers_[i].GetData();
+      page.RLatch();
+      memcpy(copy, page.GetData(), BUSTUB_PAGE_SIZE);
+      max_lsn = std::max(max_lsn, page.GetLSN());
+      page.RUnlatch();
+      auto promise = disk_scheduler_->CreatePromise();
+      futures.push_back(promise.get_future());
+      requests.push_back({true, copy, page.GetPageId(), std::move(promise)});
+    }
+    FlushLog(max_lsn);
+    auto start = BufferPoolCounters::Clock::now();
+    disk_scheduler_->Schedule(std::move(requests));
+
+    lock.lock();
+    for (auto frame_id : frames) {
+      Page &page = pages_[frame_id];
+      if (--page.pin_count_ == 0) {
+        replacer_->SetEvictable(frame_id, true);
+      }
+    }
+    lock.unlock();
+    for (auto &future : futures) {
+      AwaitIo(true, future, start);
+    }
+    flush_rounds_++;
+    pages_flushed_ += frames.size();
+    lock.lock();
+    for (auto page_id : page_ids) {
+      writes_in_flight_.erase(page_id);
     }
-    page.is_dirty_ = false;
   }
 }
 
-auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
-  // std::cout << "DeletePage" << page_id << std::endl;
-  if (page_table_.count(page_id) == 0) {
-    return true;
+auto BufferPoolManager::PickFramesToFlush() -> std::vector<frame_id_t> {
+  // Pages holding back the redo point of the next checkpoint go first, see FlushPagesBefore().
+  if (flush_before_lsn_ != INVALID_LSN) {
+    auto frames = PickFramesBefore(flush_before_lsn_);
+    if (!frames.empty()) {
+      return frames;
+    }
+    flush_before_lsn_ = INVALID_LSN;
   }
 
-  Page *page = &pages_[page_table_[page_id]];
-
-  if (page->pin_count_ != 0) {
-    return false;
+  auto target = static_cast<size_t>(flusher_clean_fraction_ * pool_size_);
+  size_t clean = free_list_.size();
+  if (clean >= target) {
+    return {};
   }
-
-  if (page->IsDirty()) {
-    disk_manager_->WritePage(page->GetPageId(), page->GetData());
+  DrainAccessBuffer();
+  std::vector<frame_id_t> dirty;
+  for (auto frame_id : replacer_->EvictionOrder(pool_size_)) {
+    if (pages_[frame_id].io_in_progress_) {
+      continue;
+    }
+    if (pages_[frame_id].IsDirty()) {
+      dirty.push_back(frame_id);
+    } else {
+      clean++;
+    }
   }
+  if (clean >= target) {
+    return {};
+  }
+  // the coldest dirty frames are the next ones to be evicted
+  dirty.resize(std::min({dirty.size(), target - clean, static_cast<size_t>(FLUSHER_BATCH_SIZE)}));
+  std::sort(dirty.begin(), dirty.end(),
+            [this](frame_id_t a, frame_id_t b) { return pages_[a].GetPageId() < pages_[b].GetPageId(); });
+  return dirty;
+}
 
-  page->ResetMemory();
-
-  page->is_dirty_ = false;
-
-  page->pin_count_ = 0;
-  page->page_id_ = INVALID_PAGE_ID;
-  free_list_.push_back(page_table_[page_id]);
+auto BufferPoolManager::PickFramesBefore(lsn_t rec_lsn) -> std::vector<frame_id_t> {
+  std::vector<frame_id_t> frames;
+  for (size_t frame_id = 0; frame_id < pool_size_ && frames.size() < FLUSHER_BATCH_SIZE; frame_id++) {
+    Page &page = pages_[frame_id];
+    lsn_t page_rec_lsn = page.rec_lsn_;
+    if (page.page_id_ != INVALID_PAGE_ID && page.pin_count_ >= 0 && !page.io_in_progress_ &&
+        page_rec_lsn != INVALID_LSN && page_rec_lsn < rec_lsn) {
+      frames.push_back(static_cast<frame_id_t>(frame_id));
+    }
+  }
+  std::sort(frames.begin(), frames.end(),
+            [this](frame_id_t a, frame_id_t b) { return pages_[a].GetPageId() < pages_[b].GetPageId(); });
+  return frames;
+}
 
-  replacer_->Remove(page_table_[page_id]);
+auto BufferPoolManager::GetDirtyPageTable() -> std::vector<std::pair<page_id_t, lsn_t>> {
+  std::scoped_lock lock(latch_);
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages(writes_in_flight_.begin(), writes_in_flight_.end());
+  for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+    Page &page = pages_[frame_id];
+    lsn_t rec_lsn = page.rec_lsn_;
+    if (page.page_id_ != INVALID_PAGE_ID && rec_lsn != INVALID_LSN) {
+      dirty_pages.emplace_back(page.GetPageId(), rec_lsn);
+    }
+  }
+  return dirty_pages;
+}
 
-  page_table_.erase(page_id);
-  DeallocatePage(page_id);
+void BufferPoolManager::FlushPagesBefore(lsn_t rec_lsn) {
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock lock(latch_);
+    if (flusher_thread_.joinable()) {
+      flush_before_lsn_ = std::max(flush_before_lsn_, rec_lsn);
+      flusher_cv_.notify_one();
+      return;
+    }
+    for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+      Page &page = pages_[frame_id];
+      lsn_t page_rec_lsn = page.rec_lsn_;
+      if (page.page_id_ != INVALID_PAGE_ID && page_rec_lsn != INVALID_LSN && page_rec_lsn < rec_lsn) {
+        page_ids.push_back(page.GetPageId());
+      }
+    }
+  }
+  for (auto page_id : page_ids) {
+    FlushPage(page_id);
+  }
+}
 
-  return true;
+void BufferPoolManager::FinishIo(frame_id_t frame_id) {
+  pages_[frame_id].io_in_progress_ = false;
+  io_cv_[frame_id].notify_all();
 }
 
 auto BufferPoolManager::AllocatePage() -> page_id_t {
-  // std::lock_guard<std::mutex> lock(latch_);
-  return next_page_id_++;
+  // Stride by the number of instances so that every page id maps back to the instance that allocated it.
+  return disk_manager_->GetFreePageMap()->AllocatePage(static_cast<page_id_t>(instance_index_),
+                                                       static_cast<page_id_t>(num_instances_));
 }
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
+void BufferPoolManager::DeallocatePage(page_id_t page_id) { disk_manager_->GetFreePageMap()->DeallocatePage(page_id); }
+
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
   // std::lock_guard<std::mutex> lock(latch_);
   // std::cout << "FetchPageBasic"
   //           << "   " << page_id << std::endl;
   // auto page = FetchPage(page_id);
   // page->RLatch();
-  return {this, FetchPage(page_id)};
+  return {this, FetchPage(page_id, access_type)};
 }
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
   // std::lock_guard<std::mutex> lock(latch_);
   // std::cout << "FetchPageRead"
   //           << "   " << page_id << std::endl;
-  auto page = FetchPage(page_id);
+  auto page = FetchPage(page_id, access_type);
   // std::cout << "RLock:" << page_id << std::endl;
   page->RLatch();
   return {this, page};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
   // std::lock_guard<std::mutex> lock(latch_);
   // std::cout << "FetchPageWrite"
   //           << "   " << page_id << std::endl;
-  auto page = FetchPage(page_id);
+  auto page = FetchPage(page_id, access_type);
   // std::cout << "WLock:" << page_id << std::endl;
   page->WLatch();
   // std::cout << "jjWLock:" << page_id << std::endl;
   return {this, page};
 }
 
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticPageGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
 auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
   // std::lock_guard<std::mutex> lock(latch_);
   // std::cout << "NewPageGuard" << std::endl;
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+auto LatencyHistogram::BucketOf(uint64_t us) -> size_t {
+  if (us == 0) {
+    return 0;
+  }
+  // 1 us lands in bucket 1, [2, 4) us in bucket 2, ...
+  auto bucket = static_cast<size_t>(64 - __builtin_clzll(us));
+  return std::min(bucket, NUM_BUCKETS - 1);
+}
+
+void LatencyHistogram::Add(uint64_t us) {
+  count_++;
+  total_us_ += us;
+  buckets_[BucketOf(us)]++;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  count_ += other.count_;
+  total_us_ += other.total_us_;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    buckets_[i] += other.buckets_[i];
+  }
+}
+
+auto LatencyHistogram::Mean() const -> double {
+  return count_ == 0 ? 0 : static_cast<double>(total_us_) / static_cast<double>(count_);
+}
+
+auto LatencyHistogram::Percentile(double p) const -> uint64_t {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(p * static_cast<double>(count_))), 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return uint64_t{1} << i;
+    }
+  }
+  return uint64_t{1} << (NUM_BUCKETS - 1);
+}
+
+auto LatencyHistogram::ToString() const -> std::string {
+  return fmt::format("count={} mean={:.1f} p50={} p90={} p99={}", count_, Mean(), Percentile(0.5), Percentile(0.9),
+                     Percentile(0.99));
+}
+
+auto BufferPoolStats::HitRatio() const -> double {
+  uint64_t fetches = hits_ + misses_;
+  return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+}
+
+void BufferPoolStats::Merge(const BufferPoolStats &other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  dirty_flushes_ += other.dirty_flushes_;
+  pin_waits_ += other.pin_waits_;
+  pin_wait_latency_.Merge(other.pin_wait_latency_);
+  read_latency_.Merge(other.read_latency_);
+  write_latency_.Merge(other.write_latency_);
+}
+
+auto BufferPoolStats::ToString() const -> std::string {
+  return fmt::format(
+      "hits={} misses={} hit_ratio={:.4f} evictions={} dirty_flushes={} pin_waits={}\n"
+      "pin_wait_us: {}\nread_us: {}\nwrite_us: {}",
+      hits_, misses_, HitRatio(), evictions_, dirty_flushes_, pin_waits_, pin_wait_latency_.ToString(),
+      read_latency_.ToString(), write_latency_.ToString());
+}
+
+void BufferPoolCounters::RecordLatency(Latency latency, Clock::time_point start) {
+  auto us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+  auto &histogram = MyShard().latencies_[static_cast<size_t>(latency)];
+  histogram[0].fetch_add(1, std::memory_order_relaxed);
+  histogram[1].fetch_add(us, std::memory_order_relaxed);
+  histogram[2 + LatencyHistogram::BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+auto BufferPoolCounters::Snapshot() const -> BufferPoolStats {
+  std::array<uint64_t, NUM_COUNTERS> counters{};
+  std::array<LatencyHistogram, NUM_LATENCIES> latencies{};
+  for (const auto &shard : shards_) {
+    for (size_t i = 0; i < NUM_COUNTERS; i++) {
+      counters[i] += shard.counters_[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < NUM_LATENCIES; i++) {
+      latencies[i].count_ += shard.latencies_[i][0].load(std::memory_order_relaxed);
+      latencies[i].total_us_ += shard.latencies_[i][1].load(std::memory_order_relaxed);
+      for (size_t bucket = 0; bucket < LatencyHistogram::NUM_BUCKETS; bucket++) {
+        latencies[i].buckets_[bucket] += shard.latencies_[i][2 + bucket].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  BufferPoolStats stats;
+  stats.hits_ = counters[static_cast<size_t>(Counter::Hit)];
+  stats.misses_ = counters[static_cast<size_t>(Counter::Miss)];
+  stats.evictions_ = counters[static_cast<size_t>(Counter::Eviction)];
+  stats.dirty_flushes_ = counters[static_cast<size_t>(Counter::DirtyFlush)];
+  stats.pin_waits_ = counters[static_cast<size_t>(Counter::PinWait)];
+  stats.pin_wait_latency_ = latencies[static_cast<size_t>(Latency::PinWait)];
+  stats.read_latency_ = latencies[static_cast<size_t>(Latency::Read)];
+  stats.write_latency_ = latencies[static_cast<size_t>(Latency::Write)];
+  return stats;
+}
+
+void BufferPoolCounters::Reset() {
+  for (auto &shard : shards_) {
+    for (auto &counter : shard.counters_) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto &histogram : shard.latencies_) {
+      for (auto &value : histogram) {
+        value.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+auto BufferPoolCounters::MyShard() -> Shard & {
+  // Threads are assigned shards round robin on their first update, whatever buffer pool they use.
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+  return shards_[shard];
+}
+
+}  // namespace bustub
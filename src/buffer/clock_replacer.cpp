@@ -11,19 +11,103 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/clock_replacer.h"
+#include "common/exception.h"
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_frames) : frames_(num_frames) {}
 
-ClockReplacer::~ClockReplacer() = default;
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // Terminates within two revolutions: the first one clears every reference bit.
+  while (true) {
+    ClockFrame &frame = frames_[hand_];
+    auto current = static_cast<frame_id_t>(hand_);
+    hand_ = (hand_ + 1) % frames_.size();
+    if (!frame.is_tracked_ || !frame.is_evictable_) {
+      continue;
+    }
+    if (frame.reference_) {
+      frame.reference_ = false;
+      continue;
+    }
+    frame = ClockFrame{};
+    size_--;
+    *frame_id = current;
+    return true;
+  }
+}
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t /*page_id*/) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  ClockFrame &frame = frames_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (!frame.is_tracked_) {
+    frame.is_tracked_ = true;
+    frame.reference_ = !is_scan;
+  } else if (!is_scan) {
+    frame.reference_ = true;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  ClockFrame &frame = frames_[frame_id];
+  if (!frame.is_tracked_ || frame.is_evictable_ == set_evictable) {
+    return;
+  }
+  frame.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    size_++;
+  } else {
+    size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  ClockFrame &frame = frames_[frame_id];
+  if (!frame.is_tracked_) {
+    return;
+  }
+  if (!frame.is_evictable_) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  frame = ClockFrame{};
+  size_--;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return size_;
+}
+
+auto ClockReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  // A sweep takes the unreferenced frames in hand order first, then comes around to the ones whose bit it cleared.
+  std::vector<frame_id_t> frames;
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < frames_.size() && frames.size() < max_frames; i++) {
+      size_t pos = (hand_ + i) % frames_.size();
+      const ClockFrame &frame = frames_[pos];
+      if (frame.is_tracked_ && frame.is_evictable_ && frame.reference_ == referenced) {
+        frames.push_back(static_cast<frame_id_t>(pos));
+      }
+    }
+  }
+  return frames;
+}
+
+void ClockReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid frame id");
+  }
+}
 
 }  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, HugePageMode huge_pages, int numa_node) {
+  size_ = std::max<size_t>(num_frames, 1) * BUSTUB_PAGE_SIZE;
+  void *data = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  if (huge_pages == HugePageMode::Explicit) {
+    // Explicit huge pages come from the pool reserved in /proc/sys/vm/nr_hugepages, in whole huge pages.
+    size_t size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      size_ = size;
+      map_size_ = size;
+      huge_pages_ = HugePageMode::Explicit;
+    } else {
+      LOG_WARN("no huge pages reserved for the buffer pool (%s), trying transparent huge pages", strerror(errno));
+      huge_pages = HugePageMode::Transparent;
+    }
+  }
+#endif
+
+  if (data == MAP_FAILED) {
+    // mmap only aligns to the OS page size, which may be smaller than BUSTUB_PAGE_SIZE: map one page more and skip to
+    // the first aligned address.
+    map_size_ = size_ + BUSTUB_PAGE_SIZE;
+    data = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frames");
+    }
+#ifdef MADV_HUGEPAGE
+    // Only worth it if at least one huge page fits; the kernel backs the aligned part of the mapping.
+    if (huge_pages == HugePageMode::Transparent && size_ >= HUGE_PAGE_SIZE) {
+      if (madvise(data, map_size_, MADV_HUGEPAGE) == 0) {
+        huge_pages_ = HugePageMode::Transparent;
+      } else {
+        LOG_WARN("transparent huge pages are not available for the buffer pool (%s)", strerror(errno));
+      }
+    }
+#endif
+  }
+  map_ = static_cast<char *>(data);
+  auto misalignment = reinterpret_cast<uintptr_t>(map_) % BUSTUB_PAGE_SIZE;
+  data_ = misalignment == 0 ? map_ : map_ + (BUSTUB_PAGE_SIZE - misalignment);
+
+  if (numa_node != NUMA_DEFAULT) {
+    PlaceOnNuma(numa_node);
+  }
+}
+
+FrameArena::~FrameArena() { munmap(map_, map_size_); }
+
+void FrameArena::PlaceOnNuma(int numa_node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  // Set the policy before any frame is touched, so that every page is allocated according to it. Nodes in the mask
+  // that do not exist are ignored by the kernel.
+  constexpr int max_nodes = 64;
+  if (numa_node != NUMA_INTERLEAVE && (numa_node < 0 || numa_node >= max_nodes)) {
+    LOG_WARN("invalid NUMA node %d for the buffer pool frames, using the default placement", numa_node);
+    return;
+  }
+  uint64_t node_mask = numa_node == NUMA_INTERLEAVE ? ~uint64_t{0} : uint64_t{1} << numa_node;
+  int mode = numa_node == NUMA_INTERLEAVE ? MPOL_INTERLEAVE : MPOL_BIND;
+  if (syscall(SYS_mbind, map_, map_size_, mode, &node_mask, max_nodes + 1, 0) != 0) {
+    LOG_WARN("cannot place the buffer pool frames on NUMA node %d (%s), using the default placement", numa_node,
+             strerror(errno));
+  }
+#else
+  LOG_WARN("NUMA placement is not supported on this platform");
+#endif
+}
+
+}  // namespace bustub
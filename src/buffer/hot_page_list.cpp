@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hot_page_list.cpp
+//
+// Identification: src/buffer/hot_page_list.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/hot_page_list.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+auto HotPageList::Write(const std::string &file_name, const std::vector<page_id_t> &page_ids) -> bool {
+  std::string tmp_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+    uint32_t header[2] = {MAGIC, static_cast<uint32_t>(page_ids.size())};
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(page_ids.data()),
+              static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+    out.flush();
+    if (!out) {
+      LOG_WARN("failed to write the hot page list %s", tmp_name.c_str());
+      std::remove(tmp_name.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    LOG_WARN("failed to replace the hot page list %s", file_name.c_str());
+    std::remove(tmp_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+auto HotPageList::Read(const std::string &file_name) -> std::vector<page_id_t> {
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t header[2] = {0, 0};
+  if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != MAGIC || header[1] > MAX_PAGES) {
+    return {};
+  }
+  std::vector<page_id_t> page_ids(header[1]);
+  if (!in.read(reinterpret_cast<char *>(page_ids.data()),
+               static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)))) {
+    LOG_WARN("hot page list %s is truncated", file_name.c_str());
+    return {};
+  }
+  return page_ids;
+}
+
+}  // namespace bustub
@@ -11,19 +11,80 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_replacer.h"
+#include "common/exception.h"
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_frames) : last_access_(num_frames, 0), is_evictable_(num_frames, false) {}
 
-LRUReplacer::~LRUReplacer() = default;
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_frames_.empty()) {
+    return false;
+  }
+  *frame_id = evictable_frames_.begin()->second;
+  evictable_frames_.erase(evictable_frames_.begin());
+  last_access_[*frame_id] = 0;
+  is_evictable_[*frame_id] = false;
+  return true;
+}
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType /*access_type*/, page_id_t /*page_id*/) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (is_evictable_[frame_id]) {
+    evictable_frames_.erase({last_access_[frame_id], frame_id});
+    evictable_frames_.emplace(current_timestamp_ + 1, frame_id);
+  }
+  last_access_[frame_id] = ++current_timestamp_;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (last_access_[frame_id] == 0 || is_evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  is_evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    evictable_frames_.emplace(last_access_[frame_id], frame_id);
+  } else {
+    evictable_frames_.erase({last_access_[frame_id], frame_id});
+  }
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (last_access_[frame_id] == 0) {
+    return;
+  }
+  if (!is_evictable_[frame_id]) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  evictable_frames_.erase({last_access_[frame_id], frame_id});
+  last_access_[frame_id] = 0;
+  is_evictable_[frame_id] = false;
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+auto LRUReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return evictable_frames_.size();
+}
+
+auto LRUReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  for (auto it = evictable_frames_.begin(); it != evictable_frames_.end() && frames.size() < max_frames; ++it) {
+    frames.push_back(it->second);
+  }
+  return frames;
+}
+
+void LRUReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= last_access_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid frame id");
+  }
+}
 
 }  // namespace bustub
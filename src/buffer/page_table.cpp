@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  capacity_ = 8;
+  while (capacity_ < 4 * num_frames) {
+    capacity_ *= 2;
+  }
+  mask_ = capacity_ - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::HomeSlot(page_id_t page_id) const -> size_t {
+  // Page ids are mostly dense, mix the bits so that runs of them don't form long clusters.
+  auto hash = static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9e3779b97f4a7c15ULL;
+  return (hash >> 32) & mask_;
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  size_t slot = HomeSlot(page_id);
+  for (size_t probes = 0; probes < capacity_; probes++, slot = (slot + 1) & mask_) {
+    uint64_t entry = slots_[slot].load(std::memory_order_acquire);
+    if (entry == EMPTY) {
+      return false;
+    }
+    if (PageOf(entry) == page_id) {
+      *frame_id = FrameOf(entry);
+      return true;
+    }
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot map the invalid page id");
+  size_t slot = HomeSlot(page_id);
+  while (true) {
+    uint64_t entry = slots_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY || PageOf(entry) == page_id) {
+      if (entry == EMPTY) {
+        BUSTUB_ENSURE(size_ + 1 < capacity_, "page table is full");
+        size_++;
+      }
+      slots_[slot].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    slot = (slot + 1) & mask_;
+  }
+}
+
+void PageTable::Erase(page_id_t page_id) {
+  size_t hole = HomeSlot(page_id);
+  while (true) {
+    uint64_t entry = slots_[hole].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      return;
+    }
+    if (PageOf(entry) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+  size_--;
+
+  // Backward-shift deletion: move later entries of the cluster into the hole whenever their home slot allows it, so
+  // that no tombstones are needed. An entry is copied before its old slot is reused, so readers may see it twice, but
+  // a reader that already went past the hole can miss it; that only sends it down the locked path.
+  size_t slot = hole;
+  while (true) {
+    slot = (slot + 1) & mask_;
+    uint64_t entry = slots_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      slots_[hole].store(EMPTY, std::memory_order_release);
+      return;
+    }
+    size_t home = HomeSlot(PageOf(entry));
+    bool stays = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+    if (!stays) {
+      slots_[hole].store(entry, std::memory_order_release);
+      hole = slot;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t num_io_workers)
+    : BufferPool(disk_manager) {
+  BUSTUB_ENSURE(num_instances > 0, "parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManager>(pool_size, static_cast<uint32_t>(num_instances),
+                                                                static_cast<uint32_t>(i), disk_manager, replacer_k,
+                                                                log_manager, replacer_type, num_io_workers));
+  }
+}
+
+// Read-ahead, the hot page dumper and the prewarm go through this class, stop them before the instances go away.
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  StopHotPageDumper();
+  StopPrewarm();
+  StopReadAhead();
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+void ParallelBufferPoolManager::StartFlusher(double clean_fraction, std::chrono::milliseconds interval) {
+  for (auto &instance : instances_) {
+    instance->StartFlusher(clean_fraction, interval);
+  }
+}
+
+void ParallelBufferPoolManager::StopFlusher() {
+  for (auto &instance : instances_) {
+    instance->StopFlusher();
+  }
+}
+
+void ParallelBufferPoolManager::FlushPagesBefore(lsn_t rec_lsn) {
+  for (auto &instance : instances_) {
+    instance->FlushPagesBefore(rec_lsn);
+  }
+}
+
+auto ParallelBufferPoolManager::GetDirtyPageTable() -> std::vector<std::pair<page_id_t, lsn_t>> {
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  for (auto &instance : instances_) {
+    auto instance_pages = instance->GetDirtyPageTable();
+    dirty_pages.insert(dirty_pages.end(), instance_pages.begin(), instance_pages.end());
+  }
+  return dirty_pages;
+}
+
+auto ParallelBufferPoolManager::GetFlusherStats() -> FlusherStats {
+  FlusherStats stats{};
+  for (auto &instance : instances_) {
+    auto instance_stats = instance->GetFlusherStats();
+    stats.flush_rounds_ += instance_stats.flush_rounds_;
+    stats.pages_flushed_ += instance_stats.pages_flushed_;
+    stats.dirty_evictions_ += instance_stats.dirty_evictions_;
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats.Merge(instance->GetStats());
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+  for (auto &instance : instances_) {
+    instance->ResetStats();
+  }
+}
+
+auto ParallelBufferPoolManager::GetHotPages(size_t max_pages) -> std::vector<page_id_t> {
+  std::vector<std::vector<page_id_t>> instance_pages;
+  for (auto &instance : instances_) {
+    instance_pages.push_back(instance->GetHotPages(max_pages));
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t rank = 0; page_ids.size() < max_pages; rank++) {
+    bool found = false;
+    for (auto &pages : instance_pages) {
+      if (rank < pages.size() && page_ids.size() < max_pages) {
+        page_ids.push_back(pages[rank]);
+        found = true;
+      }
+    }
+    if (!found) {
+      break;
+    }
+  }
+  return page_ids;
+}
+
+auto ParallelBufferPoolManager::PrewarmPage(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->PrewarmPage(page_id);
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
+  size_t start = next_instance_.fetch_add(1) % instances_.size();
+  for (size_t i = 0; i < instances_.size(); i++) {
+    Page *page = instances_[(start + i) % instances_.size()]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
+  Page *page = NewPage(page_id);
+  if (page == nullptr) {
+    return {this, nullptr};
+  }
+  return {GetBufferPoolManager(*page_id), page};
+}
+
+auto ParallelBufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageBasic(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageRead(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageWrite(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type)
+    -> OptimisticPageGuard {
+  return GetBufferPoolManager(page_id)->FetchPageOptimistic(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
+
+auto ParallelBufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  for (auto &instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+auto ParallelBufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+}  // namespace bustub
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames, size_t k_in, size_t k_out)
+    : node_store_(num_frames),
+      k_in_(k_in > 0 ? k_in : std::max<size_t>(num_frames / 4, 1)),
+      k_out_(k_out > 0 ? k_out : std::max<size_t>(num_frames / 2, 1)) {}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  bool from_in = EvictFromIn(in_size_, !in_frames_.empty(), !main_frames_.empty());
+  auto &candidates = from_in ? in_frames_ : main_frames_;
+  if (candidates.empty()) {
+    return false;
+  }
+  *frame_id = candidates.begin()->second;
+  candidates.erase(candidates.begin());
+  Drop(*frame_id, true);
+  return true;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  TwoQueueNode &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.queue_ == Queue::None) {
+    // A new page: admit it to Am only if it was evicted from A1in recently.
+    bool was_evicted = page_id != INVALID_PAGE_ID && out_pages_.Erase(page_id);
+    node.queue_ = was_evicted && !is_scan ? Queue::Main : Queue::In;
+    node.key_ = ++current_timestamp_;
+    node.page_id_ = page_id;
+    if (node.queue_ == Queue::In) {
+      in_size_++;
+    }
+    return;
+  }
+  if (node.queue_ == Queue::In || is_scan) {
+    // Correlated reference while on probation, or a scan: neither says the page is hot.
+    return;
+  }
+  if (node.is_evictable_) {
+    main_frames_.erase({node.key_, frame_id});
+    main_frames_.emplace(current_timestamp_ + 1, frame_id);
+  }
+  node.key_ = ++current_timestamp_;
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  TwoQueueNode &node = node_store_[frame_id];
+  if (node.queue_ == Queue::None || node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictionSetOf(node.queue_).emplace(node.key_, frame_id);
+  } else {
+    EvictionSetOf(node.queue_).erase({node.key_, frame_id});
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+  std::lock_guard<std::mutex> lock(latch_);
+  TwoQueueNode &node = node_store_[frame_id];
+  if (node.queue_ == Queue::None) {
+    return;
+  }
+  if (!node.is_evictable_) {
+    throw Exception(ExceptionType::INVALID, "cannot remove a non-evictable frame");
+  }
+  EvictionSetOf(node.queue_).erase({node.key_, frame_id});
+  Drop(frame_id, false);
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return in_frames_.size() + main_frames_.size();
+}
+
+auto TwoQueueReplacer::EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> frames;
+  auto in_it = in_frames_.begin();
+  auto main_it = main_frames_.begin();
+  size_t in_size = in_size_;
+  while (frames.size() < max_frames) {
+    bool has_in = in_it != in_frames_.end();
+    bool has_main = main_it != main_frames_.end();
+    if (!has_in && !has_main) {
+      break;
+    }
+    if (EvictFromIn(in_size, has_in, has_main)) {
+      frames.push_back((in_it++)->second);
+      in_size--;
+    } else {
+      frames.push_back((main_it++)->second);
+    }
+  }
+  return frames;
+}
+
+void TwoQueueReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid frame id");
+  }
+}
+
+void TwoQueueReplacer::Drop(frame_id_t frame_id, bool remember) {
+  TwoQueueNode &node = node_store_[frame_id];
+  if (node.queue_ == Queue::In) {
+    in_size_--;
+    if (remember && node.page_id_ != INVALID_PAGE_ID) {
+      out_pages_.PushBack(node.page_id_);
+      if (out_pages_.Size() > k_out_) {
+        out_pages_.PopFront();
+      }
+    }
+  }
+  node = TwoQueueNode{};
+}
+
+}  // namespace bustub
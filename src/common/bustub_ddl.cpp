@@ -127,12 +127,24 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
 
 void BustubInstance::HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt,
                                                  ResultWriter &writer) {
+  if (stmt.variable_ == BPM_STATS_VARIABLE) {
+    auto content = buffer_pool_manager_ == nullptr ? "" : buffer_pool_manager_->GetStats().ToString();
+    WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
+    return;
+  }
   auto content = GetSessionVariable(stmt.variable_);
   WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
 }
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  if (stmt.variable_ == BPM_STATS_VARIABLE) {
+    // whatever the value, start counting from zero again
+    if (buffer_pool_manager_ != nullptr) {
+      buffer_pool_manager_->ResetStats();
+    }
+    return;
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
@@ -12,6 +12,7 @@
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -34,6 +35,9 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_posix.h"
+#include "storage/disk/disk_manager_uring.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -42,24 +46,63 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t bpm_num_instances,
+                               DiskManagerType disk_manager_type, size_t num_io_workers) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  switch (disk_manager_type) {
+    case DiskManagerType::FStream:
+      disk_manager_ = new DiskManager(db_file_name);
+      break;
+    case DiskManagerType::Posix:
+      disk_manager_ = new DiskManagerPosix(db_file_name);
+      break;
+    case DiskManagerType::PosixDirect:
+      disk_manager_ = new DiskManagerPosix(db_file_name, true);
+      break;
+    case DiskManagerType::IoUring:
+      disk_manager_ = new DiskManagerUring(db_file_name);
+      break;
+    case DiskManagerType::Mmap:
+      disk_manager_ = new DiskManagerMmap(db_file_name);
+      break;
+  }
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`. With several instances, each of them gets 128 frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (bpm_num_instances > 1) {
+      buffer_pool_manager_ = new ParallelBufferPoolManager(bpm_num_instances, 128, disk_manager_, LRUK_REPLACER_K,
+                                                           log_manager_, ReplacerType::LRUK, num_io_workers);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_,
+                                                   ReplacerType::LRUK, num_io_workers);
+    }
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
   }
 
+  // Warm the buffer pool up with the pages that were hot when the database was last used, and keep that list current.
+  if (buffer_pool_manager_ != nullptr) {
+    hot_page_file_ = db_file_name.substr(0, db_file_name.rfind('.')) + ".hot";
+    if (prewarm_budget > 0) {
+      buffer_pool_manager_->StartPrewarm(hot_page_file_, prewarm_budget);
+    }
+    buffer_pool_manager_->StartHotPageDumper(hot_page_file_, hot_page_dump_interval);
+  }
+
+#ifndef __EMSCRIPTEN__
+  // Keep some frames clean so that evictions rarely have to wait for a write.
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->StartFlusher();
+  }
+#endif
+
   // Transaction (txn) related.
 
 #ifdef __EMSCRIPTEN__
@@ -80,7 +123,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t bpm_num_instances, size_t num_io_workers) {
   enable_logging = false;
 
   // Storage related.
@@ -90,9 +133,15 @@ BustubInstance::BustubInstance() {
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`. With several instances, each of them gets 128 frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    if (bpm_num_instances > 1) {
+      buffer_pool_manager_ = new ParallelBufferPoolManager(bpm_num_instances, 128, disk_manager_, LRUK_REPLACER_K,
+                                                           log_manager_, ReplacerType::LRUK, num_io_workers);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManager(128, disk_manager_, LRUK_REPLACER_K, log_manager_,
+                                                   ReplacerType::LRUK, num_io_workers);
+    }
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -190,9 +239,10 @@ auto BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer,
   auto txn = txn_manager_->Begin();
   try {
     auto result = ExecuteSqlTxn(sql, writer, txn, std::move(check_options));
-    txn_manager_->Commit(txn);
+    // A transaction wounded by an older one is rolled back instead of committed.
+    bool committed = txn_manager_->Commit(txn);
     delete txn;
-    return result;
+    return result && committed;
   } catch (bustub::Exception &ex) {
     txn_manager_->Abort(txn);
     delete txn;
@@ -343,8 +393,13 @@ BustubInstance::~BustubInstance() {
   delete execution_engine_;
   delete catalog_;
   delete checkpoint_manager_;
-  delete log_manager_;
+  if (!hot_page_file_.empty()) {
+    buffer_pool_manager_->StopHotPageDumper();
+    buffer_pool_manager_->DumpHotPages(hot_page_file_);
+  }
+  // The buffer pool's threads flush the log before writing pages back, it has to go first.
   delete buffer_pool_manager_;
+  delete log_manager_;
   delete lock_manager_;
   delete txn_manager_;
   delete disk_manager_;
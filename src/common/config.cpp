@@ -20,4 +20,18 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+DeadlockPolicy deadlock_policy = DeadlockPolicy::Detection;
+
+std::chrono::milliseconds checkpoint_interval = std::chrono::seconds(30);
+
+size_t log_segment_size = 16 << 20;
+
+HugePageMode frame_huge_pages = HugePageMode::Transparent;
+
+int frame_numa_node = NUMA_DEFAULT;
+
+std::chrono::milliseconds hot_page_dump_interval = std::chrono::seconds(10);
+
+size_t prewarm_budget = 65536;
+
 }  // namespace bustub
@@ -12,12 +12,104 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <cstdint>
+#include <functional>
+#include <iterator>
+
 #include "common/config.h"
 #include "concurrency/transaction.h"
 #include "concurrency/transaction_manager.h"
 
 namespace bustub {
 
+namespace {
+
+/** Most freed request nodes a thread keeps for reuse. */
+constexpr size_t REQUEST_POOL_SIZE = 1024;
+
+/**
+ * @return the list nodes of the requests this thread removed from queues. Nodes move between lists without being
+ * reallocated, so a thread that takes and releases locks in a loop stops allocating once it has a few.
+ */
+auto FreeRequests() -> std::list<LockManager::LockRequest> & {
+  thread_local std::list<LockManager::LockRequest> free_requests;
+  return free_requests;
+}
+
+}  // namespace
+
+auto LockManager::LockRequestQueue::Insert(Iterator pos, const LockRequest &request) -> Iterator {
+  auto &free_requests = FreeRequests();
+  if (free_requests.empty()) {
+    return request_queue_.insert(pos, request);
+  }
+  request_queue_.splice(pos, free_requests, free_requests.begin());
+  auto inserted = std::prev(pos);
+  *inserted = request;
+  return inserted;
+}
+
+void LockManager::LockRequestQueue::Erase(Iterator request) {
+  auto &free_requests = FreeRequests();
+  if (free_requests.size() >= REQUEST_POOL_SIZE) {
+    request_queue_.erase(request);
+    return;
+  }
+  free_requests.splice(free_requests.begin(), request_queue_, request);
+}
+
+template <typename Key>
+auto LockManager::ShardOf(LockMap<Key> *lock_map, const Key &key) -> LockMapShard<Key> & {
+  // The standard hash of integers is the identity. Multiplying spreads its low bits over the high ones, or the same
+  // slot of every page would end up in the same shard.
+  uint64_t hash = static_cast<uint64_t>(std::hash<Key>{}(key)) * 0x9e3779b97f4a7c15ULL;
+  return (*lock_map)[(hash >> 32) % NUM_LOCK_MAP_SHARDS];
+}
+
+template <typename Key>
+auto LockManager::LatchQueue(LockMap<Key> *lock_map, const Key &key, bool create) -> LockRequestQueue * {
+  auto &shard = ShardOf(lock_map, key);
+  std::scoped_lock shard_lock(shard.latch_);
+  auto it = shard.map_.find(key);
+  if (it == shard.map_.end()) {
+    if (!create) {
+      return nullptr;
+    }
+    std::unique_ptr<LockRequestQueue> queue;
+    if (shard.free_queues_.empty()) {
+      queue = std::make_unique<LockRequestQueue>();
+    } else {
+      queue = std::move(shard.free_queues_.back());
+      shard.free_queues_.pop_back();
+    }
+    it = shard.map_.emplace(key, std::move(queue)).first;
+  }
+  it->second->latch_.lock();
+  return it->second.get();
+}
+
+template <typename Key>
+void LockManager::RemoveQueueIfEmpty(LockMap<Key> *lock_map, const Key &key) {
+  auto &shard = ShardOf(lock_map, key);
+  std::scoped_lock shard_lock(shard.latch_);
+  auto it = shard.map_.find(key);
+  if (it == shard.map_.end()) {
+    return;
+  }
+  {
+    // Another request may have come in since the caller let go of the queue.
+    std::scoped_lock queue_lock(it->second->latch_);
+    if (!it->second->request_queue_.empty()) {
+      return;
+    }
+  }
+  // Nobody waits on an empty queue, and no one can find it any more once it is out of the map.
+  if (shard.free_queues_.size() < QUEUE_POOL_SIZE) {
+    shard.free_queues_.push_back(std::move(it->second));
+  }
+  shard.map_.erase(it);
+}
+
 auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
   // 判断事务的隔离级别，事务所处阶段和事务申请加的锁是否有冲突
   if (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED) {
@@ -46,29 +138,23 @@ auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oi
       throw TransactionAbortException(txn->GetTransactionId(), AbortReason::LOCK_ON_SHRINKING);
     }
   }
-  // 加锁时要获得lock_manager的互斥锁，确保加锁的过程不发生竞争
-  table_lock_map_latch_.lock();
-  if (table_lock_map_.find(oid) == table_lock_map_.end()) {
-    table_lock_map_.emplace(oid, std::make_shared<LockRequestQueue>());
-  }
-  // 找到目标表的请求队列
-  auto lock_request_queue = table_lock_map_.find(oid)->second;
-  // 防止争抢，先对队列上锁，然后再放开tablemap的锁
-  lock_request_queue->latch_.lock();
-  table_lock_map_latch_.unlock();
+  // 找到目标表的请求队列，拿到时队列已经上锁，只有同一分片的事务之间会争抢分片的锁
+  auto *lock_request_queue = LatchQueue(&table_lock_map_, oid, true);
+  // 用unique_lock管理请求队列的锁
+  std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
 
-  for (auto request : lock_request_queue->request_queue_) {  // NOLINT
+  auto &request_queue = lock_request_queue->request_queue_;
+  for (auto request = request_queue.begin(); request != request_queue.end(); request++) {
     // 如果当前事务已经对该table加过锁，那么此次加锁操作就是一次升级操作
     if (request->txn_id_ == txn->GetTransactionId()) {
       // 加的是同一把锁，直接返回true即可
       if (request->lock_mode_ == lock_mode) {
-        lock_request_queue->latch_.unlock();
         return true;
       }
       // upgrading_!=INVALID_TXN_ID表示已经有一个事务提出了对其加在该表上的锁的升级请求，但还没批准（grant），此时如果另一个事务也提升级，
       // 会造成冲突，不允许
       if (lock_request_queue->upgrading_ != INVALID_TXN_ID) {
-        lock_request_queue->latch_.unlock();
+        lock.unlock();
         txn->SetState(TransactionState::ABORTED);
         throw TransactionAbortException(txn->GetTransactionId(), AbortReason::UPGRADE_CONFLICT);
       }
@@ -81,57 +167,40 @@ auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oi
           !(request->lock_mode_ == LockMode::INTENTION_EXCLUSIVE &&
             (lock_mode == LockMode::EXCLUSIVE || lock_mode == LockMode::SHARED_INTENTION_EXCLUSIVE)) &&
           !(request->lock_mode_ == LockMode::SHARED_INTENTION_EXCLUSIVE && (lock_mode == LockMode::EXCLUSIVE))) {
-        lock_request_queue->latch_.unlock();
+        lock.unlock();
         txn->SetState(TransactionState::ABORTED);
         throw TransactionAbortException(txn->GetTransactionId(), AbortReason::INCOMPATIBLE_UPGRADE);
       }
       // 开始锁升级的流程
       // 为什么此过程不会出现争抢？因为想对该table加锁必须要通过该函数，必须要拿到请求队列，新事务要加锁会因为
-      // 此处在升级而无法取得请求队列的锁而无法继续往下走。又因为请求队列是用智能指针管理，可以保证别的事务在
-      // 队列更新前取得了队列，在更新队列后，更新也会同步到之前取得的队列。
+      // 此处在升级而无法取得请求队列的锁而无法继续往下走。
 
-      // 因为锁升级了，得把之前的请求从队列中移除
-      lock_request_queue->request_queue_.remove(request);
       // 锁升级，类型变更，需要改变事务自身维护的持有锁集合，false表示删除
-      InsertOrDeleteTableLockSet(txn, request, false);
-      // 新锁的请求实例
-      auto upgrade_lock_request = std::make_shared<LockRequest>(txn->GetTransactionId(), lock_mode, oid);
+      InsertOrDeleteTableLockSet(txn, *request, false);
+      // 因为锁升级了，得把之前的请求从队列中移除
+      lock_request_queue->Erase(request);
 
-      auto lr_iter = lock_request_queue->request_queue_.begin();
-      for (; lr_iter != lock_request_queue->request_queue_.end(); lr_iter++) {
+      auto lr_iter = request_queue.begin();
+      for (; lr_iter != request_queue.end(); lr_iter++) {
         // 无效请求
-        if (!(*lr_iter)->granted_) {
+        if (!lr_iter->granted_) {
           break;
         }
       }
-      // 将新请求加入队列
-      lock_request_queue->request_queue_.insert(lr_iter, upgrade_lock_request);
+      // 将新请求加入队列，新请求复用的是刚移除的请求的节点
+      auto upgrade_lock_request =
+          lock_request_queue->Insert(lr_iter, LockRequest(txn->GetTransactionId(), lock_mode, oid));
       lock_request_queue->upgrading_ = txn->GetTransactionId();
 
-      // 用unique_lock管理请求队列的锁
-      std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
-      // 为啥用while？
-      // 当事务被从阻塞队列中唤醒后，其所请求加的锁可能与已经加的锁任然不兼容，还需要要做一次判断
-      // while能够比较优雅的实现
-      while (!GrantLock(upgrade_lock_request, lock_request_queue)) {
-        // 使用条件变量的常用方法，wait中传入一把锁lock
-        // 将自己加入条件变量的等待队列后将lock解锁，此时table的请求队列的锁是可以被其它事务拿到
-        // 当其它线程调用notify后，所有等待线程争抢这把lock，抢到的继续执行
-        lock_request_queue->cv_.wait(lock);
-        // 走到这说明抢到了lock，此时请求队列是上锁的
-        // 查看事务当前的状态，如果是abort就notify，唤醒其它等待队列上阻塞的线程
-        // 为什么事务阻塞在请求锁的过程中状态会有可能被设置为aborted？因为发生了死锁，被死锁检测进程给强行设置的
-        if (txn->GetState() == TransactionState::ABORTED) {
-          lock_request_queue->upgrading_ = INVALID_TXN_ID;
-          lock_request_queue->request_queue_.remove(upgrade_lock_request);
-          lock_request_queue->cv_.notify_all();
-          return false;
-        }
+      if (!WaitForGrant(txn, lock_request_queue, upgrade_lock_request, &lock, WaitTarget{false, oid, RID()})) {
+        lock.unlock();
+        RemoveQueueIfEmpty(&table_lock_map_, oid);
+        return false;
       }
       // 事务申请的锁被允许了，如果是升级锁，此时锁的升级已经完成，允许其它事务继续进行升级
       lock_request_queue->upgrading_ = INVALID_TXN_ID;
       upgrade_lock_request->granted_ = true;
-      InsertOrDeleteTableLockSet(txn, upgrade_lock_request, true);
+      InsertOrDeleteTableLockSet(txn, *upgrade_lock_request, true);
 
       // 只有排他锁与一切其它锁不兼容，别的锁需要进行一次唤醒，找出与其兼容的事务进行执行
       if (lock_mode != LockMode::EXCLUSIVE) {
@@ -142,21 +211,17 @@ auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oi
     }
   }
   // 这一步，表明当前事务加锁不是升级操作，而是申请新的锁
-  auto lock_request = std::make_shared<LockRequest>(txn->GetTransactionId(), lock_mode, oid);
-  lock_request_queue->request_queue_.push_back(lock_request);
+  auto lock_request =
+      lock_request_queue->Insert(request_queue.end(), LockRequest(txn->GetTransactionId(), lock_mode, oid));
 
-  std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
-  while (!GrantLock(lock_request, lock_request_queue)) {
-    lock_request_queue->cv_.wait(lock);
-    if (txn->GetState() == TransactionState::ABORTED) {
-      lock_request_queue->request_queue_.remove(lock_request);
-      lock_request_queue->cv_.notify_all();
-      return false;
-    }
+  if (!WaitForGrant(txn, lock_request_queue, lock_request, &lock, WaitTarget{false, oid, RID()})) {
+    lock.unlock();
+    RemoveQueueIfEmpty(&table_lock_map_, oid);
+    return false;
   }
 
   lock_request->granted_ = true;
-  InsertOrDeleteTableLockSet(txn, lock_request, true);
+  InsertOrDeleteTableLockSet(txn, *lock_request, true);
 
   if (lock_mode != LockMode::EXCLUSIVE) {
     lock_request_queue->cv_.notify_all();
@@ -166,45 +231,48 @@ auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oi
 }
 
 auto LockManager::UnlockTable(Transaction *txn, const table_oid_t &oid) -> bool {
-  table_lock_map_latch_.lock();
+  auto *lock_request_queue = LatchQueue(&table_lock_map_, oid, false);
   // 没有锁
-  if (table_lock_map_.find(oid) == table_lock_map_.end()) {
-    table_lock_map_latch_.unlock();
+  if (lock_request_queue == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     throw bustub::TransactionAbortException(txn->GetTransactionId(), AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
   }
+  std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
   // 解表锁的前提是该事务没有在该表中的任意一行加锁，如果加了，此解锁操作就是非法的
   auto s_row_lock_set = txn->GetSharedRowLockSet();
   auto x_row_lock_set = txn->GetExclusiveRowLockSet();
   // 有行锁，非法
   if (!(s_row_lock_set->find(oid) == s_row_lock_set->end() || s_row_lock_set->at(oid).empty()) ||
       !(x_row_lock_set->find(oid) == x_row_lock_set->end() || x_row_lock_set->at(oid).empty())) {
-    table_lock_map_latch_.unlock();
+    lock.unlock();
     txn->SetState(TransactionState::ABORTED);
     throw bustub::TransactionAbortException(txn->GetTransactionId(), AbortReason::TABLE_UNLOCKED_BEFORE_UNLOCKING_ROWS);
   }
-  // 可以开始解表锁
-  auto lock_request_queue = table_lock_map_[oid];
 
-  lock_request_queue->latch_.lock();
-  table_lock_map_latch_.unlock();
-
-  for (auto lock_request : lock_request_queue->request_queue_) {  // NOLINT
-    if (lock_request->txn_id_ == txn->GetTransactionId() && lock_request->granted_) {
-      lock_request_queue->request_queue_.remove(lock_request);
+  // 可以开始解表锁
+  auto &request_queue = lock_request_queue->request_queue_;
+  for (auto request = request_queue.begin(); request != request_queue.end(); request++) {
+    if (request->txn_id_ == txn->GetTransactionId() && request->granted_) {
+      LockRequest lock_request = *request;
+      lock_request_queue->Erase(request);
+      ForgetBlocker(*lock_request_queue, txn->GetTransactionId());
+      bool empty = request_queue.empty();
 
       lock_request_queue->cv_.notify_all();
-      lock_request_queue->latch_.unlock();
+      lock.unlock();
+      // 队列空了就从表中移除，表中只留下有人加锁的资源
+      if (empty) {
+        RemoveQueueIfEmpty(&table_lock_map_, oid);
+      }
       // 检查对应隔离级别下解该锁要进入shrinking态
       if ((txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ &&
-           (lock_request->lock_mode_ == LockMode::SHARED || lock_request->lock_mode_ == LockMode::EXCLUSIVE)) ||
+           (lock_request.lock_mode_ == LockMode::SHARED || lock_request.lock_mode_ == LockMode::EXCLUSIVE)) ||
           (txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED &&
-           lock_request->lock_mode_ == LockMode::EXCLUSIVE) ||
+           lock_request.lock_mode_ == LockMode::EXCLUSIVE) ||
           (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED &&
-           lock_request->lock_mode_ == LockMode::EXCLUSIVE)) {
-        if (txn->GetState() != TransactionState::COMMITTED && txn->GetState() != TransactionState::ABORTED) {
-          txn->SetState(TransactionState::SHRINKING);
-        }
+           lock_request.lock_mode_ == LockMode::EXCLUSIVE)) {
+        // 只有growing态才进入shrinking态，用CAS避免覆盖其它事务同时写入的abort
+        txn->CompareAndSetState(TransactionState::GROWING, TransactionState::SHRINKING);
       }
 
       InsertOrDeleteTableLockSet(txn, lock_request, false);
@@ -212,7 +280,7 @@ auto LockManager::UnlockTable(Transaction *txn, const table_oid_t &oid) -> bool
     }
   }
   // 解表锁失败，原因：1.本事务没有上表锁。 2.本事务的表锁没有被允许
-  lock_request_queue->latch_.unlock();
+  lock.unlock();
   txn->SetState(TransactionState::ABORTED);
   throw bustub::TransactionAbortException(txn->GetTransactionId(), AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
 }
@@ -258,23 +326,18 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
     }
   }
 
-  row_lock_map_latch_.lock();
-  if (row_lock_map_.find(rid) == row_lock_map_.end()) {
-    row_lock_map_.emplace(rid, std::make_shared<LockRequestQueue>());
-  }
-  auto lock_request_queue = row_lock_map_.find(rid)->second;
-  lock_request_queue->latch_.lock();
-  row_lock_map_latch_.unlock();
+  auto *lock_request_queue = LatchQueue(&row_lock_map_, rid, true);
+  std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
 
-  for (auto request : lock_request_queue->request_queue_) {  // NOLINT
+  auto &request_queue = lock_request_queue->request_queue_;
+  for (auto request = request_queue.begin(); request != request_queue.end(); request++) {
     if (request->txn_id_ == txn->GetTransactionId()) {
       if (request->lock_mode_ == lock_mode) {
-        lock_request_queue->latch_.unlock();
         return true;
       }
 
       if (lock_request_queue->upgrading_ != INVALID_TXN_ID) {
-        lock_request_queue->latch_.unlock();
+        lock.unlock();
         txn->SetState(TransactionState::ABORTED);
         throw TransactionAbortException(txn->GetTransactionId(), AbortReason::UPGRADE_CONFLICT);
       }
@@ -287,39 +350,33 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
           !(request->lock_mode_ == LockMode::INTENTION_EXCLUSIVE &&
             (lock_mode == LockMode::EXCLUSIVE || lock_mode == LockMode::SHARED_INTENTION_EXCLUSIVE)) &&
           !(request->lock_mode_ == LockMode::SHARED_INTENTION_EXCLUSIVE && (lock_mode == LockMode::EXCLUSIVE))) {
-        lock_request_queue->latch_.unlock();
+        lock.unlock();
         txn->SetState(TransactionState::ABORTED);
         throw TransactionAbortException(txn->GetTransactionId(), AbortReason::INCOMPATIBLE_UPGRADE);
       }
 
-      lock_request_queue->request_queue_.remove(request);
-      InsertOrDeleteRowLockSet(txn, request, false);
-      auto upgrade_lock_request = std::make_shared<LockRequest>(txn->GetTransactionId(), lock_mode, oid, rid);
+      InsertOrDeleteRowLockSet(txn, *request, false);
+      lock_request_queue->Erase(request);
 
-      std::list<std::shared_ptr<LockRequest>>::iterator lr_iter;
-      for (lr_iter = lock_request_queue->request_queue_.begin(); lr_iter != lock_request_queue->request_queue_.end();
-           lr_iter++) {
-        if (!(*lr_iter)->granted_) {
+      auto lr_iter = request_queue.begin();
+      for (; lr_iter != request_queue.end(); lr_iter++) {
+        if (!lr_iter->granted_) {
           break;
         }
       }
-      lock_request_queue->request_queue_.insert(lr_iter, upgrade_lock_request);
+      auto upgrade_lock_request =
+          lock_request_queue->Insert(lr_iter, LockRequest(txn->GetTransactionId(), lock_mode, oid, rid));
       lock_request_queue->upgrading_ = txn->GetTransactionId();
 
-      std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
-      while (!GrantLock(upgrade_lock_request, lock_request_queue)) {
-        lock_request_queue->cv_.wait(lock);
-        if (txn->GetState() == TransactionState::ABORTED) {
-          lock_request_queue->upgrading_ = INVALID_TXN_ID;
-          lock_request_queue->request_queue_.remove(upgrade_lock_request);
-          lock_request_queue->cv_.notify_all();
-          return false;
-        }
+      if (!WaitForGrant(txn, lock_request_queue, upgrade_lock_request, &lock, WaitTarget{true, oid, rid})) {
+        lock.unlock();
+        RemoveQueueIfEmpty(&row_lock_map_, rid);
+        return false;
       }
 
       lock_request_queue->upgrading_ = INVALID_TXN_ID;
       upgrade_lock_request->granted_ = true;
-      InsertOrDeleteRowLockSet(txn, upgrade_lock_request, true);
+      InsertOrDeleteRowLockSet(txn, *upgrade_lock_request, true);
 
       if (lock_mode != LockMode::EXCLUSIVE) {
         lock_request_queue->cv_.notify_all();
@@ -328,21 +385,17 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
     }
   }
 
-  auto lock_request = std::make_shared<LockRequest>(txn->GetTransactionId(), lock_mode, oid, rid);
-  lock_request_queue->request_queue_.push_back(lock_request);
+  auto lock_request =
+      lock_request_queue->Insert(request_queue.end(), LockRequest(txn->GetTransactionId(), lock_mode, oid, rid));
 
-  std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
-  while (!GrantLock(lock_request, lock_request_queue)) {
-    lock_request_queue->cv_.wait(lock);
-    if (txn->GetState() == TransactionState::ABORTED) {
-      lock_request_queue->request_queue_.remove(lock_request);
-      lock_request_queue->cv_.notify_all();
-      return false;
-    }
+  if (!WaitForGrant(txn, lock_request_queue, lock_request, &lock, WaitTarget{true, oid, rid})) {
+    lock.unlock();
+    RemoveQueueIfEmpty(&row_lock_map_, rid);
+    return false;
   }
 
   lock_request->granted_ = true;
-  InsertOrDeleteRowLockSet(txn, lock_request, true);
+  InsertOrDeleteRowLockSet(txn, *lock_request, true);
 
   if (lock_mode != LockMode::EXCLUSIVE) {
     lock_request_queue->cv_.notify_all();
@@ -352,34 +405,34 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
 }
 
 auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid, bool force) -> bool {
-  row_lock_map_latch_.lock();
-
-  if (row_lock_map_.find(rid) == row_lock_map_.end()) {
-    row_lock_map_latch_.unlock();
+  auto *lock_request_queue = LatchQueue(&row_lock_map_, rid, false);
+  if (lock_request_queue == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     throw bustub::TransactionAbortException(txn->GetTransactionId(), AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
   }
-  auto lock_request_queue = row_lock_map_[rid];
-
-  lock_request_queue->latch_.lock();
-  row_lock_map_latch_.unlock();
+  std::unique_lock<std::mutex> lock(lock_request_queue->latch_, std::adopt_lock);
 
-  for (auto lock_request : lock_request_queue->request_queue_) {  // NOLINT
-    if (lock_request->txn_id_ == txn->GetTransactionId() && lock_request->granted_) {
-      lock_request_queue->request_queue_.remove(lock_request);
+  auto &request_queue = lock_request_queue->request_queue_;
+  for (auto request = request_queue.begin(); request != request_queue.end(); request++) {
+    if (request->txn_id_ == txn->GetTransactionId() && request->granted_) {
+      LockRequest lock_request = *request;
+      lock_request_queue->Erase(request);
+      ForgetBlocker(*lock_request_queue, txn->GetTransactionId());
+      bool empty = request_queue.empty();
 
       lock_request_queue->cv_.notify_all();
-      lock_request_queue->latch_.unlock();
+      lock.unlock();
+      if (empty) {
+        RemoveQueueIfEmpty(&row_lock_map_, rid);
+      }
 
       if ((txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ &&
-           (lock_request->lock_mode_ == LockMode::SHARED || lock_request->lock_mode_ == LockMode::EXCLUSIVE)) ||
+           (lock_request.lock_mode_ == LockMode::SHARED || lock_request.lock_mode_ == LockMode::EXCLUSIVE)) ||
           (txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED &&
-           lock_request->lock_mode_ == LockMode::EXCLUSIVE) ||
+           lock_request.lock_mode_ == LockMode::EXCLUSIVE) ||
           (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED &&
-           lock_request->lock_mode_ == LockMode::EXCLUSIVE)) {
-        if (txn->GetState() != TransactionState::COMMITTED && txn->GetState() != TransactionState::ABORTED) {
-          txn->SetState(TransactionState::SHRINKING);
-        }
+           lock_request.lock_mode_ == LockMode::EXCLUSIVE)) {
+        txn->CompareAndSetState(TransactionState::GROWING, TransactionState::SHRINKING);
       }
 
       InsertOrDeleteRowLockSet(txn, lock_request, false);
@@ -387,51 +440,57 @@ auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID
     }
   }
 
-  lock_request_queue->latch_.unlock();
+  lock.unlock();
   txn->SetState(TransactionState::ABORTED);
   throw bustub::TransactionAbortException(txn->GetTransactionId(), AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
 }
 
 void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {
-  txn_set_.insert(t1);
-  txn_set_.insert(t2);
+  std::scoped_lock lock(waits_for_latch_);
   waits_for_[t1].push_back(t2);
 }
 
 void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {
-  auto iter = std::find(waits_for_[t1].begin(), waits_for_[t1].end(), t2);
-  if (iter != waits_for_[t1].end()) {
-    waits_for_[t1].erase(iter);
+  std::scoped_lock lock(waits_for_latch_);
+  auto it = waits_for_.find(t1);
+  if (it == waits_for_.end()) {
+    return;
+  }
+  auto iter = std::find(it->second.begin(), it->second.end(), t2);
+  if (iter != it->second.end()) {
+    it->second.erase(iter);
   }
 }
 
 auto LockManager::HasCycle(txn_id_t *txn_id) -> bool {
-  for (auto const &start_txn_id : txn_set_) {
-    if (Dfs(start_txn_id)) {
-      *txn_id = *active_set_.begin();
-      // 找到最大的事务号
-      for (auto const &active_txn_id : active_set_) {
-        *txn_id = std::max(*txn_id, active_txn_id);
-      }
-      active_set_.clear();
+  std::scoped_lock lock(waits_for_latch_);
+  std::vector<txn_id_t> txns;
+  txns.reserve(waits_for_.size());
+  for (const auto &[txn, edges] : waits_for_) {
+    txns.push_back(txn);
+  }
+  // 从事务号最小的点开始搜索，结果与遍历哈希表的顺序无关
+  std::sort(txns.begin(), txns.end());
+  std::unordered_set<txn_id_t> safe;
+  std::vector<txn_id_t> path;
+  for (txn_id_t start : txns) {
+    if (safe.count(start) == 0 && FindCycle(start, &path, &safe, txn_id)) {
       return true;
     }
-
-    active_set_.clear();
   }
   return false;
 }
+
 auto LockManager::DeleteNode(txn_id_t txn_id) -> void {
+  std::scoped_lock lock(waits_for_latch_);
   waits_for_.erase(txn_id);
-
-  for (auto a_txn_id : txn_set_) {
-    if (a_txn_id != txn_id) {
-      RemoveEdge(a_txn_id, txn_id);
-    }
+  for (auto &[txn, edges] : waits_for_) {
+    edges.erase(std::remove(edges.begin(), edges.end(), txn_id), edges.end());
   }
 }
 
 auto LockManager::GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>> {
+  std::scoped_lock lock(waits_for_latch_);
   std::vector<std::pair<txn_id_t, txn_id_t>> result;
   for (auto const &pair : waits_for_) {
     auto t1 = pair.first;
@@ -442,75 +501,227 @@ auto LockManager::GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>> {
   return result;
 }
 
+void LockManager::StartDeadlockDetection() {
+  if (policy_ != DeadlockPolicy::Detection) {
+    return;
+  }
+  std::call_once(cycle_detection_started_, [this] {
+    enable_cycle_detection_ = true;
+    cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
+  });
+}
+
 void LockManager::RunCycleDetection() {
   while (enable_cycle_detection_) {
     std::this_thread::sleep_for(cycle_detection_interval);
-    {  // TODO(students): detect deadlock
-      table_lock_map_latch_.lock();
-      row_lock_map_latch_.lock();
-      for (auto &pair : table_lock_map_) {
-        std::unordered_set<txn_id_t> granted_set;
-        pair.second->latch_.lock();
-        for (auto const &lock_request : pair.second->request_queue_) {
-          if (lock_request->granted_) {
-            granted_set.emplace(lock_request->txn_id_);
-          } else {
-            for (auto txn_id : granted_set) {
-              map_txn_oid_.emplace(lock_request->txn_id_, lock_request->oid_);
-              AddEdge(lock_request->txn_id_, txn_id);
-            }
+    std::vector<WaitTarget> victims;
+    {
+      std::scoped_lock lock(waits_for_latch_);
+      // 新形成的环一定经过一条新加入的边，只需从这一轮新阻塞的事务出发搜索
+      std::vector<txn_id_t> new_waiters;
+      new_waiters.swap(new_waiters_);
+      std::unordered_set<txn_id_t> safe;
+      std::vector<txn_id_t> path;
+      for (txn_id_t start : new_waiters) {
+        txn_id_t victim;
+        while (safe.count(start) == 0 && FindCycle(start, &path, &safe, &victim)) {
+          // 环上只有阻塞中的事务，它们都还没有结束
+          TransactionManager::GetTransaction(victim)->SetState(TransactionState::ABORTED);
+          waits_for_.erase(victim);
+          auto target = waiting_on_.find(victim);
+          if (target != waiting_on_.end()) {
+            victims.push_back(target->second);
           }
+          path.clear();
         }
-        pair.second->latch_.unlock();
       }
+    }
+    // 唤醒被终止的事务，不能在持有waits_for_latch_时去拿队列的锁
+    for (const auto &target : victims) {
+      Wake(target);
+    }
+  }
+}
 
-      for (auto &pair : row_lock_map_) {
-        std::unordered_set<txn_id_t> granted_set;
-        pair.second->latch_.lock();
-        for (auto const &lock_request : pair.second->request_queue_) {
-          if (lock_request->granted_) {
-            granted_set.emplace(lock_request->txn_id_);
-          } else {
-            for (auto txn_id : granted_set) {
-              map_txn_rid_.emplace(lock_request->txn_id_, lock_request->rid_);
-              AddEdge(lock_request->txn_id_, txn_id);
-            }
-          }
-        }
-        pair.second->latch_.unlock();
+auto LockManager::FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *path, std::unordered_set<txn_id_t> *safe,
+                            txn_id_t *victim) -> bool {
+  auto on_path = std::find(path->begin(), path->end(), txn_id);
+  if (on_path != path->end()) {
+    // 找到环，环上事务号最大的是最新的事务
+    *victim = *std::max_element(on_path, path->end());
+    return true;
+  }
+  auto edges = waits_for_.find(txn_id);
+  if (edges != waits_for_.end()) {
+    path->push_back(txn_id);
+    for (txn_id_t next : edges->second) {
+      if (safe->count(next) == 0 && FindCycle(next, path, safe, victim)) {
+        return true;
       }
+    }
+    path->pop_back();
+  }
+  safe->insert(txn_id);
+  return false;
+}
 
-      row_lock_map_latch_.unlock();
-      table_lock_map_latch_.unlock();
+auto LockManager::WaitForGrant(Transaction *txn, LockRequestQueue *queue, LockRequestQueue::Iterator request,
+                               std::unique_lock<std::mutex> *lock, const WaitTarget &target) -> bool {
+  bool blocked = false;
+  bool aborted = false;
+  // 为啥用while？
+  // 当事务被从阻塞队列中唤醒后，其所请求加的锁可能与已经加的锁任然不兼容，还需要要做一次判断
+  // while能够比较优雅的实现
+  while (!GrantLock(*request, *queue)) {
+    // 先登记等待关系再检查事务状态：此后终止该事务的线程都会唤醒它
+    std::vector<WaitTarget> wounded;
+    BlockOn(txn, *queue, *request, target, &wounded);
+    blocked = true;
+    if (txn->GetState() == TransactionState::ABORTED) {
+      aborted = true;
+      break;
+    }
+    if (!wounded.empty()) {
+      // 唤醒被抢占的事务时不能持有本队列的锁，放开后要重新判断能否加锁
+      lock->unlock();
+      for (const auto &wounded_target : wounded) {
+        Wake(wounded_target);
+      }
+      lock->lock();
+      continue;
+    }
+    // 使用条件变量的常用方法，wait中传入一把锁lock
+    // 将自己加入条件变量的等待队列后将lock解锁，此时请求队列的锁是可以被其它事务拿到
+    // 当其它线程调用notify后，所有等待线程争抢这把lock，抢到的继续执行
+    queue->cv_.wait(*lock);
+    // 走到这说明抢到了lock，此时请求队列是上锁的
+    // 为什么事务阻塞在请求锁的过程中状态会有可能被设置为aborted？因为发生了死锁，被死锁检测进程或者更老的事务强行设置的
+    if (txn->GetState() == TransactionState::ABORTED) {
+      aborted = true;
+      break;
+    }
+  }
+  if (blocked) {
+    StopWaiting(txn->GetTransactionId());
+  }
+  if (!aborted) {
+    return true;
+  }
+  // 查看事务当前的状态，如果是abort就notify，唤醒其它等待队列上阻塞的线程
+  if (queue->upgrading_ == txn->GetTransactionId()) {
+    queue->upgrading_ = INVALID_TXN_ID;
+  }
+  queue->Erase(request);
+  queue->cv_.notify_all();
+  return false;
+}
 
-      txn_id_t txn_id;
-      while (HasCycle(&txn_id)) {
-        Transaction *txn = TransactionManager::GetTransaction(txn_id);
+void LockManager::BlockOn(Transaction *txn, const LockRequestQueue &queue, const LockRequest &request,
+                          const WaitTarget &target, std::vector<WaitTarget> *wounded) {
+  // 已加的锁都排在队列前面：等待的是与之不兼容的已加锁事务，以及排在前面的等待事务
+  std::vector<txn_id_t> blockers;
+  for (const auto &other : queue.request_queue_) {
+    if (&other == &request) {
+      break;
+    }
+    if (!other.granted_ || !AreCompatible(other.lock_mode_, request.lock_mode_)) {
+      blockers.push_back(other.txn_id_);
+    }
+  }
+  txn_id_t txn_id = txn->GetTransactionId();
+
+  switch (policy_) {
+    case DeadlockPolicy::Detection: {
+      StartDeadlockDetection();
+      std::scoped_lock lock(waits_for_latch_);
+      waiting_on_[txn_id] = target;
+      auto &edges = waits_for_[txn_id];
+      if (edges != blockers) {
+        edges = std::move(blockers);
+        new_waiters_.push_back(txn_id);
+      }
+      break;
+    }
+    case DeadlockPolicy::WaitDie:
+      // 事务号小的事务更老，只允许老事务等新事务
+      if (std::any_of(blockers.begin(), blockers.end(), [txn_id](txn_id_t blocker) { return blocker < txn_id; })) {
         txn->SetState(TransactionState::ABORTED);
-        DeleteNode(txn_id);
-
-        if (map_txn_oid_.count(txn_id) > 0) {
-          table_lock_map_[map_txn_oid_[txn_id]]->latch_.lock();
-          table_lock_map_[map_txn_oid_[txn_id]]->cv_.notify_all();
-          table_lock_map_[map_txn_oid_[txn_id]]->latch_.unlock();
+      }
+      break;
+    case DeadlockPolicy::WoundWait: {
+      std::scoped_lock lock(waits_for_latch_);
+      waiting_on_[txn_id] = target;
+      for (txn_id_t blocker : blockers) {
+        if (blocker < txn_id) {
+          continue;
         }
-
-        if (map_txn_rid_.count(txn_id) > 0) {
-          row_lock_map_[map_txn_rid_[txn_id]]->latch_.lock();
-          row_lock_map_[map_txn_rid_[txn_id]]->cv_.notify_all();
-          row_lock_map_[map_txn_rid_[txn_id]]->latch_.unlock();
+        // 持有本队列的锁，排在前面的事务还没有释放锁，也就还没有结束
+        Transaction *younger = TransactionManager::GetTransaction(blocker);
+        // 用CAS终止，不会覆盖该事务自己同时写入的提交或终止状态
+        if (!younger->FinishRunning(TransactionState::ABORTED)) {
+          continue;
+        }
+        auto younger_target = waiting_on_.find(blocker);
+        if (younger_target != waiting_on_.end()) {
+          wounded->push_back(younger_target->second);
         }
       }
+      break;
+    }
+  }
+}
 
-      waits_for_.clear();
-      safe_set_.clear();
-      txn_set_.clear();
-      map_txn_oid_.clear();
-      map_txn_rid_.clear();
+void LockManager::StopWaiting(txn_id_t txn_id) {
+  if (policy_ == DeadlockPolicy::WaitDie) {
+    return;
+  }
+  std::scoped_lock lock(waits_for_latch_);
+  waiting_on_.erase(txn_id);
+  waits_for_.erase(txn_id);
+}
+
+void LockManager::ForgetBlocker(const LockRequestQueue &queue, txn_id_t txn_id) {
+  if (policy_ != DeadlockPolicy::Detection) {
+    return;
+  }
+  std::scoped_lock lock(waits_for_latch_);
+  for (const auto &request : queue.request_queue_) {
+    if (request.granted_) {
+      continue;
+    }
+    auto edges = waits_for_.find(request.txn_id_);
+    if (edges != waits_for_.end()) {
+      edges->second.erase(std::remove(edges->second.begin(), edges->second.end(), txn_id), edges->second.end());
     }
   }
 }
 
+void LockManager::Wake(const WaitTarget &target) {
+  // 队列不在了说明已经没有事务在等待
+  auto *lock_request_queue =
+      target.row_ ? LatchQueue(&row_lock_map_, target.rid_, false) : LatchQueue(&table_lock_map_, target.oid_, false);
+  if (lock_request_queue != nullptr) {
+    lock_request_queue->cv_.notify_all();
+    lock_request_queue->latch_.unlock();
+  }
+}
+
+auto LockManager::AreCompatible(LockMode held, LockMode requested) -> bool {
+  switch (requested) {
+    case LockMode::SHARED:
+      return held == LockMode::INTENTION_SHARED || held == LockMode::SHARED;
+    case LockMode::EXCLUSIVE:
+      return false;
+    case LockMode::INTENTION_SHARED:
+      return held != LockMode::EXCLUSIVE;
+    case LockMode::INTENTION_EXCLUSIVE:
+      return held == LockMode::INTENTION_SHARED || held == LockMode::INTENTION_EXCLUSIVE;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return held == LockMode::INTENTION_SHARED;
+  }
+  return false;
+}
+
 auto AddTxnLockSetForRow(Transaction *txn, LockManager::LockMode &lock_mode, const table_oid_t &oid, RID &rid) -> void {
   if (lock_mode == LockManager::LockMode::SHARED) {
     (*txn->GetSharedRowLockSet())[oid].insert(rid);
@@ -523,105 +734,76 @@ auto AddTxnLockSetForRow(Transaction *txn, LockManager::LockMode &lock_mode, con
 }
 
 // 用于检测当前事务想要添加的锁与已经添加的锁之间的兼容性，返回true表示是兼容的，可以继续执行，false表示不兼容，要阻塞
-auto LockManager::GrantLock(const std::shared_ptr<LockRequest> &lock_request,
-                            const std::shared_ptr<LockRequestQueue> &lock_request_queue) -> bool {
-  for (auto &lr : lock_request_queue->request_queue_) {
-    if (lr->granted_) {
-      switch (lock_request->lock_mode_) {
-        case LockMode::SHARED:
-          if (lr->lock_mode_ == LockMode::INTENTION_EXCLUSIVE ||
-              lr->lock_mode_ == LockMode::SHARED_INTENTION_EXCLUSIVE || lr->lock_mode_ == LockMode::EXCLUSIVE) {
-            return false;
-          }
-          break;
-        case LockMode::EXCLUSIVE:
-          return false;
-          break;
-        case LockMode::INTENTION_SHARED:
-          if (lr->lock_mode_ == LockMode::EXCLUSIVE) {
-            return false;
-          }
-          break;
-        case LockMode::INTENTION_EXCLUSIVE:
-          if (lr->lock_mode_ == LockMode::SHARED || lr->lock_mode_ == LockMode::SHARED_INTENTION_EXCLUSIVE ||
-              lr->lock_mode_ == LockMode::EXCLUSIVE) {
-            return false;
-          }
-          break;
-        case LockMode::SHARED_INTENTION_EXCLUSIVE:
-          if (lr->lock_mode_ != LockMode::INTENTION_SHARED) {
-            return false;
-          }
-          break;
-      }
-    } else if (lock_request.get() != lr.get()) {
+auto LockManager::GrantLock(const LockRequest &lock_request, const LockRequestQueue &lock_request_queue) -> bool {
+  for (auto &lr : lock_request_queue.request_queue_) {
+    if (!lr.granted_) {
+      // 排在前面的等待请求先加锁
+      return &lock_request == &lr;
+    }
+    if (!AreCompatible(lr.lock_mode_, lock_request.lock_mode_)) {
       return false;
-    } else {
-      return true;
     }
   }
   return false;
 }
 
 // 在事务加锁/解锁成功后调用，修改事务中相应锁的集合
-void LockManager::InsertOrDeleteTableLockSet(Transaction *txn, const std::shared_ptr<LockRequest> &lock_request,
-                                             bool insert) {
-  switch (lock_request->lock_mode_) {
+void LockManager::InsertOrDeleteTableLockSet(Transaction *txn, const LockRequest &lock_request, bool insert) {
+  switch (lock_request.lock_mode_) {
     case LockMode::SHARED:
       if (insert) {
-        txn->GetSharedTableLockSet()->insert(lock_request->oid_);
+        txn->GetSharedTableLockSet()->insert(lock_request.oid_);
       } else {
-        txn->GetSharedTableLockSet()->erase(lock_request->oid_);
+        txn->GetSharedTableLockSet()->erase(lock_request.oid_);
       }
       break;
     case LockMode::EXCLUSIVE:
       if (insert) {
-        txn->GetExclusiveTableLockSet()->insert(lock_request->oid_);
+        txn->GetExclusiveTableLockSet()->insert(lock_request.oid_);
       } else {
-        txn->GetExclusiveTableLockSet()->erase(lock_request->oid_);
+        txn->GetExclusiveTableLockSet()->erase(lock_request.oid_);
       }
       break;
     case LockMode::INTENTION_SHARED:
       if (insert) {
-        txn->GetIntentionSharedTableLockSet()->insert(lock_request->oid_);
+        txn->GetIntentionSharedTableLockSet()->insert(lock_request.oid_);
       } else {
-        txn->GetIntentionSharedTableLockSet()->erase(lock_request->oid_);
+        txn->GetIntentionSharedTableLockSet()->erase(lock_request.oid_);
       }
       break;
     case LockMode::INTENTION_EXCLUSIVE:
       if (insert) {
-        txn->GetIntentionExclusiveTableLockSet()->insert(lock_request->oid_);
+        txn->GetIntentionExclusiveTableLockSet()->insert(lock_request.oid_);
       } else {
-        txn->GetIntentionExclusiveTableLockSet()->erase(lock_request->oid_);
+        txn->GetIntentionExclusiveTableLockSet()->erase(lock_request.oid_);
       }
       break;
     case LockMode::SHARED_INTENTION_EXCLUSIVE:
       if (insert) {
-        txn->GetSharedIntentionExclusiveTableLockSet()->insert(lock_request->oid_);
+        txn->GetSharedIntentionExclusiveTableLockSet()->insert(lock_request.oid_);
       } else {
-        txn->GetSharedIntentionExclusiveTableLockSet()->erase(lock_request->oid_);
+        txn->GetSharedIntentionExclusiveTableLockSet()->erase(lock_request.oid_);
       }
       break;
   }
 }
 
-void LockManager::InsertOrDeleteRowLockSet(Transaction *txn, const std::shared_ptr<LockRequest> &lock_request,
-                                           bool insert) {
+void LockManager::InsertOrDeleteRowLockSet(Transaction *txn, const LockRequest &lock_request, bool insert) {
   auto s_row_lock_set = txn->GetSharedRowLockSet();
   auto x_row_lock_set = txn->GetExclusiveRowLockSet();
-  switch (lock_request->lock_mode_) {
+  switch (lock_request.lock_mode_) {
     case LockMode::SHARED:
       if (insert) {
-        InsertRowLockSet(s_row_lock_set, lock_request->oid_, lock_request->rid_);
+        InsertRowLockSet(s_row_lock_set, lock_request.oid_, lock_request.rid_);
       } else {
-        DeleteRowLockSet(s_row_lock_set, lock_request->oid_, lock_request->rid_);
+        DeleteRowLockSet(s_row_lock_set, lock_request.oid_, lock_request.rid_);
       }
       break;
     case LockMode::EXCLUSIVE:
       if (insert) {
-        InsertRowLockSet(x_row_lock_set, lock_request->oid_, lock_request->rid_);
+        InsertRowLockSet(x_row_lock_set, lock_request.oid_, lock_request.rid_);
       } else {
-        DeleteRowLockSet(x_row_lock_set, lock_request->oid_, lock_request->rid_);
+        DeleteRowLockSet(x_row_lock_set, lock_request.oid_, lock_request.rid_);
       }
       break;
     case LockMode::INTENTION_SHARED:
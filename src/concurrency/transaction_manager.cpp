@@ -32,6 +32,12 @@ auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level)
   if (txn == nullptr) {
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
+  {
+    std::scoped_lock lock(active_txns_latch_);
+    // The BEGIN record is logged after the transaction becomes active, its LSN is at least the next one now.
+    txn->SetBeginLSN(enable_logging ? log_manager_->GetNextLSN() : INVALID_LSN);
+    active_txns_.emplace(txn->GetTransactionId(), txn);
+  }
 
   if (enable_logging) {
     LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
@@ -44,8 +50,12 @@ auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level)
   return txn;
 }
 
-void TransactionManager::Commit(Transaction *txn) {
-  txn->SetState(TransactionState::COMMITTED);
+auto TransactionManager::Commit(Transaction *txn) -> bool {
+  // An older transaction may wound this one until the state says it committed, and waits for it to roll back.
+  if (!txn->FinishRunning(TransactionState::COMMITTED)) {
+    Abort(txn);
+    return false;
+  }
 
   // Perform all deletes before we commit.
   auto write_set = txn->GetWriteSet();
@@ -60,10 +70,23 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
+  if (enable_logging) {
+    LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&record);
+    txn->SetPrevLSN(lsn);
+    // The commit is durable once its record is on disk. Transactions committing at the same time share the flush.
+    log_manager_->Flush(lsn);
+  }
+  {
+    std::scoped_lock lock(active_txns_latch_);
+    active_txns_.erase(txn->GetTransactionId());
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
+  return true;
 }
 
 void TransactionManager::Abort(Transaction *txn) {
@@ -110,12 +133,44 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  if (enable_logging) {
+    LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&record);
+    txn->SetPrevLSN(lsn);
+  }
+  {
+    std::scoped_lock lock(active_txns_latch_);
+    active_txns_.erase(txn->GetTransactionId());
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+auto TransactionManager::GetActiveTransactionTable() -> std::vector<std::pair<txn_id_t, lsn_t>> {
+  std::scoped_lock lock(active_txns_latch_);
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  active_txns.reserve(active_txns_.size());
+  for (const auto &[txn_id, txn] : active_txns_) {
+    active_txns.emplace_back(txn_id, txn->GetPrevLSN());
+  }
+  return active_txns;
+}
+
+auto TransactionManager::GetOldestActiveLSN() -> lsn_t {
+  std::scoped_lock lock(active_txns_latch_);
+  lsn_t oldest = INVALID_LSN;
+  for (const auto &[txn_id, txn] : active_txns_) {
+    lsn_t begin_lsn = txn->GetBeginLSN();
+    if (begin_lsn != INVALID_LSN && (oldest == INVALID_LSN || begin_lsn < oldest)) {
+      oldest = begin_lsn;
+    }
+  }
+  return oldest;
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
@@ -51,7 +51,7 @@ auto DeleteExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     // }
     TupleMeta tuplemeta;
     tuplemeta.is_deleted_ = true;
-    tableinfo_->table_->UpdateTupleMeta(tuplemeta, *rid);
+    tableinfo_->table_->UpdateTupleMeta(tuplemeta, *rid, exec_ctx_->GetTransaction());
 
 
     // auto twr = TableWriteRecord{tableinfo_->oid_, *rid, tableinfo_->table_.get()};
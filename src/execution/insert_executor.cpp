@@ -51,7 +51,7 @@ auto InsertExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     // }
     TupleMeta tuplemeta;
     tuplemeta.is_deleted_ = false;
-    RID rid1 = (tableinfo_->table_->InsertTuple(tuplemeta, *tuple)).value();
+    RID rid1 = (tableinfo_->table_->InsertTuple(tuplemeta, *tuple, exec_ctx_->GetTransaction())).value();
 
 
 
@@ -38,7 +38,7 @@ auto UpdateExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     //  indexs 中插入的 tuple 和原本的 tuple 不同，需要调用 KeyFromTuple 构造
     TupleMeta tuplemeta;
     tuplemeta.is_deleted_ = true;
-    table_info_->table_->UpdateTupleMeta(tuplemeta, *rid);
+    table_info_->table_->UpdateTupleMeta(tuplemeta, *rid, exec_ctx_->GetTransaction());
     auto indexs = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
     for (auto index : indexs) {
       auto key = tuple->KeyFromTuple(table_info_->schema_, index->key_schema_, index->index_->GetKeyAttrs());
@@ -53,7 +53,7 @@ auto UpdateExecutor::Next(Tuple *tuple, RID *rid) -> bool {
 
     Tuple tuple1 = Tuple(value1, &child_executor_->GetOutputSchema());
     // // std::cout << plan_->target_expressions_ << std::endl;
-    RID mm = table_info_->table_->InsertTuple(tuplemeta, tuple1).value();
+    RID mm = table_info_->table_->InsertTuple(tuplemeta, tuple1, exec_ctx_->GetTransaction()).value();
     indexs = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
     for (auto index : indexs) {
       auto key = tuple1.KeyFromTuple(table_info_->schema_, index->key_schema_, index->index_->GetKeyAttrs());
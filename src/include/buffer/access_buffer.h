@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_buffer.h
+//
+// Identification: src/include/buffer/access_buffer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** What happened to a frame on the lock-free path of the buffer pool manager. */
+struct AccessRecord {
+  frame_id_t frame_id_;
+  /** The page the frame held at the time, to tell whether the record is still about the same page. */
+  page_id_t page_id_;
+  /** True for a page access, false if the frame was only unpinned. */
+  bool is_access_;
+  AccessType access_type_;
+};
+
+/**
+ * AccessBuffer is a lossy multi-producer ring of AccessRecords. Buffer pool hits push a record instead of updating
+ * the replacer, which has to be done under its latch, and the buffer pool manager drains the records into the
+ * replacer in batches, before it looks for a victim.
+ *
+ * Pushing never blocks: a record that is not drained before the ring wraps around is overwritten, and one pushed
+ * while a drain is running may only be seen by a later drain. Consumers must treat the records as hints.
+ */
+class AccessBuffer {
+ public:
+  /** @brief Creates an empty buffer of capacity records, rounded up to a power of two. */
+  explicit AccessBuffer(size_t capacity);
+
+  DISALLOW_COPY_AND_MOVE(AccessBuffer);
+
+  /**
+   * @brief Append a record. Lock-free, safe to call from any thread.
+   * @return true if half of the buffer or more is waiting to be drained
+   */
+  auto Push(const AccessRecord &record) -> bool;
+
+  /**
+   * @brief Hand every record pushed since the last drain to apply, oldest first. Only one thread may drain at a time.
+   * @param apply called once per record
+   */
+  void Drain(const std::function<void(const AccessRecord &)> &apply);
+
+ private:
+  static constexpr uint64_t EMPTY = ~uint64_t{0};
+
+  static auto Pack(const AccessRecord &record) -> uint64_t;
+  static auto Unpack(uint64_t entry) -> AccessRecord;
+
+  size_t capacity_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Number of records pushed so far; the next record goes to slot tail_ % capacity_. */
+  std::atomic<uint64_t> tail_{0};
+  /** Number of records drained (or skipped) so far. */
+  std::atomic<uint64_t> head_{0};
+};
+
+}  // namespace bustub
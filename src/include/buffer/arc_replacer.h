@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST '03).
+ *
+ * Resident pages are split into T1, pages seen once recently, and T2, pages seen at least twice. Both are LRU lists.
+ * The ghost lists B1 and B2 remember the ids of the pages recently evicted from T1 and T2. A miss on a page in B1
+ * means T1 was too small, so the target size p of T1 grows; a miss on a page in B2 shrinks it. Victims come from T1
+ * while it holds more than p frames, otherwise from T2.
+ *
+ * The buffer pool picks the victim before it knows which page comes in, so the tie-break of the original algorithm
+ * on a B2 hit is not applied. Scan accesses never move a page to T2 and do not adapt p.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the ARCReplacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @return the current target size of T1 */
+  auto GetTarget() -> size_t;
+
+ private:
+  enum class List { None, Recent, Frequent };
+
+  struct ARCNode {
+    List list_{List::None};
+    /** Time of the last access. */
+    size_t key_{0};
+    bool is_evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  using EvictionEntry = std::pair<size_t, frame_id_t>;
+
+  /** @return the ordered set of evictable frames of the given list */
+  auto EvictionSetOf(List list) -> std::set<EvictionEntry> & {
+    return list == List::Recent ? recent_frames_ : frequent_frames_;
+  }
+
+  /** @return true if the next victim comes from T1, given the number of frames in T1 and the candidates */
+  auto EvictFromRecent(size_t recent_size, bool has_recent, bool has_frequent) const -> bool {
+    return has_recent && (recent_size > target_ || !has_frequent);
+  }
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @brief Drop a tracked frame, remembering its page in B1 / B2 if asked to. Caller must hold the latch. */
+  void Drop(frame_id_t frame_id, bool remember);
+
+  /** @brief Bound the ghost lists: |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  std::vector<ARCNode> node_store_;
+  /** Evictable frames of T1, in LRU order. */
+  std::set<EvictionEntry> recent_frames_;
+  /** Evictable frames of T2, in LRU order. */
+  std::set<EvictionEntry> frequent_frames_;
+  /** Number of frames in T1 and T2, evictable or not. */
+  size_t recent_size_{0};
+  size_t frequent_size_{0};
+  /** B1 and B2. */
+  GhostList recent_ghosts_;
+  GhostList frequent_ghosts_;
+  /** Target size p of T1. */
+  size_t target_{0};
+  size_t current_timestamp_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,264 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool.h
+//
+// Identification: src/include/buffer/buffer_pool.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/replacer.h"
+#include "common/channel.h"
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/** Extracts the id of the page that follows a page in a chain of pages (e.g. a table heap) from the page content. */
+using NextPageIdFn = std::function<page_id_t(const char *page_data)>;
+
+/**
+ * A scan registered for read-ahead with BufferPool::RegisterReadAhead(). Pages are counted from the first page the
+ * scan entered, the read-ahead thread keeps the pages up to `pages_scanned_ + window` in the buffer pool.
+ */
+struct ReadAheadScan {
+  explicit ReadAheadScan(NextPageIdFn next_page_id) : next_page_id_(std::move(next_page_id)) {}
+
+  /** How to follow the chain of pages. */
+  NextPageIdFn next_page_id_;
+  /** Protects the fields below, which are shared by the scan and the read-ahead thread. */
+  std::mutex latch_;
+  /** Number of pages the scan has entered so far. */
+  size_t pages_scanned_{0};
+  /** Number of pages loaded so far, and the last of them. */
+  size_t pages_prefetched_{0};
+  page_id_t last_prefetched_{INVALID_PAGE_ID};
+  /** True while the scan is queued for, or being served by, the read-ahead thread. */
+  bool queued_{false};
+};
+
+/** Counters of the background flusher, see BufferPool::StartFlusher(). */
+struct FlusherStats {
+  /** Number of batches written back by the flusher. */
+  uint64_t flush_rounds_{0};
+  /** Number of pages written back by the flusher. */
+  uint64_t pages_flushed_{0};
+  /** Number of misses that had to write back a dirty victim before reusing its frame. */
+  uint64_t dirty_evictions_{0};
+};
+
+/**
+ * BufferPool is what the rest of the system fetches pages from. A BufferPoolManager implements it with its own frames,
+ * a ParallelBufferPoolManager by routing every page to the BufferPoolManager instance that owns it.
+ *
+ * Read-ahead, the hot page dumper and prewarming only go through the virtual functions, so they are implemented here
+ * once: on a ParallelBufferPoolManager, each page they load ends up in the instance that owns it. An implementation
+ * must stop them (StopReadAhead(), StopHotPageDumper(), StopPrewarm()) in its destructor, before its pages go away.
+ */
+class BufferPool {
+ public:
+  /** @param disk_manager the disk manager the pages are read from and written to */
+  explicit BufferPool(DiskManager *disk_manager) : disk_manager_(disk_manager) {}
+
+  virtual ~BufferPool() = default;
+
+  /** @brief Return the number of frames of the buffer pool. */
+  virtual auto GetPoolSize() -> size_t = 0;
+
+  /**
+   * @brief Create a new page in the buffer pool, pinned.
+   * @param[out] page_id id of created page
+   * @return nullptr if all frames are pinned, otherwise pointer to the new page
+   */
+  virtual auto NewPage(page_id_t *page_id) -> Page * = 0;
+
+  /** @brief NewPage(), returning a guard holding the pin. */
+  virtual auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard = 0;
+
+  /**
+   * @brief Fetch and pin the requested page.
+   * @param page_id id of page to be fetched
+   * @param access_type type of access to the page, scans should pass AccessType::Scan
+   * @return nullptr if the page is not in the buffer pool and all frames are pinned, otherwise pointer to the page
+   */
+  virtual auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * = 0;
+
+  /** @brief FetchPage(), returning a guard holding the pin, and the read or write latch for the last two. */
+  virtual auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard = 0;
+  virtual auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard = 0;
+  virtual auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard = 0;
+
+  /** @brief FetchPage() for reading without a latch, see OptimisticPageGuard. */
+  virtual auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown)
+      -> OptimisticPageGuard = 0;
+
+  /**
+   * @brief Unpin a page, and mark it dirty if is_dirty.
+   * @return false if the page is not in the buffer pool or not pinned
+   */
+  virtual auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool = 0;
+
+  /**
+   * @brief Write a page back to disk if it is dirty.
+   * @return false if the page is not in the buffer pool
+   */
+  virtual auto FlushPage(page_id_t page_id) -> bool = 0;
+
+  /** @brief Write all dirty pages back to disk. */
+  virtual void FlushAllPages() = 0;
+
+  /**
+   * @brief Delete a page from the buffer pool and release its space on disk.
+   * @return false if the page is pinned, true otherwise
+   */
+  virtual auto DeletePage(page_id_t page_id) -> bool = 0;
+
+  /**
+   * @brief Start the background flusher, which keeps clean_fraction of the frames free or clean and evictable.
+   * @param clean_fraction fraction of the frames to keep free or clean and evictable
+   * @param interval how often the flusher checks the pool when it is not woken up by a dirty eviction
+   */
+  virtual void StartFlusher(double clean_fraction = FLUSHER_CLEAN_FRACTION,
+                            std::chrono::milliseconds interval = std::chrono::milliseconds(10)) = 0;
+
+  /** @brief Stop the background flusher, if running. */
+  virtual void StopFlusher() = 0;
+
+  /** @return the counters of the background flusher */
+  virtual auto GetFlusherStats() -> FlusherStats = 0;
+
+  /** @brief Write back the pages whose recLSN is below rec_lsn, so that redo after a crash can start from there. */
+  virtual void FlushPagesBefore(lsn_t rec_lsn) = 0;
+
+  /** @return every page with a logged change that is not on disk yet, with its recLSN */
+  virtual auto GetDirtyPageTable() -> std::vector<std::pair<page_id_t, lsn_t>> = 0;
+
+  /** @return hits, misses, evictions, write-backs, waits and I/O latencies since creation or the last ResetStats() */
+  virtual auto GetStats() -> BufferPoolStats = 0;
+
+  /** @brief Set the counters returned by GetStats() back to zero. */
+  virtual void ResetStats() = 0;
+
+  /** @return the ids of up to max_pages pages in the buffer pool, hottest first */
+  virtual auto GetHotPages(size_t max_pages) -> std::vector<page_id_t> = 0;
+
+  /**
+   * @brief Load a page into a free frame for prewarming, and leave it unpinned.
+   * @return false if the page is already in the buffer pool or there is no free frame
+   */
+  virtual auto PrewarmPage(page_id_t page_id) -> bool = 0;
+
+  /**
+   * @brief Register a sequential scan over a chain of pages for read-ahead. The scan reports every page it enters with
+   * ReadAhead(), and a background thread loads the next pages of the chain before the scan gets to them.
+   * @param next_page_id how to find the page following a page of the chain
+   * @return the handle identifying the scan
+   */
+  auto RegisterReadAhead(NextPageIdFn next_page_id) -> std::shared_ptr<ReadAheadScan>;
+
+  /**
+   * @brief Report that a scan entered page_id. If fewer than half of the read-ahead window are left ahead of the scan,
+   * the read-ahead thread is asked to refill the window, starting from page_id if the scan overtook it. Does not block
+   * on I/O.
+   * @param scan the handle returned by RegisterReadAhead()
+   * @param page_id the page the scan is now on
+   */
+  void ReadAhead(const std::shared_ptr<ReadAheadScan> &scan, page_id_t page_id);
+
+  /** @brief Set the number of pages prefetched ahead of a scan, 0 disables read-ahead. */
+  void SetReadAheadWindow(size_t window) { read_ahead_window_ = window; }
+
+  /** @return the number of pages prefetched ahead of a scan, capped at a quarter of the buffer pool */
+  auto GetReadAheadWindow() -> size_t { return std::min<size_t>(read_ahead_window_, GetPoolSize() / 4); }
+
+  /**
+   * @brief Write the ids of the pages in the buffer pool, hottest first, to a hot page list (see HotPageList).
+   * @return false if the file could not be written
+   */
+  auto DumpHotPages(const std::string &file_name) -> bool;
+
+  /**
+   * @brief Start a background thread dumping the hot pages every interval, so that the list is recent even if the
+   * process does not get to dump it when it stops.
+   * @param file_name the hot page list to write
+   * @param interval how often to write it
+   */
+  void StartHotPageDumper(const std::string &file_name, std::chrono::milliseconds interval);
+
+  /** @brief Stop the hot page dumper, if running. */
+  void StopHotPageDumper();
+
+  /**
+   * @brief Start loading the pages of a hot page list in the background, so that the buffer pool is warm when traffic
+   * comes in. The hottest pages of the list that are still allocated, at most budget and the pool size, are loaded in
+   * page id order to keep the reads sequential. They only go to free frames, so pages fetched in the meantime are never
+   * evicted for them, and are recorded as scan accesses, so they are the first to go until traffic asks for them.
+   * @param file_name the hot page list to read
+   * @param budget the maximum number of pages to load
+   * @return the number of pages to load
+   */
+  auto StartPrewarm(const std::string &file_name, size_t budget) -> size_t;
+
+  /** @return the number of pages loaded by the prewarm started last, once it is done; 0 if none was started */
+  auto WaitForPrewarm() -> size_t;
+
+ protected:
+  /** @brief Stop the read-ahead thread. Must run before the pages it may fetch are destroyed. */
+  void StopReadAhead();
+
+  /** @brief Make the prewarm give up and wait for it. Must run before the pages it may fetch are destroyed. */
+  void StopPrewarm();
+
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_;
+
+ private:
+  /** @brief Load pages ahead of the queued scans until their windows are full. Runs on read_ahead_thread_. */
+  void ReadAheadWorker();
+
+  /** @brief Dump the hot pages to file_name every interval until stopped. Runs on hot_page_thread_. */
+  void HotPageDumperWorker(const std::string &file_name, std::chrono::milliseconds interval);
+
+  /** Background thread dumping the hot page list, see StartHotPageDumper(). */
+  std::thread hot_page_thread_;
+  /** Protects hot_page_stop_; hot_page_cv_ is signalled on it to stop the dumper. */
+  std::mutex hot_page_latch_;
+  std::condition_variable hot_page_cv_;
+  bool hot_page_stop_{false};
+  /** Number of pages loaded by the prewarm started by StartPrewarm(). */
+  std::future<size_t> prewarm_;
+  /** Set to make the prewarm give up on the pages it has not loaded yet. */
+  std::atomic<bool> prewarm_stop_{false};
+
+  /** Number of pages prefetched ahead of a scan. */
+  std::atomic<size_t> read_ahead_window_{READ_AHEAD_WINDOW};
+  /** Scans waiting for the read-ahead thread, `std::nullopt` stops the thread. */
+  Channel<std::optional<std::shared_ptr<ReadAheadScan>>> read_ahead_queue_;
+  /** Background thread loading pages ahead of scans, started by the first scan that needs it. */
+  std::thread read_ahead_thread_;
+  std::once_flag read_ahead_started_;
+};
+
+}  // namespace bustub
@@ -12,15 +12,33 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include "buffer/lru_k_replacer.h"
+#include "buffer/access_buffer.h"
+#include "buffer/buffer_pool.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
+#include "common/channel.h"
 #include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
@@ -28,8 +46,16 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Fetching a page that is already in the buffer pool, and unpinning it, does not take the buffer pool latch: the page
+ * table can be read without locking, pin counts are atomic, and the access is queued in an AccessBuffer for the
+ * replacer instead of being recorded right away. A frame is only given to another page once its pin count has been
+ * swapped from 0 to -1 under the latch, so a hit that pins the frame first keeps it, and a hit that finds the frame
+ * taken (or holding another page, after a stale lookup) backs off to the locked path. Because hits do not tell the
+ * replacer when they pin a frame, a frame the replacer considers evictable may be pinned; eviction checks the pin
+ * count again before using the frame.
  */
-class BufferPoolManager {
+class BufferPoolManager : public BufferPool {
  public:
   /**
    * @brief Creates a new BufferPoolManager.
@@ -37,17 +63,39 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
+   * @param num_io_workers the number of threads of the disk scheduler, misses on different pages overlap up to it
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRUK,
+                    size_t num_io_workers = DISK_SCHEDULER_WORKERS);
+
+  /**
+   * @brief Creates a new BufferPoolManager that is one of several instances sharing a disk manager.
+   *
+   * An instance only allocates the page ids p with p % num_instances == instance_index, so the owner of any page can
+   * be found from its id alone (see ParallelBufferPoolManager).
+   *
+   * @param pool_size the size of the buffer pool
+   * @param num_instances the total number of instances sharing the page id space
+   * @param instance_index the index of this instance, in [0, num_instances)
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
+   * @param num_io_workers the number of threads of the disk scheduler
+   */
+  BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index, DiskManager *disk_manager,
+                    size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                    ReplacerType replacer_type = ReplacerType::LRUK, size_t num_io_workers = DISK_SCHEDULER_WORKERS);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  ~BufferPoolManager() override;
 
   /** @brief Return the size (number of frames) of the buffer pool. */
-  auto GetPoolSize() -> size_t { return pool_size_; }
+  auto GetPoolSize() -> size_t override { return pool_size_; }
 
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
@@ -75,7 +123,7 @@ class BufferPoolManager {
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  auto NewPage(page_id_t *page_id) -> Page * override;
 
   /**
    * TODO(P1): Add implementation
@@ -90,7 +138,7 @@ class BufferPoolManager {
    * @param[out] page_id, the id of the new page
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard override;
 
   /**
    * TODO(P1): Add implementation
@@ -113,7 +161,7 @@ class BufferPoolManager {
    * @param access_type type of access to the page, only needed for leaderboard tests.
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
-  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * override;
 
   /**
    * TODO(P1): Add implementation
@@ -127,11 +175,22 @@ class BufferPoolManager {
    *功能应该与FetchPage相同，只是根据调用的函数，返回一个保护。如果调用
    *FetchPageRead或FetchPageWrite，则返回的页面应该已经分别持有读或写锁存器。
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page, scans should pass AccessType::Scan
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard override;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard override;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard override;
+
+  /**
+   * @brief Fetch a page for reading without latching it. The returned guard pins the page and records its version,
+   * see OptimisticPageGuard for how to read through it.
+   * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page
+   * @return OptimisticPageGuard holding the fetched page
+   */
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown)
+      -> OptimisticPageGuard override;
 
   /**
    * TODO(P1): Add implementation
@@ -148,7 +207,7 @@ class BufferPoolManager {
    * @param access_type type of access to the page, only needed for leaderboard tests.
    * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
    */
-  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -162,59 +221,140 @@ class BufferPoolManager {
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  auto FlushPage(page_id_t page_id) -> bool;
+  auto FlushPage(page_id_t page_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
    *
    * @brief Flush all the pages in the buffer pool to disk.
    */
-  void FlushAllPages();
+  void FlushAllPages() override;
 
   /**
    * TODO(P1): Add implementation
    *从缓冲池中删除页面。如果page_id不在缓冲池中，则不执行任何操作并返回true。
    *如果页面已固定且无法删除，请立即返回false。
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * @brief Delete a page from the buffer pool and release its space on disk. If page_id is not in the buffer pool, only
+   * its space on disk is released. If the page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * back to the free list. Also, reset the page's memory and metadata. Finally, call DeallocatePage() to hand the
+   * page id back to the disk manager's free page map, so that a later NewPage() can reuse it.
    *从页面表中删除页面后，停止跟踪替换器中的帧，并将该帧添加回空闲列表。此外，重置页面的内存
    *和元数据。
    *最后，您应该调用DeallocatePage（）来模拟释放磁盘上的页面。
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  auto DeletePage(page_id_t page_id) -> bool;
-  void PrintPage();
+  auto DeletePage(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Start the background flusher. It keeps at least clean_fraction of the frames free or clean and evictable
+   * by writing back the coldest dirty unpinned frames, in page id order, so that misses rarely have to write back a
+   * dirty victim themselves. Pages written back stay in the buffer pool.
+   * @param clean_fraction fraction of the frames to keep free or clean and evictable
+   * @param interval how often the flusher checks the pool when it is not woken up by a dirty eviction
+   */
+  void StartFlusher(double clean_fraction = FLUSHER_CLEAN_FRACTION,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(10)) override;
+
+  /** @brief Stop the background flusher, if running. */
+  void StopFlusher() override;
+
+  /** @return the counters of the background flusher */
+  auto GetFlusherStats() -> FlusherStats override;
+
+  /**
+   * @brief Write back the pages whose recLSN is below rec_lsn, so that redo after a crash can start from there. The
+   * flusher does it in the background if it runs, otherwise the caller does.
+   * @param rec_lsn pages with a logged change older than this are written back
+   */
+  void FlushPagesBefore(lsn_t rec_lsn) override;
+
+  /**
+   * @return the dirty page table: every page with a logged change that is not on disk yet, with its recLSN, the LSN
+   * of the first such change. A page may appear twice, the smaller recLSN counts.
+   */
+  auto GetDirtyPageTable() -> std::vector<std::pair<page_id_t, lsn_t>> override;
+
+  /** @return hits, misses, evictions, write-backs, waits and I/O latencies since creation or the last ResetStats() */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** @brief Set the counters returned by GetStats() back to zero. */
+  void ResetStats() override;
+
+  /**
+   * @brief List the pages in the buffer pool, hottest first: the pinned pages, then the unpinned ones in the reverse of
+   * the order the replacer would evict them.
+   * @param max_pages the maximum number of pages to list
+   * @return the ids of up to max_pages pages
+   */
+  auto GetHotPages(size_t max_pages) -> std::vector<page_id_t> override;
+
+  /**
+   * @brief Load a page into a free frame for prewarming, and leave it unpinned.
+   * @return false if the page is already in the buffer pool or there is no free frame
+   */
+  auto PrewarmPage(page_id_t page_id) -> bool override;
 
  public:
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
+  /** Number of instances sharing the page id space, 1 for a standalone buffer pool. */
+  const uint32_t num_instances_ = 1;
+  /** Index of this instance, the residue (mod num_instances_) of every page id it allocates. */
+  const uint32_t instance_index_ = 0;
 
+  /** Memory of all the frames, see FrameArena. The pages point into it. */
+  std::unique_ptr<FrameArena> frame_arena_;
   /** Array of buffer pool pages. */
   Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages.
+  /** Pointer to the disk scheduler, all page reads and writes go through it. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
+  /** Pointer to the log manager. Dirty pages are only written back once the log is on disk up to their LSN. */
+  LogManager *log_manager_;
+  /** Page table for keeping track of buffer pool pages. Written under latch_, read without it on hits.
    * 用于跟踪缓冲池页面的页面表
    */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  PageTable page_table_;
+  /** Accesses and unpins done without latch_, waiting to be applied to the replacer. */
+  AccessBuffer access_buffer_{ACCESS_BUFFER_SIZE};
   /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
+  std::unique_ptr<Replacer> replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects the writes to the page table, the free list and the book-keeping fields of every frame, except
+   * for the pin counts and dirty flags changed by hits. It is never held during disk I/O on a miss: the frame is marked
+   * as under I/O instead, see ReplaceFrame().
+   */
   std::mutex latch_;
+  /** Per-frame condition signalled when the I/O in progress on that frame completes. Indexed by frame id. */
+  std::vector<std::condition_variable> io_cv_;
+
+  /** Background thread writing back cold dirty frames, see StartFlusher(). */
+  std::thread flusher_thread_;
+  /** Signalled to wake up the flusher early, on a dirty eviction or to stop it. Waits on latch_. */
+  std::condition_variable flusher_cv_;
+  /** Set under latch_ to stop the flusher. */
+  bool flusher_stop_{false};
+  double flusher_clean_fraction_{FLUSHER_CLEAN_FRACTION};
+  std::chrono::milliseconds flusher_interval_{10};
+  /** Aligned scratch pages the flusher copies frames into before writing them, so frames are not pinned during I/O. */
+  std::unique_ptr<Page[]> flusher_buffers_;
+  /** Set under latch_ by FlushPagesBefore(): the flusher first writes back the pages with a recLSN below it. */
+  lsn_t flush_before_lsn_{INVALID_LSN};
+  /** Pages being written back whose frame no longer shows their recLSN, with that recLSN. Protected by latch_. */
+  std::unordered_map<page_id_t, lsn_t> writes_in_flight_;
+  std::atomic<uint64_t> flush_rounds_{0};
+  std::atomic<uint64_t> pages_flushed_{0};
+  std::atomic<uint64_t> dirty_evictions_{0};
+  /** Counters behind GetStats(). */
+  BufferPoolCounters stats_;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk, reusing a deallocated page of this instance if there is one. Caller should acquire
+   * the latch before calling this function.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
@@ -223,10 +363,125 @@ class BufferPoolManager {
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * @brief Find the frame holding page_id, waiting for any I/O in progress on it first. Caller must hold the latch,
+   * which may be released while waiting.
+   * @param page_id id of the page to look up
+   * @param lock the caller's lock on latch_
+   * @param[out] frame_id the frame holding the page
+   * @return false if the page is not in the buffer pool
+   */
+  auto FindFrame(page_id_t page_id, std::unique_lock<std::mutex> &lock, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Take a frame from the free list, or evict one from the replacer if the free list is empty. The frame is
+   * claimed (its pin count is -1) until ReplaceFrame() assigns it. Caller must hold the latch.
+   * @param[out] frame_id the frame to reuse
+   * @return false if all frames are pinned
+   */
+  auto GetVictimFrame(frame_id_t *frame_id) -> bool;
 
-  // TODO(student): You may add additional private members and helper functions
+  /** @brief Swap the pin count of an unpinned frame to -1, so that no hit can pin it anymore. */
+  auto ClaimFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Pin the frame holding page_id without taking the latch. Fails if the lookup misses, or the page is not
+   * readable yet (under I/O), in which case the caller should retry under the latch.
+   * @param page_id id of the page to pin
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page is pinned
+   */
+  auto PinResident(page_id_t page_id, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Drop one pin of a frame without taking the latch, and let the replacer know if it became unpinned.
+   * @return false if the frame was not pinned
+   */
+  auto UnpinResident(frame_id_t frame_id) -> bool;
+
+  /** @brief Queue an access or unpin for the replacer, and drain the queue if it fills up and the latch is free. */
+  void RecordLater(const AccessRecord &record);
+
+  /** @brief Apply the queued accesses and unpins to the replacer. Caller must hold the latch. */
+  void DrainAccessBuffer();
+
+  /**
+   * @brief Make the replacer's evictable flags match the pin counts of all frames, in case an unpin fell off the
+   * access buffer. Caller must hold the latch.
+   */
+  void SyncEvictable();
+
+  /**
+   * @brief Assign a frame obtained from GetVictimFrame() to page_id. The frame is pinned once, mapped in the page
+   * table and marked as under I/O, and its previous page is written back if dirty. The latch is released during that
+   * write, but the frame content is left untouched. A frame showing a view of the mapped database file gets its own
+   * memory back. Caller must hold the latch and call FinishIo() once the frame holds the new page.
+   */
+  void ReplaceFrame(std::unique_lock<std::mutex> &lock, frame_id_t frame_id, page_id_t page_id,
+                    AccessType access_type = AccessType::Unknown);
+
+  /**
+   * @brief Fill a frame assigned by ReplaceFrame() with the content of page_id, from a view of the mapped database file
+   * if the disk manager has one, or else by reading the page. Caller must not hold the latch.
+   */
+  void ReadIntoFrame(Page *page, page_id_t page_id);
+
+  /** @brief Lock latch_, counting a pin wait if another thread holds it. */
+  auto LockLatch() -> std::unique_lock<std::mutex>;
+
+  /**
+   * @brief Write back dirty frames as one batch, after flushing the log up to their page LSNs. The frames are pinned
+   * meanwhile and the latch is released during the I/O. Caller must hold the latch, it is held again on return.
+   * @param lock the caller's lock on latch_
+   * @param frames the frames to write back, none of them under I/O
+   */
+  void WriteBack(std::unique_lock<std::mutex> &lock, const std::vector<frame_id_t> &frames);
+
+  /**
+   * @brief Point a frame that shows a view of the mapped database file (see DiskManager::GetPageView()) back at its own
+   * memory, and drop the private copy the view holds if the page was ever modified through it. The frame must not be in
+   * use, and any change made through the view must be written back already.
+   * @param frame_id the frame
+   * @param page_id the page the view shows
+   */
+  void DetachView(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Schedule a read or write of one page on the disk scheduler.
+   * @return the future signalled when the request has been executed
+   */
+  auto ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool>;
+
+  /**
+   * @brief Wait for a read or write scheduled at start, and record its latency.
+   * @return whether the request succeeded
+   */
+  auto AwaitIo(bool is_write, std::future<bool> &future, BufferPoolCounters::Clock::time_point start) -> bool;
+
+  /** @brief Schedule a read or write of one page, wait for it and record its latency. */
+  auto DoIo(bool is_write, page_id_t page_id, char *data) -> bool;
+
+  /**
+   * @brief Write-ahead rule: before pages are written back, wait until the log is on disk up to the largest of their
+   * page LSNs. Does nothing unless logging. Pages that keep no LSN only cost a needless log flush.
+   */
+  void FlushLog(lsn_t page_lsn);
+
+  /** @brief Clear the I/O flag of a frame and wake up the threads waiting on it. Caller must hold the latch. */
+  void FinishIo(frame_id_t frame_id);
+
+  /** @brief Write back cold dirty frames whenever the pool runs short of clean ones. Runs on flusher_thread_. */
+  void FlusherWorker();
+
+  /** @return up to a batch of frames with a recLSN below rec_lsn, in page id order. Caller must hold the latch. */
+  auto PickFramesBefore(lsn_t rec_lsn) -> std::vector<frame_id_t>;
+
+  /**
+   * @brief Pick the coldest dirty evictable frames to write back, enough to reach the clean fraction but at most
+   * FLUSHER_BATCH_SIZE, sorted by page id. Caller must hold the latch.
+   */
+  auto PickFramesToFlush() -> std::vector<frame_id_t>;
 };
 }  // namespace bustub
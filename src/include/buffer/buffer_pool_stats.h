@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Distribution of latencies in power-of-two microsecond buckets: bucket 0 counts latencies below 1 us, bucket i > 0
+ * latencies in [2^(i-1), 2^i) us, and the last bucket everything longer.
+ */
+struct LatencyHistogram {
+  static constexpr size_t NUM_BUCKETS = 24;
+
+  /** @return the bucket counting a latency of us microseconds */
+  static auto BucketOf(uint64_t us) -> size_t;
+
+  /** @brief Count one latency of us microseconds. */
+  void Add(uint64_t us);
+
+  /** @brief Add the latencies counted by other to this histogram. */
+  void Merge(const LatencyHistogram &other);
+
+  /** @return the mean latency in microseconds, 0 if nothing was counted */
+  auto Mean() const -> double;
+
+  /** @return an upper bound of the p-th quantile (p in [0, 1]) in microseconds, 0 if nothing was counted */
+  auto Percentile(double p) const -> uint64_t;
+
+  /** @return count, mean and a few percentiles, e.g. `count=10 mean=3.5 p50=4 p99=8` */
+  auto ToString() const -> std::string;
+
+  uint64_t count_{0};
+  uint64_t total_us_{0};
+  std::array<uint64_t, NUM_BUCKETS> buckets_{};
+};
+
+/** Counters of a buffer pool since it was created or last reset, see BufferPoolManager::GetStats(). */
+struct BufferPoolStats {
+  /** Number of fetches of a page that was in the buffer pool. */
+  uint64_t hits_{0};
+  /** Number of fetches that read the page from disk. */
+  uint64_t misses_{0};
+  /** Number of frames taken from the replacer to hold another page. */
+  uint64_t evictions_{0};
+  /** Number of dirty pages written back, by evictions, flushes and the background flusher. */
+  uint64_t dirty_flushes_{0};
+  /** Number of times a fetch or a new page waited for the buffer pool latch, or any request for another's I/O. */
+  uint64_t pin_waits_{0};
+  /** How long those waits took. */
+  LatencyHistogram pin_wait_latency_;
+  /** Time from issuing a page read or write to seeing it complete. */
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+
+  /** @return the fraction of fetches that were hits, 0 if there was no fetch */
+  auto HitRatio() const -> double;
+
+  /** @brief Add the counters of other, e.g. another instance of a parallel buffer pool, to these. */
+  void Merge(const BufferPoolStats &other);
+
+  /** @return the counters, one group per line */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * BufferPoolCounters collects BufferPoolStats on the hot paths of a buffer pool. The counters are split into shards on
+ * separate cache lines and every thread updates the shard it was assigned with relaxed increments, so threads do not
+ * bounce cache lines between each other. A snapshot sums up the shards; it is not atomic with respect to concurrent
+ * updates, which is fine for monitoring.
+ */
+class BufferPoolCounters {
+ public:
+  enum class Counter { Hit = 0, Miss, Eviction, DirtyFlush, PinWait };
+  enum class Latency { PinWait = 0, Read, Write };
+
+  using Clock = std::chrono::steady_clock;
+
+  BufferPoolCounters() = default;
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolCounters);
+
+  /** @brief Add n to a counter. */
+  void Increment(Counter counter, uint64_t n = 1) {
+    MyShard().counters_[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /** @brief Count a latency, from start until now. */
+  void RecordLatency(Latency latency, Clock::time_point start);
+
+  /** @return the sum of all shards */
+  auto Snapshot() const -> BufferPoolStats;
+
+  /** @brief Set all counters back to zero. */
+  void Reset();
+
+ private:
+  static constexpr size_t NUM_SHARDS = 16;
+  static constexpr size_t NUM_COUNTERS = 5;
+  static constexpr size_t NUM_LATENCIES = 3;
+  /** A histogram is stored as its count, its total and its buckets. */
+  static constexpr size_t HISTOGRAM_SIZE = LatencyHistogram::NUM_BUCKETS + 2;
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters_{};
+    std::array<std::array<std::atomic<uint64_t>, HISTOGRAM_SIZE>, NUM_LATENCIES> latencies_{};
+  };
+
+  /** @return the shard of the calling thread */
+  auto MyShard() -> Shard &;
+
+  std::array<Shard, NUM_SHARDS> shards_{};
+};
+
+}  // namespace bustub
@@ -12,41 +12,66 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The frames form a circle swept by a clock hand. Every access sets the reference bit of a frame. When looking for a
+ * victim, the hand clears the reference bits it passes and stops at the first evictable frame whose bit was already
+ * clear. Scan accesses do not set the reference bit, so a page only touched by a scan is evicted on the first sweep.
  */
 class ClockReplacer : public Replacer {
  public:
   /**
    * Create a new ClockReplacer.
-   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   * @param num_frames the maximum number of frames the ClockReplacer will be required to store
    */
-  explicit ClockReplacer(size_t num_pages);
+  explicit ClockReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
 
   /**
    * Destroys the ClockReplacer.
    */
-  ~ClockReplacer() override;
+  ~ClockReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
+  struct ClockFrame {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    bool reference_{false};
+  };
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  std::vector<ClockFrame> frames_;
+  /** The frame the clock hand points at. */
+  size_t hand_{0};
+  /** Number of evictable frames. */
+  size_t size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the memory of all the frames of a buffer pool in one contiguous, page-aligned mapping, instead of
+ * one heap allocation per frame. The mapping can be backed by huge pages, to cut TLB misses on a large pool, and be
+ * placed on given NUMA nodes. Huge pages and NUMA placement are best effort: if the system does not provide them, the
+ * arena falls back to normal pages and default placement with a warning.
+ *
+ * The memory comes zeroed from the kernel and is only faulted in when a frame is first used.
+ */
+class FrameArena {
+ public:
+  /** Size of a huge page on the platforms we care about. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * @brief Map the memory for num_frames frames.
+   * @param num_frames the number of frames
+   * @param huge_pages whether and how to use huge pages
+   * @param numa_node the NUMA node to bind the memory to, NUMA_INTERLEAVE or NUMA_DEFAULT
+   */
+  explicit FrameArena(size_t num_frames, HugePageMode huge_pages = frame_huge_pages, int numa_node = frame_numa_node);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the memory of frame frame_id, BUSTUB_PAGE_SIZE bytes aligned to BUSTUB_PAGE_SIZE */
+  auto GetFrame(size_t frame_id) -> char * { return data_ + frame_id * BUSTUB_PAGE_SIZE; }
+
+  /** @return how the arena ended up being backed, which may be less than what was asked for */
+  auto GetHugePageMode() const -> HugePageMode { return huge_pages_; }
+
+  /** @return the size of the mapping in bytes */
+  auto GetSize() const -> size_t { return size_; }
+
+ private:
+  /** @brief Bind the mapping to numa_node, or interleave it over all nodes. */
+  void PlaceOnNuma(int numa_node);
+
+  /** The whole mapping, which may start up to one page before data_ to align the frames. */
+  char *map_{nullptr};
+  size_t map_size_{0};
+  /** The first frame. */
+  char *data_{nullptr};
+  size_t size_{0};
+  HugePageMode huge_pages_{HugePageMode::None};
+};
+
+}  // namespace bustub
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of recently evicted pages, oldest first, so that a replacer can tell when a page comes
+ * back soon after its eviction. It holds no page data. Not thread-safe, the owning replacer serializes access.
+ */
+class GhostList {
+ public:
+  /** @brief Remember page_id as the most recent entry, replacing an older entry of the same page. */
+  void PushBack(page_id_t page_id) {
+    Erase(page_id);
+    index_[page_id] = pages_.insert(pages_.end(), page_id);
+  }
+
+  /** @brief Forget the oldest entry, if any. */
+  void PopFront() {
+    if (!pages_.empty()) {
+      index_.erase(pages_.front());
+      pages_.pop_front();
+    }
+  }
+
+  /** @brief Forget page_id. @return true if it was remembered */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) > 0; }
+
+  auto Size() const -> size_t { return pages_.size(); }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hot_page_list.h
+//
+// Identification: src/include/buffer/hot_page_list.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * HotPageList stores the ids of the pages a buffer pool held, hottest first, so that the next buffer pool over the same
+ * database can load them before traffic asks for them (see BufferPoolManager::StartPrewarm()).
+ *
+ * The file is a header (magic number and number of pages) followed by the page ids. It is replaced atomically: the
+ * list is written to a temporary file which is then renamed over the old one, so a crash while dumping leaves the
+ * previous list in place.
+ */
+class HotPageList {
+ public:
+  /**
+   * @brief Write a list of page ids to a file, replacing it.
+   * @param file_name the file to write
+   * @param page_ids the pages, hottest first
+   * @return false if the file could not be written
+   */
+  static auto Write(const std::string &file_name, const std::vector<page_id_t> &page_ids) -> bool;
+
+  /**
+   * @brief Read a list of page ids written by Write().
+   * @param file_name the file to read
+   * @return the pages, hottest first; empty if the file does not exist or is not a hot page list
+   */
+  static auto Read(const std::string &file_name) -> std::vector<page_id_t>;
+
+ private:
+  static constexpr uint32_t MAGIC = 0x48505431;  // "HPT1"
+  /** Largest list accepted by Read(), so a damaged header cannot make us allocate gigabytes. */
+  static constexpr uint32_t MAX_PAGES = 1U << 26;
+};
+
+}  // namespace bustub
@@ -12,28 +12,64 @@
 
 #pragma once
 
-#include <algorithm>
-#include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <utility>
 #include <vector>
+
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
+/**
+ * LRUKNode keeps the access history of a single frame in a fixed-size ring buffer, so that recording an access
+ * never allocates and the history of a hot frame does not grow without bound.
+ */
 class LRUKNode {
  public:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
+  LRUKNode() = default;
+  explicit LRUKNode(size_t k) : history_(k) {}
+
+  /** Record an access at the given timestamp, overwriting the oldest entry once K accesses have been seen. */
+  void Access(size_t timestamp) {
+    history_[cursor_] = timestamp;
+    cursor_ = (cursor_ + 1) % history_.size();
+    if (count_ < history_.size()) {
+      count_++;
+    }
+  }
+
+  /**
+   * @return the key used to rank this frame for eviction: the timestamp of the K-th most recent access if the frame
+   * has K accesses, otherwise the timestamp of its earliest access.
+   */
+  auto EvictionKey() const -> size_t { return HasKHistory() ? history_[cursor_] : history_[0]; }
+
+  /** @return true if the frame has been accessed at least K times */
+  auto HasKHistory() const -> bool { return count_ == history_.size(); }
+
+  /** @return true if the frame has any access history */
+  auto IsTracked() const -> bool { return count_ != 0; }
+
+  /** Drop the access history and evictable flag of the frame. */
+  void Reset() {
+    cursor_ = 0;
+    count_ = 0;
+    is_evictable_ = false;
+    is_scan_only_ = false;
+  }
+
+  /** Ring buffer of the last K access timestamps. Until it is full, slot 0 holds the earliest access. */
   std::vector<size_t> history_;
-  // std::list<size_t> history_;
-  size_t k_;
-  frame_id_t fid_;
+  /** Slot the next access is written to. Once the buffer is full this is also the K-th most recent access. */
+  size_t cursor_{0};
+  /** Number of recorded accesses, saturating at K. */
+  size_t count_{0};
   bool is_evictable_{false};
+  /** True while the frame has only been brought in and touched by scans, i.e. it is on probation. */
+  bool is_scan_only_{false};
 };
 
 /**
@@ -46,8 +82,12 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multipe frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * To keep a large sequential scan from flushing the working set, accesses tagged AccessType::Scan do not count toward
+ * the K history. A frame loaded by a scan stays on probation, and probationary frames are evicted before all others in
+ * FIFO order. The first non-scan access admits the frame to the regular LRU-K ordering.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -65,7 +105,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -83,8 +123,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id)
-      -> bool;  // 驱逐出当前距离最大的祯   如果出现次数小于k则距离为inf 当前距离为当前时间-倒数第k次出现的时间
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -98,8 +137,10 @@ class LRUKReplacer {
    * @param frame_id id of frame that received a new access.
    * @param access_type type of access that was received. This parameter is only needed for
    * leaderboard tests.
+   * @param page_id unused, LRU-K keeps no history of evicted pages
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);  // 插入
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
   /**
    * TODO(P1): Add implementation
@@ -118,7 +159,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -137,7 +178,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -146,21 +187,33 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
- public:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  // std::list<LRUKNode> nowKnode;//保存当前k个
-  std::unordered_map<frame_id_t, int> now_knode_map_;
-  std::vector<frame_id_t> now_knode_;
-  std::unordered_map<frame_id_t, LRUKNode> node_store_;  // 保存  包含false ev的
-  size_t current_timestamp_{0};                          // 保存当前时间  每次加一
-  // size_t curr_size_{0};
-  size_t replacer_size_;  // node_stores_的最大值
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+ private:
+  using EvictionEntry = std::pair<size_t, frame_id_t>;
+
+  /** @return the ordered set an evictable frame with the given history belongs to */
+  auto EvictionSetOf(const LRUKNode &node) -> std::set<EvictionEntry> & {
+    if (node.is_scan_only_) {
+      return scan_frames_;
+    }
+    return node.HasKHistory() ? k_dist_frames_ : inf_dist_frames_;
+  }
+
+  /** Per-frame access history, indexed by frame id. */
+  std::vector<LRUKNode> node_store_;
+  /** Evictable frames only accessed by scans, ordered by the access that loaded them. Evicted first. */
+  std::set<EvictionEntry> scan_frames_;
+  /** Evictable frames with fewer than K accesses (+inf backward k-distance), ordered by earliest access. */
+  std::set<EvictionEntry> inf_dist_frames_;
+  /** Evictable frames with K accesses, ordered by their K-th most recent access. */
+  std::set<EvictionEntry> k_dist_frames_;
+  size_t current_timestamp_{0};
+  size_t replacer_size_;
   size_t k_;
   std::mutex latch_;
-  frame_id_t move_id_;
 };
 
 }  // namespace bustub
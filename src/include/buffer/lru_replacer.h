@@ -12,41 +12,60 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
- * LRUReplacer implements the Least Recently Used replacement policy.
+ * LRUReplacer implements the Least Recently Used replacement policy: the evictable frame whose last access is the
+ * oldest is evicted. Access types are ignored.
  */
 class LRUReplacer : public Replacer {
  public:
   /**
    * Create a new LRUReplacer.
-   * @param num_pages the maximum number of pages the LRUReplacer will be required to store
+   * @param num_frames the maximum number of frames the LRUReplacer will be required to store
    */
-  explicit LRUReplacer(size_t num_pages);
+  explicit LRUReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(LRUReplacer);
 
   /**
    * Destroys the LRUReplacer.
    */
-  ~LRUReplacer() override;
+  ~LRUReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** Timestamp of the last access of each frame, 0 if the frame is not tracked. */
+  std::vector<size_t> last_access_;
+  std::vector<bool> is_evictable_;
+  /** Evictable frames ordered by their last access. */
+  std::set<std::pair<size_t, frame_id_t>> evictable_frames_;
+  size_t current_timestamp_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
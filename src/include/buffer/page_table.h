@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to the frames holding them. It is a fixed-size open-addressing
+ * hash table with linear probing, whose slots are single atomic words, so that lookups never take a lock.
+ *
+ * There is a single writer at a time (the buffer pool manager holds its latch around Insert() and Erase()), but any
+ * number of concurrent readers. A lock-free lookup is only a hint: it can miss an entry that an Erase() is shifting
+ * around, or return a frame that has moved on to another page since. Callers pin the frame and check its page id
+ * before trusting the result, and fall back to a lookup under the writer's lock on a miss, which is always exact.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Creates an empty page table.
+   * @param num_frames the number of frames of the buffer pool; the table gets at least four times as many slots,
+   * rounded up to a power of two
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * @brief Look up the frame holding page_id. Safe to call concurrently with the writer.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame mapped to page_id
+   * @return false if page_id is not mapped
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /** @brief Map page_id to frame_id, replacing any previous mapping of page_id. Writer only. */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /** @brief Remove the mapping of page_id, if any. Writer only. */
+  void Erase(page_id_t page_id);
+
+  /** @return the number of mapped pages. Writer only. */
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  static constexpr uint64_t EMPTY = ~uint64_t{0};
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t entry) -> page_id_t { return static_cast<page_id_t>(entry >> 32); }
+  static auto FrameOf(uint64_t entry) -> frame_id_t { return static_cast<frame_id_t>(entry & 0xffffffff); }
+
+  /** @return the slot page_id would occupy if there were no collisions */
+  auto HomeSlot(page_id_t page_id) const -> size_t;
+
+  /** Power of two, at least four times the number of frames, so probe sequences stay short. */
+  size_t capacity_;
+  size_t mask_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  size_t size_{0};
+};
+
+}  // namespace bustub
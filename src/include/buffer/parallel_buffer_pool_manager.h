@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool.h"
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager partitions the buffer pool into several independent BufferPoolManager instances, each with
+ * its own page table, free list, replacer and latch. A page always lives in instance `page_id % num_instances`, so
+ * operations on pages owned by different instances never contend with each other.
+ */
+class ParallelBufferPoolManager : public BufferPool {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManager instances
+   * @param pool_size the pool size of each BufferPoolManager instance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of each instance
+   * @param num_io_workers the number of disk scheduler threads of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRUK,
+                            size_t num_io_workers = DISK_SCHEDULER_WORKERS);
+
+  ~ParallelBufferPoolManager() override;
+
+  /** @brief Return the total number of frames over all instances. */
+  auto GetPoolSize() -> size_t override;
+
+  /**
+   * @brief Create a new page in one of the instances. Instances are tried round robin, starting from a different
+   * instance on every call, so that new pages are spread evenly.
+   *
+   * @param[out] page_id id of created page
+   * @return nullptr if every instance is full of pinned pages, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id) -> Page * override;
+
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard override;
+
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * override;
+
+  /** The returned guards are bound to the owning instance, so dropping them does not go through this class. */
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard override;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard override;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard override;
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown)
+      -> OptimisticPageGuard override;
+
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool override;
+
+  auto FlushPage(page_id_t page_id) -> bool override;
+
+  void FlushAllPages() override;
+
+  auto DeletePage(page_id_t page_id) -> bool override;
+
+  /** @brief Start a flusher in every instance, each keeping its own frames clean. */
+  void StartFlusher(double clean_fraction = FLUSHER_CLEAN_FRACTION,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(10)) override;
+
+  void StopFlusher() override;
+
+  /** @return the flusher counters summed over all instances */
+  auto GetFlusherStats() -> FlusherStats override;
+
+  void FlushPagesBefore(lsn_t rec_lsn) override;
+
+  /** @return the dirty page tables of all instances */
+  auto GetDirtyPageTable() -> std::vector<std::pair<page_id_t, lsn_t>> override;
+
+  /** @return the buffer pool counters summed over all instances */
+  auto GetStats() -> BufferPoolStats override;
+
+  void ResetStats() override;
+
+  /** @return the hot pages of all instances, taking the hottest remaining page of each instance in turn */
+  auto GetHotPages(size_t max_pages) -> std::vector<page_id_t> override;
+
+  auto PrewarmPage(page_id_t page_id) -> bool override;
+
+  /** @return the instance responsible for the given page id */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager *;
+
+  /** @return the number of instances */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<BufferPoolManager>> instances_;
+  /** Instance the next NewPage call starts probing from. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
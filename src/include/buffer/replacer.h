@@ -12,12 +12,34 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Get, Scan };
+
+/** The replacement policy of a buffer pool, see `BufferPoolManager`. */
+enum class ReplacerType {
+  /** `LRUKReplacer`: evict the frame with the largest backward k-distance */
+  LRUK,
+  /** `LRUReplacer`: evict the least recently used frame */
+  LRU,
+  /** `ClockReplacer`: second chance with one reference bit per frame */
+  Clock,
+  /** `TwoQueueReplacer`: FIFO probation queue, LRU main queue and a ghost queue of recently evicted pages */
+  TwoQueue,
+  /** `ARCReplacer`: adaptive replacement cache, balancing recency and frequency with ghost lists */
+  ARC,
+};
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to evict when the buffer pool is full.
+ *
+ * A frame enters the replacer on its first RecordAccess(), as non-evictable. The buffer pool marks it evictable once
+ * it is no longer pinned. Evict() and Remove() drop the frame and its history, so the next RecordAccess() on that
+ * frame starts over with a new page. All methods are thread-safe.
  */
 class Replacer {
  public:
@@ -25,26 +47,46 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * Evict a frame as defined by the replacement policy. Only frames marked evictable are candidates.
+   * @param[out] frame_id id of the frame that was evicted
+   * @return true if a frame was evicted, false if no frame can be evicted
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to a frame. Throws an OUT_OF_RANGE exception if the frame id is invalid.
+   * @param frame_id id of the frame that was accessed
+   * @param access_type type of the access. Scan accesses are weaker evidence of reuse than others.
+   * @param page_id the page held by the frame. Policies that remember recently evicted pages use it to recognize them
+   * when they come back; INVALID_PAGE_ID treats the page as never seen before.
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                            page_id_t page_id = INVALID_PAGE_ID) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Toggle whether a frame is evictable. Untracked frames are ignored. Throws an OUT_OF_RANGE exception if the frame id
+   * is invalid.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame may be evicted
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Drop an evictable frame and its history, regardless of the policy. Untracked frames are ignored; throws an INVALID
+   * exception if the frame is not evictable.
+   * @param frame_id id of the frame
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of evictable frames */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * List evictable frames in the order Evict() would pick them, without evicting anything.
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames evictable frames, coldest first
+   */
+  virtual auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> = 0;
 };
 
 }  // namespace bustub
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q replacement policy (Johnson and Shasha, VLDB '94).
+ *
+ * A page seen for the first time enters A1in, a FIFO queue. Further accesses while it is in A1in are considered
+ * correlated and do not promote it. Once A1in holds more than k_in frames, it is evicted from first, and the ids of
+ * the pages evicted from it are remembered in the ghost queue A1out (at most k_out entries). A page that comes back
+ * while still in A1out has proven to be reused and enters Am, an LRU queue for hot pages. Scan accesses never promote
+ * a page to Am, so a large scan only cycles through A1in.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the TwoQueueReplacer will be required to store
+   * @param k_in the number of frames A1in may hold before it is evicted from first, defaults to 25% of the frames
+   * @param k_out the number of evicted pages A1out remembers, defaults to 50% of the frames
+   */
+  explicit TwoQueueReplacer(size_t num_frames, size_t k_in = 0, size_t k_out = 0);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionOrder(size_t max_frames) -> std::vector<frame_id_t> override;
+
+ private:
+  enum class Queue { None, In, Main };
+
+  struct TwoQueueNode {
+    Queue queue_{Queue::None};
+    /** Admission time in A1in, last access time in Am. */
+    size_t key_{0};
+    bool is_evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  using EvictionEntry = std::pair<size_t, frame_id_t>;
+
+  /** @return the ordered set of evictable frames of the given queue */
+  auto EvictionSetOf(Queue queue) -> std::set<EvictionEntry> & {
+    return queue == Queue::In ? in_frames_ : main_frames_;
+  }
+
+  /** @return true if the next victim comes from A1in, given the number of frames in A1in and the candidates */
+  auto EvictFromIn(size_t in_size, bool has_in, bool has_main) const -> bool {
+    return has_in && (in_size > k_in_ || !has_main);
+  }
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @brief Drop a tracked frame, remembering its page in A1out if asked to. Caller must hold the latch. */
+  void Drop(frame_id_t frame_id, bool remember);
+
+  std::vector<TwoQueueNode> node_store_;
+  /** Evictable frames of A1in, in admission order. */
+  std::set<EvictionEntry> in_frames_;
+  /** Evictable frames of Am, in LRU order. */
+  std::set<EvictionEntry> main_frames_;
+  /** Number of frames in A1in, evictable or not. */
+  size_t in_size_{0};
+  /** A1out: pages recently evicted from A1in. */
+  GhostList out_pages_;
+  size_t k_in_;
+  size_t k_out_;
+  size_t current_timestamp_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
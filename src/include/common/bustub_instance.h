@@ -27,6 +27,7 @@
 #include "common/util/string_util.h"
 #include "execution/check_options.h"
 #include "libfort/lib/fort.hpp"
+#include "storage/disk/disk_manager.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -34,7 +35,7 @@ namespace bustub {
 class Transaction;
 class ExecutorContext;
 class DiskManager;
-class BufferPoolManager;
+class BufferPool;
 class LockManager;
 class TransactionManager;
 class LogManager;
@@ -218,9 +219,22 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance backed by the given database file.
+   * @param bpm_num_instances number of buffer pool instances, more than one partitions the buffer pool by page id
+   * @param disk_manager_type the file backend used to read and write pages of the database file
+   * @param num_io_workers number of disk scheduler threads of each buffer pool instance
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t bpm_num_instances = 1,
+                          DiskManagerType disk_manager_type = DiskManagerType::FStream,
+                          size_t num_io_workers = DISK_SCHEDULER_WORKERS);
 
-  BustubInstance();
+  /**
+   * Create a BusTub instance backed by memory.
+   * @param bpm_num_instances number of buffer pool instances, more than one partitions the buffer pool by page id
+   * @param num_io_workers number of disk scheduler threads of each buffer pool instance
+   */
+  explicit BustubInstance(size_t bpm_num_instances = 1, size_t num_io_workers = DISK_SCHEDULER_WORKERS);
 
   ~BustubInstance();
 
@@ -254,7 +268,7 @@ class BustubInstance {
   // we cannot do anything on them until someone decides to refactor the recovery test.
 
   DiskManager *disk_manager_;
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPool *buffer_pool_manager_;
   LockManager *lock_manager_;
   TransactionManager *txn_manager_;
   LogManager *log_manager_;
@@ -263,6 +277,9 @@ class BustubInstance {
   ExecutionEngine *execution_engine_;
   std::shared_mutex catalog_lock_;
 
+  /** Not a session variable: `SHOW bpm_stats` prints the buffer pool counters, `SET bpm_stats = 0` resets them. */
+  static constexpr const char *BPM_STATS_VARIABLE = "bpm_stats";
+
   auto GetSessionVariable(const std::string &key) -> std::string {
     if (session_variables_.find(key) != session_variables_.end()) {
       return session_variables_[key];
@@ -288,6 +305,8 @@ class BustubInstance {
   void HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt, ResultWriter &writer);
 
   std::unordered_map<std::string, std::string> session_variables_;
+  /** Hot page list of the database file, next to it; empty for an in-memory instance. */
+  std::string hot_page_file_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -21,21 +22,65 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** How a lock manager deals with deadlocks, see LockManager. */
+enum class DeadlockPolicy { Detection, WaitDie, WoundWait };
+
+/** Deadlock policy of lock managers created from now on. */
+extern DeadlockPolicy deadlock_policy;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** How often CheckpointManager's checkpoint thread takes a fuzzy checkpoint. */
+extern std::chrono::milliseconds checkpoint_interval;
+
+/** Size of the segment files of logs created from now on; an existing log keeps the size it was created with. */
+extern size_t log_segment_size;
+
+/** How the frames of a buffer pool are backed by huge pages, see FrameArena. */
+enum class HugePageMode { None, Transparent, Explicit };
+
+/** Huge pages used for the frames of buffer pools created from now on. */
+extern HugePageMode frame_huge_pages;
+
+/** NUMA node the frames of buffer pools created from now on are bound to, or one of the NUMA_* values below. */
+extern int frame_numa_node;
+
+/** How often a database's buffer pool writes down its hottest pages, for the next start to prewarm from. */
+extern std::chrono::milliseconds hot_page_dump_interval;
+
+/** Largest number of pages a database's buffer pool loads from its hot page list on start, 0 disables prewarming. */
+extern size_t prewarm_budget;
+
+/** Set with `cmake -DBUSTUB_PAGE_SIZE=<bytes>`; the default is for builds that do not go through CMake. */
+#ifndef BUSTUB_PAGE_SIZE_BYTES
+#define BUSTUB_PAGE_SIZE_BYTES 4096
+#endif
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = BUSTUB_PAGE_SIZE_BYTES;                      // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int READ_AHEAD_WINDOW = 8;  // number of pages a scan prefetches ahead of its cursor
+static constexpr double FLUSHER_CLEAN_FRACTION = 0.1;  // fraction of frames the flusher keeps free or clean
+static constexpr int FLUSHER_BATCH_SIZE = 64;          // max pages written back by the flusher in one batch
+static constexpr int ACCESS_BUFFER_SIZE = 1024;        // buffer pool hits recorded before the replacer hears of them
+static constexpr int NUMA_DEFAULT = -1;                // frame_numa_node: leave frame placement to the kernel
+static constexpr int NUMA_INTERLEAVE = -2;             // frame_numa_node: spread frames over all NUMA nodes
+static constexpr int RECOVERY_REDO_THREADS = 4;        // threads redoing the log on recovery, each owns some pages
+static constexpr int DISK_SCHEDULER_WORKERS = 4;       // I/O threads of each buffer pool's disk scheduler
+
+// Table pages address tuples with 16-bit offsets, and O_DIRECT needs frames aligned to at least 4 KiB.
+static_assert(BUSTUB_PAGE_SIZE >= 4096 && BUSTUB_PAGE_SIZE <= 32768, "page size must be between 4 KiB and 32 KiB");
+static_assert((BUSTUB_PAGE_SIZE & (BUSTUB_PAGE_SIZE - 1)) == 0, "page size must be a power of two");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+/**
+ * CRC-32C (Castagnoli), the checksum of iSCSI and ext4. Uses the SSE4.2 instruction when the build targets it, and a
+ * lookup table otherwise.
+ */
+class Crc32c {
+ public:
+  /** @return the CRC32C of length bytes */
+  static auto Value(const char *data, size_t length) -> uint32_t { return Extend(0, data, length); }
+
+  /** @return the CRC32C of some bytes whose CRC32C is crc, followed by length more bytes */
+  static auto Extend(uint32_t crc, const char *data, size_t length) -> uint32_t {
+    crc = ~crc;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+#if defined(__SSE4_2__)
+    for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t), bytes += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, bytes, sizeof(uint64_t));
+      crc = static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+    }
+    for (; length > 0; length--, bytes++) {
+      crc = _mm_crc32_u8(crc, *bytes);
+    }
+#else
+    for (; length > 0; length--, bytes++) {
+      crc = Table()[(crc ^ *bytes) & 0xff] ^ (crc >> 8);
+    }
+#endif
+    return ~crc;
+  }
+
+ private:
+  /** The reflected Castagnoli polynomial. */
+  static constexpr uint32_t POLYNOMIAL = 0x82f63b78;
+
+  static constexpr auto MakeTable() -> std::array<uint32_t, 256> {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) != 0 ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+      }
+      table[i] = crc;
+    }
+    return table;
+  }
+
+  static auto Table() -> const std::array<uint32_t, 256> & {
+    static constexpr std::array<uint32_t, 256> TABLE = MakeTable();
+    return TABLE;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varint.h
+//
+// Identification: src/include/common/util/varint.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Variable-length encoding of unsigned integers, 7 bits per byte, least significant first, with the high bit set on
+ * every byte but the last. Values below 128 take one byte, 32-bit values at most MAX_SIZE.
+ */
+class Varint {
+ public:
+  static constexpr size_t MAX_SIZE = 5;
+
+  /** @return the number of bytes value encodes to */
+  static auto Size(uint32_t value) -> size_t {
+    size_t size = 1;
+    for (; value >= 0x80; value >>= 7) {
+      size++;
+    }
+    return size;
+  }
+
+  /**
+   * @brief Encode value at data, which must have room for Size(value) bytes.
+   * @return the number of bytes written
+   */
+  static auto Put(char *data, uint32_t value) -> size_t {
+    size_t pos = 0;
+    for (; value >= 0x80; value >>= 7) {
+      data[pos++] = static_cast<char>((value & 0x7f) | 0x80);
+    }
+    data[pos++] = static_cast<char>(value);
+    return pos;
+  }
+
+  /**
+   * @brief Decode a value from the first bytes of data.
+   * @param size the number of readable bytes at data
+   * @return the number of bytes read, 0 if data does not start with a complete 32-bit value
+   */
+  static auto Get(const char *data, size_t size, uint32_t *value) -> size_t {
+    uint32_t result = 0;
+    for (size_t pos = 0; pos < size && pos < MAX_SIZE; pos++) {
+      auto byte = static_cast<uint8_t>(data[pos]);
+      result |= static_cast<uint32_t>(byte & 0x7f) << (7 * pos);
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return pos + 1;
+      }
+    }
+    return 0;
+  }
+};
+
+}  // namespace bustub
@@ -13,11 +13,14 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <condition_variable>  // NOLINT
+#include <cstddef>
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
-#include <set>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -32,6 +35,20 @@ class TransactionManager;
 
 /**
  * LockManager handles transactions asking for locks on records.
+ *
+ * The queues of the tables and rows are kept in maps split into shards, each with its own latch, so that transactions
+ * locking different resources seldom contend. A queue is removed as soon as nobody holds or waits for its resource,
+ * and the list nodes of the requests are recycled by the threads that free them.
+ *
+ * Deadlocks are dealt with according to `deadlock_policy`:
+ * - Detection: a transaction that blocks adds edges to the waits-for graph, towards the transactions ahead of it in the
+ *   queue that it waits for, and drops them once it stops waiting. A background thread, started the first time a
+ *   transaction blocks, only looks for cycles through the transactions that blocked since its last round, since any
+ *   new cycle goes through one of them, and aborts the newest transaction of each cycle.
+ * - WaitDie: a transaction may only wait for younger ones. If it would wait for an older one, it aborts instead.
+ * - WoundWait: a transaction that would wait for younger ones aborts them, and waits for them to release their locks;
+ *   it waits for older ones. Transactions aborted this way get no more locks granted once they would have to wait.
+ * With either prevention policy, no cycle can form, and neither the graph nor the thread exists.
  */
 class LockManager {
  public:
@@ -63,8 +80,10 @@ class LockManager {
 
   class LockRequestQueue {
    public:
+    using Iterator = std::list<LockRequest>::iterator;
+
     /** List of lock requests for the same resource (table or row) */
-    std::list<std::shared_ptr<LockRequest>> request_queue_;
+    std::list<LockRequest> request_queue_;
     /** For notifying blocked transactions on this rid */
     std::condition_variable cv_;
     /** txn_id of an upgrading transaction (if any) */
@@ -73,27 +92,29 @@ class LockManager {
     std::mutex latch_;
     auto GrantLockForRow(Transaction *txn, LockManager::LockMode lock_mode) -> bool;
     auto GrantLockForTable(Transaction *txn, LockManager::LockMode lock_mode) -> bool;
+
+    /**
+     * @brief Insert a request before pos, in a list node this thread freed earlier if it has one, so that locking
+     * does not allocate in the steady state. Caller must hold latch_.
+     * @return the inserted request
+     */
+    auto Insert(Iterator pos, const LockRequest &request) -> Iterator;
+
+    /** @brief Remove a request, keeping its list node for the next requests of this thread. Caller must hold latch_. */
+    void Erase(Iterator request);
   };
 
   /**
-   * Creates a new lock manager configured for the deadlock detection policy.
+   * Creates a new lock manager configured for the deadlock policy in `deadlock_policy`.
    */
-  // LockManager() {
-  //   safe_set_.clear();              
-  //   txn_set_.clear();            
-  //   active_set_.clear(); 
-
-  //   map_txn_rid_.clear();
-  //   map_txn_oid_.clear();
-  //   enable_cycle_detection_ = true;
-  //   cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
-  // }
-  LockManager() = default;
-  void StartDeadlockDetection() {
-    BUSTUB_ENSURE(txn_manager_ != nullptr, "txn_manager_ is not set.")
-    enable_cycle_detection_ = true;
-    cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
-  }
+  LockManager() : policy_(deadlock_policy) {}
+
+  /**
+   * Start the deadlock detection thread, unless it runs already or the policy is not Detection. It is started anyway
+   * the first time a transaction blocks.
+   */
+  void StartDeadlockDetection();
+
   ~LockManager() {
     enable_cycle_detection_ = false;
     if (cycle_detection_thread_ != nullptr) {
@@ -307,18 +328,25 @@ class LockManager {
    */
   auto GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>>;
 
+  /**
+   * Removes a transaction and all the edges from and to it from the waits-for graph.
+   * @param txn_id the transaction to remove
+   */
+  auto DeleteNode(txn_id_t txn_id) -> void;
+
   /**
    * Runs cycle detection in the background.
    */
   auto RunCycleDetection() -> void;
-  auto GrantLock(const std::shared_ptr<LockRequest> &lock_request,
-                 const std::shared_ptr<LockRequestQueue> &lock_request_queue) -> bool;
 
-  auto InsertOrDeleteTableLockSet(Transaction *txn, const std::shared_ptr<LockRequest> &lock_request, bool insert)
-      -> void;
+  /** @return whether a lock in mode requested can be granted while another transaction holds one in mode held */
+  static auto AreCompatible(LockMode held, LockMode requested) -> bool;
+
+  auto GrantLock(const LockRequest &lock_request, const LockRequestQueue &lock_request_queue) -> bool;
 
-  auto InsertOrDeleteRowLockSet(Transaction *txn, const std::shared_ptr<LockRequest> &lock_request, bool insert)
-      -> void;
+  auto InsertOrDeleteTableLockSet(Transaction *txn, const LockRequest &lock_request, bool insert) -> void;
+
+  auto InsertOrDeleteRowLockSet(Transaction *txn, const LockRequest &lock_request, bool insert) -> void;
 
   auto InsertRowLockSet(const std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> &lock_set,
                         const table_oid_t &oid, const RID &rid) -> void {
@@ -338,54 +366,107 @@ class LockManager {
     }
     row_lock_set->second.erase(rid);
   }
-  // 返回false表示该点不在死锁环上
-  auto Dfs(txn_id_t txn_id) -> bool {
-    if (safe_set_.find(txn_id) != safe_set_.end()) {
-      return false;
-    }
-    active_set_.insert(txn_id);
-
-    std::vector<txn_id_t> &next_node_vector = waits_for_[txn_id];
-    std::sort(next_node_vector.begin(), next_node_vector.end());
-    for (txn_id_t const next_node : next_node_vector) {
-      if (active_set_.find(next_node) != active_set_.end()) {
-        return true;
-      }
-      if (Dfs(next_node)) {
-        return true;
-      }
-    }
-
-    active_set_.erase(txn_id);
-    safe_set_.insert(txn_id);
-    return false;
-  }
-
-  auto DeleteNode(txn_id_t txn_id) -> void;
   TransactionManager *txn_manager_;
+
  private:
+  /** The resource a blocked transaction waits for. */
+  struct WaitTarget {
+    bool row_;
+    table_oid_t oid_;
+    RID rid_;
+  };
+
+  static constexpr size_t NUM_LOCK_MAP_SHARDS = 64;
+  /** Most queues a shard keeps around for reuse once their resources are unlocked by all. */
+  static constexpr size_t QUEUE_POOL_SIZE = 16;
+
+  /**
+   * A part of a lock map, with its own latch. A queue is only looked up under the latch of its shard, and is latched
+   * before the shard latch is released; it is removed from the map once it is empty, under both latches. A thread that
+   * holds the latch of a queue can thus rely on the queue being in the map.
+   */
+  template <typename Key>
+  struct alignas(64) LockMapShard {
+    std::mutex latch_;
+    std::unordered_map<Key, std::unique_ptr<LockRequestQueue>> map_;
+    std::vector<std::unique_ptr<LockRequestQueue>> free_queues_;
+  };
+
+  /** The queues of all locked tables or rows, split into shards by the hash of the table oid or the RID. */
+  template <typename Key>
+  using LockMap = std::array<LockMapShard<Key>, NUM_LOCK_MAP_SHARDS>;
+
+  /** @return the shard of lock_map that key belongs to */
+  template <typename Key>
+  static auto ShardOf(LockMap<Key> *lock_map, const Key &key) -> LockMapShard<Key> &;
+
+  /**
+   * @brief Find the queue of key and latch it, creating it if create is set.
+   * @return the queue, whose latch the caller must release; nullptr if there is none and create is not set
+   */
+  template <typename Key>
+  auto LatchQueue(LockMap<Key> *lock_map, const Key &key, bool create) -> LockRequestQueue *;
+
+  /** @brief Remove the queue of key from lock_map if it has no requests. Caller must not hold any latch. */
+  template <typename Key>
+  void RemoveQueueIfEmpty(LockMap<Key> *lock_map, const Key &key);
+
+  /**
+   * @brief Wait until request, of txn, is granted, or txn is aborted. lock holds the latch of queue, which is released
+   * while waiting. An aborted request is removed from queue, which may leave it empty.
+   * @return false if txn was aborted
+   */
+  auto WaitForGrant(Transaction *txn, LockRequestQueue *queue, LockRequestQueue::Iterator request,
+                    std::unique_lock<std::mutex> *lock, const WaitTarget &target) -> bool;
+
+  /**
+   * @brief Record that request, of txn, waits behind the transactions ahead of it in queue, applying the deadlock
+   * policy: txn may be aborted (wait-die), or abort others, whose targets are added to wounded (wound-wait). Caller
+   * must hold the latch of queue.
+   */
+  void BlockOn(Transaction *txn, const LockRequestQueue &queue, const LockRequest &request, const WaitTarget &target,
+               std::vector<WaitTarget> *wounded);
+
+  /** @brief Record that txn_id no longer waits. */
+  void StopWaiting(txn_id_t txn_id);
+
+  /** @brief Drop the edges from the waiters of queue to txn_id, which released its lock. Caller must hold its latch. */
+  void ForgetBlocker(const LockRequestQueue &queue, txn_id_t txn_id);
+
+  /** @brief Wake up the transactions waiting for target, so that aborted ones give up. */
+  void Wake(const WaitTarget &target);
+
+  /**
+   * @brief Look for a cycle in the waits-for graph reachable from txn_id, skipping the transactions in safe, which
+   * cannot reach any, and adding to it those found not to. Caller must hold waits_for_latch_.
+   * @param path the transactions on the path from the start to txn_id, which must not be in safe
+   * @param[out] victim the newest transaction of the cycle found
+   * @return whether a cycle was found
+   */
+  auto FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *path, std::unordered_set<txn_id_t> *safe, txn_id_t *victim)
+      -> bool;
+
   /** Fall 2022 */
   /** Structure that holds lock requests for a given table oid */
-  std::unordered_map<table_oid_t, std::shared_ptr<LockRequestQueue>> table_lock_map_;
-  /** Coordination */
-  std::mutex table_lock_map_latch_;
+  LockMap<table_oid_t> table_lock_map_;
 
   /** Structure that holds lock requests for a given RID */
-  std::unordered_map<RID, std::shared_ptr<LockRequestQueue>> row_lock_map_;
-  /** Coordination */
-  std::mutex row_lock_map_latch_;
+  LockMap<RID> row_lock_map_;
+
+  /** Deadlock policy, fixed at construction. */
+  DeadlockPolicy policy_;
 
-  std::atomic<bool> enable_cycle_detection_;
-  std::thread *cycle_detection_thread_;
-  /** Waits-for graph representation. */
+  std::atomic<bool> enable_cycle_detection_{false};
+  std::thread *cycle_detection_thread_{nullptr};
+  std::once_flag cycle_detection_started_;
+  /** Waits-for graph representation: the transactions each blocked transaction waits for. */
   std::unordered_map<txn_id_t, std::vector<txn_id_t>> waits_for_;
+  /** Protects the fields below. Taken after queue latches, never before. */
   std::mutex waits_for_latch_;
-  std::set<txn_id_t> safe_set_;              // 经过dfs算法确认安全的点集合
-  std::set<txn_id_t> txn_set_;               // 所有事务点的集合
-  std::unordered_set<txn_id_t> active_set_;  // 用来临时记录dfs中已经扫描过的点
-
-  std::unordered_map<txn_id_t, RID> map_txn_rid_;
-  std::unordered_map<txn_id_t, table_oid_t> map_txn_oid_;
+  /** The resources the blocked transactions wait for, to wake them up when they get aborted. */
+  std::unordered_map<txn_id_t, WaitTarget> waiting_on_;
+  /** Transactions whose edges changed since the last round of cycle detection. */
+  std::vector<txn_id_t> new_waiters_;
 };
 
 }  // namespace bustub
@@ -309,7 +309,7 @@ class Transaction {
   }
 
   /** @return the current state of the transaction */
-  inline auto GetState() -> TransactionState { return state_; }
+  inline auto GetState() -> TransactionState { return state_.load(); }
 
   inline auto LockTxn() -> void { latch_.lock(); }
 
@@ -319,7 +319,33 @@ class Transaction {
    * Set the state of the transaction.
    * @param state new state
    */
-  inline void SetState(TransactionState state) { state_ = state; }
+  inline void SetState(TransactionState state) { state_.store(state); }
+
+  /**
+   * Set the state of the transaction if it is still expected. Other threads may wound the transaction at any time, so
+   * a transition that must not undo a wound has to go through here.
+   * @param expected the state the transaction must be in
+   * @param state new state
+   * @return false if the transaction was not in the expected state
+   */
+  inline auto CompareAndSetState(TransactionState expected, TransactionState state) -> bool {
+    return state_.compare_exchange_strong(expected, state);
+  }
+
+  /**
+   * Move the transaction from GROWING or SHRINKING to state, used to wound it from another thread and to commit it.
+   * @param state COMMITTED or ABORTED
+   * @return false if the transaction had already committed or aborted
+   */
+  inline auto FinishRunning(TransactionState state) -> bool {
+    TransactionState current = state_.load();
+    while (current == TransactionState::GROWING || current == TransactionState::SHRINKING) {
+      if (state_.compare_exchange_weak(current, state)) {
+        return true;
+      }
+    }
+    return false;
+  }
 
   /** @return the previous LSN */
   inline auto GetPrevLSN() -> lsn_t { return prev_lsn_; }
@@ -330,9 +356,18 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return no more than the LSN of the BEGIN record of the transaction, INVALID_LSN if it is not logged */
+  inline auto GetBeginLSN() -> lsn_t { return begin_lsn_; }
+
+  /**
+   * Set a bound of the LSN of the BEGIN record.
+   * @param begin_lsn an LSN no greater than that of the BEGIN record
+   */
+  inline void SetBeginLSN(lsn_t begin_lsn) { begin_lsn_ = begin_lsn; }
+
  private:
-  /** The current transaction state. */
-  TransactionState state_{TransactionState::GROWING};
+  /** The current transaction state. Atomic, as an older transaction wounds this one from its own thread. */
+  std::atomic<TransactionState> state_{TransactionState::GROWING};
   /** The isolation level of the transaction. */
   IsolationLevel isolation_level_;
   /** The thread ID, used in single-threaded transactions. */
@@ -344,8 +379,10 @@ class Transaction {
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
   /** The undo set of indexes. */
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
-  /** The LSN of the last record written by the transaction. */
-  lsn_t prev_lsn_;
+  /** The LSN of the last record written by the transaction. Checkpoints read it from another thread. */
+  std::atomic<lsn_t> prev_lsn_;
+  /** Set before the transaction is active, and read by checkpoints through the transaction manager. */
+  lsn_t begin_lsn_{INVALID_LSN};
 
   std::mutex latch_;
 
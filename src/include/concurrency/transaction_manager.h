@@ -13,9 +13,12 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -45,10 +48,11 @@ class TransactionManager {
       -> Transaction *;
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. A transaction wounded by an older one before it gets to commit is aborted instead.
    * @param txn the transaction to commit
+   * @return true if the transaction committed, false if it was rolled back
    */
-  void Commit(Transaction *txn);
+  auto Commit(Transaction *txn) -> bool;
 
   /**
    * Aborts a transaction
@@ -77,6 +81,18 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * @return the active transaction table: the transactions that have begun and neither committed nor aborted yet,
+   * with the LSN of their last log record
+   */
+  auto GetActiveTransactionTable() -> std::vector<std::pair<txn_id_t, lsn_t>>;
+
+  /**
+   * @return the LSN before which no active transaction has a log record, INVALID_LSN if no active transaction has
+   * logged anything
+   */
+  auto GetOldestActiveLSN() -> lsn_t;
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -140,6 +156,10 @@ class TransactionManager {
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** Transactions begun by this manager that have not committed or aborted yet. */
+  std::unordered_map<txn_id_t, Transaction *> active_txns_;
+  std::mutex active_txns_latch_;
 };
 
 }  // namespace bustub
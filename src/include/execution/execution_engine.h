@@ -37,7 +37,7 @@ class ExecutionEngine {
    * @param txn_mgr The transaction manager used by the execution engine
    * @param catalog The catalog used by the execution engine
    */
-  ExecutionEngine(BufferPoolManager *bpm, TransactionManager *txn_mgr, Catalog *catalog)
+  ExecutionEngine(BufferPool *bpm, TransactionManager *txn_mgr, Catalog *catalog)
       : bpm_{bpm}, txn_mgr_{txn_mgr}, catalog_{catalog} {}
 
   DISALLOW_COPY_AND_MOVE(ExecutionEngine);
@@ -106,7 +106,7 @@ class ExecutionEngine {
     }
   }
 
-  [[maybe_unused]] BufferPoolManager *bpm_;
+  [[maybe_unused]] BufferPool *bpm_;
   [[maybe_unused]] TransactionManager *txn_mgr_;
   [[maybe_unused]] Catalog *catalog_;
 };
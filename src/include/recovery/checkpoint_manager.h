@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
@@ -19,25 +24,63 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager takes fuzzy checkpoints, which never block transactions.
+ *
+ * A checkpoint logs a CHECKPOINT_BEGIN, then the active transaction table and the dirty page table as they are at that
+ * point, in as many CHECKPOINT_TABLES records as they need, and a CHECKPOINT_END once they are all logged. Pages keep
+ * changing meanwhile; recovery takes the changes logged after CHECKPOINT_BEGIN into account. Finally the buffer pool
+ * is asked to write back, in the background, the pages dirty since before the checkpoint began, so that the next
+ * checkpoint no longer needs redo to start that far back.
+ *
+ * Once a checkpoint is complete, recovery no longer reads the log before the smallest recLSN of its dirty page table
+ * and the first record of its active transactions: the log segments before that point are deleted.
  */
 class CheckpointManager {
  public:
   CheckpointManager(TransactionManager *transaction_manager, LogManager *log_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPool *buffer_pool_manager)
       : transaction_manager_(transaction_manager),
         log_manager_(log_manager),
         buffer_pool_manager_(buffer_pool_manager) {}
 
-  ~CheckpointManager() = default;
+  ~CheckpointManager() { StopCheckpointThread(); }
 
+  /** @brief Log the start of a checkpoint, followed by the active transaction table and the dirty page table. */
   void BeginCheckpoint();
+  /** @brief Log the end of the checkpoint, make it durable, and start writing back the pages it found dirty. */
   void EndCheckpoint();
+  /** @brief Take a whole checkpoint. Concurrent calls take turns. */
+  void Checkpoint();
+
+  /** @brief Take a checkpoint every interval while logging is enabled, on a background thread. */
+  void RunCheckpointThread(std::chrono::milliseconds interval = checkpoint_interval);
+  /** @brief Stop and join the checkpoint thread, if running. */
+  void StopCheckpointThread();
+
+  /** @return the LSN of the CHECKPOINT_BEGIN of the last checkpoint taken, INVALID_LSN if none */
+  auto GetLastCheckpointLSN() -> lsn_t {
+    std::scoped_lock lock(latch_);
+    return last_checkpoint_lsn_;
+  }
 
  private:
-  TransactionManager *transaction_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPool *buffer_pool_manager_;
+
+  /** Serializes checkpoints. */
+  std::mutex checkpoint_latch_;
+  /** The LSN of the CHECKPOINT_BEGIN of the checkpoint in progress. */
+  lsn_t begin_lsn_{INVALID_LSN};
+  /** The first record recovery needs once the checkpoint in progress is complete. */
+  lsn_t truncate_lsn_{INVALID_LSN};
+
+  /** Protects the fields below. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  lsn_t last_checkpoint_lsn_{INVALID_LSN};
+  bool stop_{false};
+  std::thread checkpoint_thread_;
 };
 
 }  // namespace bustub
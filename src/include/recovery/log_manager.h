@@ -13,9 +13,14 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <condition_variable>  // NOLINT
+#include <deque>
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <utility>
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -23,52 +28,122 @@
 namespace bustub {
 
 /**
- * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
- * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ * LogManager maintains a separate thread that is awakened whenever the log buffer is full, whenever a timeout happens,
+ * or whenever a transaction waits for its records to be persisted. When the thread is awakened, the log buffer's
+ * content is written into the disk log file.
+ *
+ * Appends only hold the latch to assign an LSN and reserve room in `log_buffer_`; the record is serialized into that
+ * room after the latch is released. A flush swaps `log_buffer_` with `flush_buffer_`, waits for the appenders still
+ * copying into the old buffer, and writes and syncs it while new records go into the other one.
+ *
+ * Commits are grouped: a transaction that commits while a flush is in progress has its commit record written by the
+ * next flush, together with the records of every transaction that committed meanwhile, so they all share one sync.
+ *
+ * The log manager also remembers where the first record of each segment of the log lies, for checkpoints to drop the
+ * segments that only hold records recovery no longer needs.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
-  }
-
-  ~LogManager() {
-    delete[] log_buffer_;
-    delete[] flush_buffer_;
-    log_buffer_ = nullptr;
-    flush_buffer_ = nullptr;
-  }
+  explicit LogManager(DiskManager *disk_manager);
 
+  ~LogManager();
+
+  /** @brief Set enable_logging and start the flush thread. */
   void RunFlushThread();
+
+  /** @brief Flush the buffered records, stop and join the flush thread, and clear enable_logging. */
   void StopFlushThread();
 
+  /**
+   * @brief Append a log record to the log buffer, waiting for a flush if the buffer is full.
+   * @param log_record the record, whose LSN is set
+   * @return the LSN assigned to the record
+   */
   auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
 
+  /**
+   * @brief Block until the records up to and including lsn are on disk. Callers that wait at the same time are served
+   * by the same flush. If the flush thread is not running, the caller flushes the log buffer itself.
+   * @param lsn the last record to wait for; anything past the last appended record means all of them
+   */
+  void Flush(lsn_t lsn);
+
   inline auto GetNextLSN() -> lsn_t { return next_lsn_; }
   inline auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
+  /** Continue numbering after the records already in the log file, which recovery found. */
+  inline void SetNextLSN(lsn_t lsn) { next_lsn_ = lsn; }
   inline auto GetLogBuffer() -> char * { return log_buffer_; }
 
+  /**
+   * @brief Continue the log at offset, where recovery found that the records end. Nothing must be appended before.
+   * @param offset the offset in the log of the next record
+   */
+  void SetNextOffset(size_t offset);
+
+  /**
+   * @brief Learn where a record lies in the log, for TruncateBefore() to drop the segments before it. Appended records
+   * are noted as they are appended; recovery notes the records it reads, in LSN order, before anything is appended.
+   */
+  void NoteRecordOffset(lsn_t lsn, size_t offset);
+
+  /**
+   * @brief Drop the segments of the log that only hold records before lsn, once nothing before lsn is needed anymore.
+   * Goes no further than the first record of a segment that the log manager knows of.
+   * @param lsn a record that is on disk
+   */
+  void TruncateBefore(lsn_t lsn);
+
  private:
-  // TODO(students): you may add your own member variables
+  /** @brief Wait for flush requests or timeouts and flush the log buffer. Runs on flush_thread_. */
+  void FlushThread();
+
+  /** @brief Write the records appended so far to disk and advance the persistent LSN. Caller must not hold latch_. */
+  void FlushLogBuffer();
+
+  /** @brief Write a record, once its LSN and size are set, in the format described in log_record.h. */
+  static void SerializeLogRecord(const LogRecord &log_record, char *data);
+
+  /** @brief NoteRecordOffset(), with latch_ held. */
+  void NoteRecordOffsetLocked(lsn_t lsn, size_t offset);
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
+  /** Records are appended here, up to log_offset_. */
   char *log_buffer_;
+  /** Written to disk by the flush in progress, if any. */
   char *flush_buffer_;
-
+  int log_offset_{0};
+  /** The offset in the log log_buffer_ is written to. */
+  size_t buffer_offset_;
+  /** The first record of each segment of the log, as its LSN and offset, oldest first. */
+  std::deque<std::pair<lsn_t, size_t>> segment_records_;
+  size_t segment_size_;
+  /** Appenders still copying a record into each buffer; log_writers_ and flush_writers_ point into it. */
+  std::array<std::atomic<int>, 2> writers_{};
+  std::atomic<int> *log_writers_;
+  std::atomic<int> *flush_writers_;
+
+  /** Protects the fields above except the writer counts, and the flags below. */
   std::mutex latch_;
+  /** Serializes flushes. */
+  std::mutex flush_latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread flush_thread_;
+  bool flush_requested_{false};
+  bool stop_{false};
 
+  /** Signalled to wake up the flush thread. */
   std::condition_variable cv_;
+  /** Signalled when the buffers are swapped, so that there is room to append again. */
+  std::condition_variable append_cv_;
+  /** Signalled when the persistent LSN moves forward. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_reader.h
+//
+// Identification: src/include/recovery/log_reader.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "recovery/log_record.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * LogReader streams the records of the log file, in the format described in log_record.h, from a given offset.
+ *
+ * The file is read a chunk at a time, and records are decoded where they lie in the chunk. A record that straddles
+ * the end of the chunk is moved to the front before the next chunk is read after it, and the buffer grows for a
+ * record larger than a chunk, so the chunk size only trades the number of reads against memory.
+ */
+class LogReader {
+ public:
+  /**
+   * @param disk_manager the disk manager holding the log
+   * @param offset the offset in the log file of the first record to read
+   * @param chunk_size how much of the file to read at once
+   */
+  explicit LogReader(DiskManager *disk_manager, size_t offset = 0, size_t chunk_size = LOG_BUFFER_SIZE)
+      : disk_manager_(disk_manager), chunk_size_(chunk_size), buffer_offset_(offset), record_offset_(offset) {}
+
+  /**
+   * @brief Read the next record.
+   * @param[out] log_record the record read
+   * @return false at the end of the log: past the end of the file, or at a record that was cut short or torn, whose
+   * checksum does not match
+   */
+  auto Next(LogRecord *log_record) -> bool;
+
+  /** @return the offset in the log file of the record last read */
+  auto GetRecordOffset() const -> size_t { return record_offset_; }
+
+  /** @return the offset in the log file of the next record to read */
+  auto GetOffset() const -> size_t { return buffer_offset_ + pos_; }
+
+ private:
+  /** @brief Buffer at least size bytes from pos_ on. @return false if the file ends before */
+  auto Fill(size_t size) -> bool;
+
+  DiskManager *disk_manager_;
+  size_t chunk_size_;
+  std::vector<char> buffer_;
+  /** The offset in the log file of buffer_[0]. */
+  size_t buffer_offset_;
+  /** buffer_[pos_, end_) holds the part of the file that is read but not decoded yet. */
+  size_t pos_{0};
+  size_t end_{0};
+  size_t record_offset_;
+};
+
+}  // namespace bustub
@@ -13,7 +13,10 @@
 #pragma once
 
 #include <cassert>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,42 +35,84 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** The start of a fuzzy checkpoint. */
+  CHECKPOINT_BEGIN,
+  /** Part of the active transaction table and dirty page table of a checkpoint. */
+  CHECKPOINT_TABLES,
+  /** The end of a fuzzy checkpoint, once all its tables are logged. */
+  CHECKPOINT_END,
 };
 
 /**
  * For every write operation on the table page, you should write ahead a corresponding log record.
  *
- * For EACH log record, HEADER is like (5 fields in common, 20 bytes in total).
- *---------------------------------------------
- * | size | LSN | transID | prevLSN | LogType |
- *---------------------------------------------
+ * Log records are written in a compact format where every integer, unless noted otherwise, is a varint (see
+ * common/util/varint.h). Page ids and transaction ids are stored plus one, so that the invalid id -1 takes one byte.
+ * Every record is framed as
+ *----------------------------------------------------------
+ * | body_size | checksum (4 bytes, CRC32C of body) | body |
+ *----------------------------------------------------------
+ * so that a record the crash cut short, or a torn write of the log, is detected when reading it back. For EACH log
+ * record, the body starts with a HEADER like (4 fields in common):
+ *--------------------------------------------------------------------
+ * | version << 5 | LogType (1 byte) | LSN | transID | LSN - prevLSN |
+ *--------------------------------------------------------------------
+ * where LSN - prevLSN is 0 when there is no prevLSN.
  * For insert type log record
- *---------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
- *---------------------------------------------------------------
- * For delete type (including markdelete, rollbackdelete, applydelete)
- *----------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
- *---------------------------------------------------------------
- * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
+ *---------------------------------------------------------
+ * | HEADER | page_id | slot_num | tuple_size | tuple_data |
+ *---------------------------------------------------------
+ * For delete type (including markdelete, rollbackdelete, applydelete); the tuple is not logged, as redo and undo only
+ * set or clear its delete mark
+ *-------------------------------
+ * | HEADER | page_id | slot_num |
+ *-------------------------------
+ * For update type log record, when the tuple keeps its size, only the byte ranges of the tuple that change
+ *-------------------------------------------------------------------------------------------------------------
+ * | HEADER | page_id | slot_num | tuple_size | tuple_size | num_ranges | (gap, length, old_data, new_data) ... |
+ *-------------------------------------------------------------------------------------------------------------
+ * where gap is the distance from the end of the previous range, and old_data and new_data are length bytes each.
+ * Otherwise the whole tuples
+ *---------------------------------------------------------------------------------------
+ * | HEADER | page_id | slot_num | old_tuple_size | new_tuple_size | old_data | new_data |
+ *---------------------------------------------------------------------------------------
  * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *-------------------------------------
+ * | HEADER | prev_page_id | page_id |
+ *-------------------------------------
+ * For checkpoint tables type log record, whose prevLSN is the LSN of the CHECKPOINT_BEGIN record; LSNs are stored
+ * plus one too
+ *-------------------------------------------------------------------------------------
+ * | HEADER | num_txns | (txn_id, last_lsn) ... | num_pages | (page_id, rec_lsn) ... |
+ *-------------------------------------------------------------------------------------
+ * Checkpoint begin and end type log records are only a HEADER; the prevLSN of CHECKPOINT_END is the LSN of the
+ * CHECKPOINT_BEGIN record too.
  */
 class LogRecord {
   friend class LogManager;
+  friend class LogReader;
   friend class LogRecovery;
 
  public:
+  /** The version of the format above, in the header of every record. */
+  static const int LOG_FORMAT_VERSION = 1;
+  /** The largest size of the framing and header of a record. */
+  static const int MAX_HEADER_SIZE = 25;
+  /** The most table entries, transactions and pages together, a CHECKPOINT_TABLES record holds. */
+  static const int MAX_CHECKPOINT_ENTRIES = (LOG_BUFFER_SIZE - MAX_HEADER_SIZE - 10) / 10;
+
+  /** A byte range of an updated tuple, with its content before and after the update. */
+  struct UpdateRange {
+    uint32_t offset_;
+    std::string old_data_;
+    std::string new_data_;
+  };
+
   LogRecord() = default;
 
   // constructor for Transaction type(BEGIN/COMMIT/ABORT)
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
-      : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
 
   // constructor for INSERT/DELETE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
@@ -81,37 +126,44 @@ class LogRecord {
       delete_rid_ = rid;
       delete_tuple_ = tuple;
     }
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    payload_size_ = SerializePayload(nullptr);
   }
 
   // constructor for UPDATE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
-            const Tuple &old_tuple, const Tuple &new_tuple)
-      : txn_id_(txn_id),
-        prev_lsn_(prev_lsn),
-        log_record_type_(log_record_type),
-        update_rid_(update_rid),
-        old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
-  }
+            const Tuple &old_tuple, const Tuple &new_tuple);
 
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
-      : size_(HEADER_SIZE),
-        txn_id_(txn_id),
+      : txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         prev_page_id_(prev_page_id),
         page_id_(page_id) {
-    // calculate log record size, header size + sizeof(prev_page_id) + sizeof(page_id)
-    size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
+    payload_size_ = SerializePayload(nullptr);
+  }
+
+  // constructor for CHECKPOINT_TABLES type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type,
+            std::vector<std::pair<txn_id_t, lsn_t>> active_txns, std::vector<std::pair<page_id_t, lsn_t>> dirty_pages)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        active_txns_(std::move(active_txns)),
+        dirty_pages_(std::move(dirty_pages)) {
+    payload_size_ = SerializePayload(nullptr);
   }
 
   ~LogRecord() = default;
 
+  /**
+   * @brief Replay an update on a tuple, forward for redo or backward for undo.
+   * @param[in,out] tuple the tuple as it is before the update when redoing, or after it when undoing
+   * @return false if the update does not fit the tuple
+   */
+  auto ApplyUpdate(Tuple *tuple, bool redo) const -> bool;
+
+  /** @return the tuple of a delete, only set on records built for appending as it is not logged */
   inline auto GetDeleteTuple() -> Tuple & { return delete_tuple_; }
 
   inline auto GetDeleteRID() -> RID & { return delete_rid_; }
@@ -120,14 +172,24 @@ class LogRecord {
 
   inline auto GetInsertRID() -> RID & { return insert_rid_; }
 
+  /** @return the tuple before an update that changes its size, see GetUpdateRanges() otherwise */
   inline auto GetOriginalTuple() -> Tuple & { return old_tuple_; }
 
+  /** @return the tuple after an update that changes its size, see GetUpdateRanges() otherwise */
   inline auto GetUpdateTuple() -> Tuple & { return new_tuple_; }
 
+  /** @return the byte ranges changed by an update that keeps the size of the tuple */
+  inline auto GetUpdateRanges() -> std::vector<UpdateRange> & { return update_ranges_; }
+
   inline auto GetUpdateRID() -> RID & { return update_rid_; }
 
   inline auto GetNewPageRecord() -> page_id_t { return prev_page_id_; }
 
+  inline auto GetActiveTxns() -> std::vector<std::pair<txn_id_t, lsn_t>> & { return active_txns_; }
+
+  inline auto GetDirtyPages() -> std::vector<std::pair<page_id_t, lsn_t>> & { return dirty_pages_; }
+
+  /** @return the size of the record in the log, known once it is appended or read back */
   inline auto GetSize() -> int32_t { return size_; }
 
   inline auto GetLSN() -> lsn_t { return lsn_; }
@@ -152,15 +214,36 @@ class LogRecord {
   }
 
  private:
+  /** @return the size of the record in the log, framing included, which depends on lsn_ */
+  auto SerializedSize() const -> int32_t;
+
+  /** @brief Write the record, framing included, as SerializedSize() bytes at data. */
+  void SerializeTo(char *data) const;
+
+  /**
+   * @brief Write the part of the record that follows the header.
+   * @param data where to write it, nullptr to only compute its size
+   * @return its size
+   */
+  auto SerializePayload(char *data) const -> size_t;
+
+  /**
+   * @brief Read the body of a record, whose checksum the caller verified.
+   * @return false if it is not a valid record of the current format
+   */
+  auto DeserializeBody(const char *data, size_t size) -> bool;
+
   // the length of log record(for serialization, in bytes)
   int32_t size_{0};
+  // the length of what follows the header
+  size_t payload_size_{0};
   // must have fields
   lsn_t lsn_{INVALID_LSN};
   txn_id_t txn_id_{INVALID_TXN_ID};
   lsn_t prev_lsn_{INVALID_LSN};
   LogRecordType log_record_type_{LogRecordType::INVALID};
 
-  // case1: for delete operation, delete_tuple_ for UNDO operation
+  // case1: for delete operation
   RID delete_rid_;
   Tuple delete_tuple_;
 
@@ -168,15 +251,21 @@ class LogRecord {
   RID insert_rid_;
   Tuple insert_tuple_;
 
-  // case3: for update operation
+  // case3: for update operation, the ranges that change when the tuple keeps its size, both tuples otherwise
   RID update_rid_;
+  bool update_is_delta_{false};
+  uint32_t update_size_{0};
+  std::vector<UpdateRange> update_ranges_;
   Tuple old_tuple_;
   Tuple new_tuple_;
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
-  static const int HEADER_SIZE = 20;
+
+  // case5: for checkpoint tables
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
 };  // namespace bustub
 
 }  // namespace bustub
@@ -15,6 +15,9 @@
 #include <algorithm>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
@@ -23,35 +26,91 @@
 namespace bustub {
 
 /**
- * Read log file from disk, redo and undo.
+ * Read log file from disk, redo and undo, in the manner of ARIES.
+ *
+ * Analysis scans the log and rebuilds the transactions that were active at the crash, with their last LSN, and the
+ * dirty page table: every page a record changes, with the LSN of the first record that does (its recLSN). Once it
+ * finds a complete fuzzy checkpoint, the dirty page table becomes the one the checkpoint logged, plus the pages changed
+ * since the checkpoint began, and the records before the smallest recLSN are no longer redone.
+ *
+ * Redo repeats history. The records are split by page id among a number of threads, each of which applies, in LSN
+ * order, the records of its pages that a page does not reflect yet according to its page LSN. A record changes a
+ * single page, except NEWPAGE which is applied to the previous page and to the new page by their respective owners, so
+ * the threads never touch the same page.
+ *
+ * Undo rolls back the losers from their last record down the prev LSN chain, newest record first, and logs an ABORT
+ * for each of them. No compensation records are written: every undo action writes a before image, so doing it twice
+ * is harmless, and the undone pages are flushed before the ABORT records are logged. A crash during undo makes the next
+ * recovery undo the same transactions again.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-  }
-
-  ~LogRecovery() {
-    delete[] log_buffer_;
-    log_buffer_ = nullptr;
-  }
+  /**
+   * @param disk_manager the disk manager holding the log
+   * @param buffer_pool_manager the buffer pool the pages are redone and undone in
+   * @param log_manager if given, continues numbering after the last record found and logs the ABORT records of undone
+   * transactions
+   * @param redo_threads the number of threads redo splits the pages among
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPool *buffer_pool_manager, LogManager *log_manager = nullptr,
+              size_t redo_threads = RECOVERY_REDO_THREADS)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        log_manager_(log_manager),
+        redo_threads_(std::max<size_t>(redo_threads, 1)) {}
 
+  /** @brief Scan the log, rebuilding the active transactions and the dirty page table. Redo and undo run it first. */
+  void Analyze();
+  /** @brief Apply the records that did not reach the pages, with one thread per share of the pages. */
   void Redo();
+  /** @brief Roll back the transactions that had neither committed nor aborted when the log ends. */
   void Undo();
-  auto DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool;
+
+  /** @return the transactions that had neither committed nor aborted, with the LSN of their last record */
+  auto GetActiveTxns() const -> const std::unordered_map<txn_id_t, lsn_t> & { return active_txn_; }
+  /** @return the pages the log changes, with the LSN of the first record that does */
+  auto GetDirtyPageTable() const -> const std::unordered_map<page_id_t, lsn_t> & { return dirty_page_table_; }
+  /** @return the LSN of the CHECKPOINT_BEGIN of the last complete checkpoint, INVALID_LSN if there is none */
+  auto GetCheckpointLSN() const -> lsn_t { return checkpoint_lsn_; }
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** @return the pages a record changes: none, one, or two for a NEWPAGE linked from a previous page */
+  static auto GetPages(const LogRecord &log_record) -> std::vector<page_id_t>;
+
+  /**
+   * @brief Take over the tables of a complete checkpoint.
+   * @param begin_lsn the LSN of its CHECKPOINT_BEGIN
+   * @param active_txns its active transaction table
+   * @param dirty_pages its dirty page table
+   * @param pages_since_begin the pages changed since begin_lsn, with the LSN of the first record that does
+   * @param finished_txns the transactions that committed or aborted so far
+   */
+  void ApplyCheckpoint(lsn_t begin_lsn, const std::vector<std::pair<txn_id_t, lsn_t>> &active_txns,
+                       std::unordered_map<page_id_t, lsn_t> dirty_pages,
+                       const std::unordered_map<page_id_t, lsn_t> &pages_since_begin,
+                       const std::unordered_set<txn_id_t> &finished_txns);
+
+  /** @brief Apply a record to one of its pages, unless the page already reflects it. */
+  void RedoRecord(const LogRecord &log_record, page_id_t page_id);
+
+  /** @brief Revert the change of a record to its page. */
+  void UndoRecord(const LogRecord &log_record);
+
+  DiskManager *disk_manager_;
+  BufferPool *buffer_pool_manager_;
+  LogManager *log_manager_;
+  size_t redo_threads_;
+  bool analyzed_{false};
+  lsn_t checkpoint_lsn_{INVALID_LSN};
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
-
-  int offset_ __attribute__((__unused__));  // NOLINT
-  char *log_buffer_;
+  std::unordered_map<lsn_t, size_t> lsn_mapping_;
+  /** Every page changed by the log, with the LSN of the first record changing it. */
+  std::unordered_map<page_id_t, lsn_t> dirty_page_table_;
+  /** The records that change pages, in LSN order, kept from analysis for redo. */
+  std::vector<LogRecord> page_records_;
 };
 
 }  // namespace bustub
@@ -16,12 +16,30 @@
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/free_page_map.h"
+#include "storage/disk/log_file.h"
 
 namespace bustub {
 
+/** The file backend used to access a database file, see `BustubInstance`. */
+enum class DiskManagerType {
+  /** `DiskManager`: a single `std::fstream` guarded by a latch */
+  FStream,
+  /** `DiskManagerPosix`: positional pread / pwrite on a file descriptor */
+  Posix,
+  /** `DiskManagerPosix` with O_DIRECT, bypassing the OS page cache */
+  PosixDirect,
+  /** `DiskManagerUring`: batched page I/O through io_uring, falls back to `Posix` if io_uring is unavailable */
+  IoUring,
+  /** `DiskManagerMmap`: `Posix` whose buffer pools use the mapped database file instead of reading clean pages */
+  Mmap,
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -37,12 +55,12 @@ class DiskManager {
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -58,6 +76,38 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write a batch of pages to the database file. The default implementation writes them one by one; backends that
+   * can keep several requests in flight override it.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, one buffer per page
+   */
+  virtual void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /**
+   * Read a batch of pages from the database file. The default implementation reads them one by one; backends that
+   * can keep several requests in flight override it.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, one per page
+   */
+  virtual void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /**
+   * Map a page of the database file into memory, for a buffer pool to use as the content of the page instead of
+   * reading it. The view stays valid until the disk manager is destroyed. Changes made through it are private to the
+   * process until the page is written back with WritePage(). Backends without a mapping return nullptr.
+   * @param page_id id of the page
+   * @return the content of the page, or nullptr if the page cannot be mapped
+   */
+  virtual auto GetPageView(page_id_t page_id) -> char * { return nullptr; }
+
+  /**
+   * Discard the changes made through the view of a page, so that it shows the content of the file again. Called when a
+   * frame stops showing the view, once the page has been written back or when it is deleted.
+   * @param page_id id of the page
+   */
+  virtual void ReleasePageView(page_id_t page_id) {}
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -69,10 +119,41 @@ class DiskManager {
    * Read a log entry from the log file.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
+   * @param offset offset of the log entry in the log
    * @return true if the read was successful, false otherwise
    */
-  auto ReadLog(char *log_data, int size, int offset) -> bool;
+  auto ReadLog(char *log_data, int size, size_t offset) -> bool;
+
+  /** @return the offset in the log of the oldest record kept, where reading the log starts */
+  auto GetLogStart() -> size_t;
+
+  /** @return the offset in the log the next WriteLog() writes to */
+  auto GetLogEnd() -> size_t;
+
+  /**
+   * Discard the log from offset on, and write the log at offset from now on, see LogFile::SetEnd().
+   * @param offset the offset where the complete records of the log end
+   */
+  void SetLogEnd(size_t offset);
+
+  /**
+   * Delete the segments of the log that lie entirely before offset, which becomes the start of the log.
+   * @param offset the offset of a record in the log
+   */
+  void TruncateLog(size_t offset);
+
+  /** @return the size of the segment files of the log */
+  auto GetLogSegmentSize() -> size_t;
+
+  /** @return the map tracking the allocated and free pages of the database file */
+  auto GetFreePageMap() -> FreePageMap * { return free_page_map_.get(); }
+
+  /**
+   * Drop the free pages at the end of the database file and shrink the file accordingly. Must not be called while a
+   * buffer pool is using the disk manager.
+   * @return the number of pages left in the database file
+   */
+  virtual auto Compact() -> page_id_t;
 
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
@@ -94,18 +175,28 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
-  std::fstream log_io_;
+  /**
+   * Derive the log file name from `file_name_` and open the log, see LogFile.
+   * @return false if the database file name has no extension
+   */
+  auto OpenLogFile() -> bool;
+  /** Open (or create) the free page map next to the db file, once the db file is open. */
+  void OpenFreePageMap();
+  // the manifest of the log, whose segments are named after it
   std::string log_name_;
+  // the log, none for a disk manager without files
+  std::unique_ptr<LogFile> log_file_;
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
   std::mutex db_io_latch_;
+  // allocated and free pages of the db file, kept in memory only unless OpenFreePageMap() is called
+  std::unique_ptr<FreePageMap> free_page_map_{std::make_unique<FreePageMap>()};
 };
 
 }  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager_posix.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap maps the database file into memory, so that a buffer pool can use the mapped pages as the content
+ * of its frames instead of reading them (see `GetPageView()`). A miss on a page of the file then costs neither a read
+ * syscall nor a copy; the kernel faults the page in from its page cache on first access.
+ *
+ * The file is mapped copy-on-write (`MAP_PRIVATE`): a page modified through a view gets a private copy, and the file
+ * only changes when the page is written back with `WritePage()`, which goes through pwrite like in `DiskManagerPosix`.
+ * Views of pages that were not modified keep sharing the page cache, so they see those writes. Once a modified page
+ * has been written back, `ReleasePageView()` drops its private copy.
+ *
+ * The mapping lives in an address range reserved up front, and grows with the file without moving, so views stay valid
+ * while other pages are mapped. Pages past `max_size`, or past the end of the file, are not mapped; buffer pools read
+ * them into their frames as usual.
+ */
+class DiskManagerMmap : public DiskManagerPosix {
+ public:
+  /** Address space reserved for the mapping by default. It is only backed by memory where the file is accessed. */
+  static constexpr size_t DEFAULT_MAX_SIZE = size_t{1} << 36;
+
+  /**
+   * Creates a new disk manager that maps the specified database file.
+   * @param db_file the file name of the database file to map
+   * @param max_size the largest database file, in bytes, that can be mapped
+   */
+  explicit DiskManagerMmap(const std::string &db_file, size_t max_size = DEFAULT_MAX_SIZE);
+
+  ~DiskManagerMmap() override;
+
+  /**
+   * @return the mapped content of the page, or nullptr if it is not in the file (yet) or past the reserved range
+   */
+  auto GetPageView(page_id_t page_id) -> char * override;
+
+  /** @brief Drop the private copy of a page modified through its view. Call after writing the page back. */
+  void ReleasePageView(page_id_t page_id) override;
+
+  /** Drop the free pages at the end of the file, and unmap them. */
+  auto Compact() -> page_id_t override;
+
+  /** @return the number of bytes of the file mapped so far */
+  auto GetMappedSize() const -> size_t { return mapped_size_.load(); }
+
+ private:
+  /** @brief Map the file up to its current size, and at least up to end if the file is that large. */
+  auto ExtendMapping(size_t end) -> bool;
+
+  /** Start of the reserved address range, aligned to BUSTUB_PAGE_SIZE. */
+  char *map_{nullptr};
+  /** The reservation, which starts up to one page before map_. */
+  char *reservation_{nullptr};
+  size_t reservation_size_{0};
+  /** Largest file size the reserved range can map. */
+  size_t max_size_;
+  /** Number of bytes of the file mapped at map_, a multiple of BUSTUB_PAGE_SIZE. */
+  std::atomic<size_t> mapped_size_{0};
+  /** Serializes changes to the mapping. */
+  std::mutex map_latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.h
+//
+// Identification: src/include/storage/disk/disk_manager_posix.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerPosix reads and writes pages through a raw file descriptor with positional `pread` / `pwrite`. As the
+ * calls do not share a file cursor, concurrent page I/O does not need to be serialized by a latch. The size of the
+ * database file is cached in memory instead of being queried from the file system on every read.
+ *
+ * If `direct_io` is set, the database file is opened with `O_DIRECT` to bypass the OS page cache. Page buffers must
+ * then be aligned to `BUSTUB_PAGE_SIZE`, which is the case for all buffer pool frames; unaligned buffers are bounced
+ * through an aligned scratch buffer. When the file system does not support `O_DIRECT`, the file is opened for buffered
+ * I/O instead. The log file is handled by the base class.
+ */
+class DiskManagerPosix : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io whether to bypass the OS page cache with O_DIRECT
+   */
+  explicit DiskManagerPosix(const std::string &db_file, bool direct_io = false);
+
+  ~DiskManagerPosix() override;
+
+  /**
+   * Shut down the disk manager and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Write a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file. Pages beyond the end of the file are read as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  auto Compact() -> page_id_t override;
+
+  /** @return true if the database file is accessed with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+ protected:
+  /** @return true if the buffer satisfies the alignment required for O_DIRECT */
+  static auto IsAligned(const char *page_data) -> bool {
+    return reinterpret_cast<uintptr_t>(page_data) % BUSTUB_PAGE_SIZE == 0;
+  }
+
+  /** Grow the cached file size to at least `end` bytes. */
+  void ExtendFileSize(size_t end) {
+    size_t file_size = file_size_.load();
+    while (file_size < end && !file_size_.compare_exchange_weak(file_size, end)) {
+    }
+  }
+
+  /** @return a page-sized scratch buffer aligned for O_DIRECT, owned by the calling thread */
+  static auto ScratchPage() -> char *;
+
+  /** file descriptor of the database file, -1 after shutdown */
+  int db_fd_{-1};
+  /** whether the file was opened with O_DIRECT */
+  bool direct_io_{false};
+  /** cached size of the database file in bytes */
+  std::atomic<size_t> file_size_{0};
+};
+
+}  // namespace bustub
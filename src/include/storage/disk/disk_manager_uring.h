@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.h
+//
+// Identification: src/include/storage/disk/disk_manager_uring.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager_posix.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * DiskManagerUring submits page reads and writes through a Linux io_uring. A batch of pages passed to `ReadPages` /
+ * `WritePages` is queued in the submission ring and handed to the kernel with a single `io_uring_enter` call, which
+ * lets the device work on all of them in parallel instead of one synchronous `pread` at a time.
+ *
+ * The ring is set up in the constructor. If io_uring is not available (old kernel, seccomp filter, non-Linux build),
+ * all calls fall back to the positional pread / pwrite implementation of `DiskManagerPosix`.
+ */
+class DiskManagerUring : public DiskManagerPosix {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io whether to bypass the OS page cache with O_DIRECT
+   * @param queue_depth number of entries of the submission ring, i.e. the maximum number of pages in flight
+   */
+  explicit DiskManagerUring(const std::string &db_file, bool direct_io = false, uint32_t queue_depth = 64);
+
+  ~DiskManagerUring() override;
+
+  /**
+   * Shut down the disk manager and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Write a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file. Pages beyond the end of the file are read as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Write a batch of pages to the database file, submitting all of them at once.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, one buffer per page
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override;
+
+  /**
+   * Read a batch of pages from the database file, submitting all of them at once.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, one per page
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override;
+
+  /** @return true if I/O goes through io_uring, false if it falls back to pread / pwrite */
+  auto IsUringEnabled() const -> bool { return ring_fd_ >= 0; }
+
+ private:
+  /** Set up the ring and map the submission / completion queues. Leaves `ring_fd_` at -1 on failure. */
+  void SetUpRing(uint32_t queue_depth);
+
+  /** Unmap the queues and close the ring. */
+  void TearDownRing();
+
+  /**
+   * Submit one I/O per page and wait for all of them. Requests that fail or complete short are finished with
+   * pread / pwrite, and so is everything if the ring has been torn down in the meantime.
+   */
+  void SubmitAndWait(bool is_write, const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /** file descriptor of the ring, -1 if io_uring is not available */
+  std::atomic<int> ring_fd_{-1};
+  /** the ring is shared by all threads, submission and reaping happen under this latch */
+  std::mutex ring_latch_;
+
+  /** mapped submission queue ring and its fields */
+  void *sq_ptr_{nullptr};
+  size_t sq_size_{0};
+  uint32_t *sq_head_{nullptr};
+  uint32_t *sq_tail_{nullptr};
+  uint32_t *sq_mask_{nullptr};
+  uint32_t *sq_array_{nullptr};
+  uint32_t sq_entries_{0};
+  /** mapped submission queue entries */
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  /** mapped completion queue ring and its fields, shares the mapping with the submission ring if possible */
+  void *cq_ptr_{nullptr};
+  size_t cq_size_{0};
+  uint32_t *cq_head_{nullptr};
+  uint32_t *cq_tail_{nullptr};
+  uint32_t *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+}  // namespace bustub
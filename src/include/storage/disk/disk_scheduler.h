@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <optional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/channel.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a Write or Read request for the DiskManager to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /**
+   *  Pointer to the start of the memory location where a page is either:
+   *   1. being read into from disk (on a read).
+   *   2. being written out to disk (on a write).
+   */
+  char *data_;
+
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /** Callback used to signal to the request issuer when the request has been completed. */
+  std::promise<bool> callback_;
+};
+
+/**
+ * @brief The DiskScheduler schedules disk read and write operations.
+ *
+ * A request is scheduled by calling DiskScheduler::Schedule() with an appropriate DiskRequest object. The scheduler
+ * maintains a pool of background worker threads that process the scheduled requests using the disk manager, and the
+ * issuer learns about completion through the future of the request's callback. Requests for the same page always go
+ * to the same worker, so they are executed in the order they were scheduled; requests for different pages run in
+ * parallel.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @brief Creates a new DiskScheduler and starts its workers.
+   * @param disk_manager the disk manager executing the requests
+   * @param num_workers the number of background worker threads
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = 1);
+
+  /** @brief Drains the request queues and joins the worker threads. */
+  ~DiskScheduler();
+
+  /**
+   * @brief Schedules a request for the DiskManager to execute.
+   *
+   * @param r The request to be scheduled.
+   */
+  void Schedule(DiskRequest r);
+
+  /**
+   * @brief Schedules a batch of independent requests. Requests are handed to the workers together, so a batch of N
+   * requests costs one wake-up per worker instead of N round trips.
+   *
+   * @param requests The requests to be scheduled.
+   */
+  void Schedule(std::vector<DiskRequest> requests);
+
+  /**
+   * @brief Create a Promise object. If you want to implement your own version of promise, you can change this function
+   * so that our test cases can use your promise implementation.
+   *
+   * @return std::promise<bool>
+   */
+  auto CreatePromise() -> std::promise<bool> { return {}; };
+
+  /** @return the disk manager the requests are executed against */
+  auto GetDiskManager() -> DiskManager * { return disk_manager_; }
+
+  /** @return the number of worker threads */
+  auto GetNumWorkers() const -> size_t { return workers_.size(); }
+
+ private:
+  /** A worker's queue. std::nullopt is the signal for the worker to exit its loop. */
+  using RequestQueue = Channel<std::optional<std::vector<DiskRequest>>>;
+
+  /** @brief Process scheduled requests from the given queue until the std::nullopt sentinel shows up. */
+  void StartWorkerThread(RequestQueue *queue);
+
+  /** @return the queue (and therefore the worker) responsible for the given page */
+  auto QueueOf(page_id_t page_id) -> RequestQueue *;
+
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_;
+  /** One request queue per worker. */
+  std::vector<std::unique_ptr<RequestQueue>> request_queues_;
+  /** The background threads responsible for issuing scheduled requests to the disk manager. */
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
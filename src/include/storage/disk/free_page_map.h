@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/storage/disk/free_page_map.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FreePageMap tracks which pages of a database file are allocated. Every page id below `GetNumPages()` has been handed
+ * out at some point; a bitmap records the ones that were deallocated since, and `AllocatePage()` hands those out again
+ * before growing the file.
+ *
+ * The map is stored in its own file of `BUSTUB_PAGE_SIZE` pages next to the database file (`foo.db` -> `foo.fsm`).
+ * Page 0 is a header holding the number of pages, page k + 1 holds the bits for page ids
+ * [k * BITS_PER_PAGE, (k + 1) * BITS_PER_PAGE). Growing the file and deallocating pages only mark bitmap pages
+ * changed, they are written together with the header by `Flush()`. On open, the number of pages is taken as the larger
+ * of the header and the size of the database file, which covers every page that was written, and a page deallocated
+ * since the last flush is merely leaked. Reusing a free page is different: if the map still showed it free after a
+ * crash, it would be handed out a second time while holding data. So `AllocatePage()` writes and syncs the bitmap page
+ * before it returns a reused page id.
+ *
+ * A map constructed without a file name lives in memory only.
+ */
+class FreePageMap {
+ public:
+  /** Number of page ids covered by one bitmap page. */
+  static constexpr page_id_t BITS_PER_PAGE = BUSTUB_PAGE_SIZE * 8;
+
+  /** @brief Creates an in-memory map with no pages allocated. */
+  FreePageMap() = default;
+
+  /**
+   * @brief Opens (or creates) the map stored in file_name.
+   * @param file_name the file holding the map
+   * @param num_db_pages the number of pages in the database file. An empty database file discards a stale map.
+   */
+  FreePageMap(const std::string &file_name, page_id_t num_db_pages);
+
+  /** @brief Writes the header and closes the file. */
+  ~FreePageMap();
+
+  DISALLOW_COPY_AND_MOVE(FreePageMap);
+
+  /**
+   * @brief Allocate a page id of the form `offset + i * stride`, reusing a deallocated one if there is any. Page ids
+   * skipped over when growing the file are recorded as free, so other offsets can pick them up. Reusing a page id
+   * writes and syncs its bitmap page.
+   * @param offset the residue of the page id modulo stride
+   * @param stride the step between the page ids the caller may use
+   * @return the allocated page id
+   */
+  auto AllocatePage(page_id_t offset = 0, page_id_t stride = 1) -> page_id_t;
+
+  /**
+   * @brief Deallocate a page, so that it can be handed out again. Page ids that are not allocated are ignored.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * @brief Record that a page is allocated, for recovery to restore allocations the map had not persisted. Page ids
+   * skipped over when growing the file are recorded as free, as in `AllocatePage()`.
+   * @param page_id id of the page
+   */
+  void MarkAllocated(page_id_t page_id);
+
+  /** @return true if page_id was deallocated and not handed out again since */
+  auto IsFree(page_id_t page_id) -> bool;
+
+  /** @return the number of pages of the database file, allocated or free */
+  auto GetNumPages() -> page_id_t;
+
+  /** @return the number of free pages */
+  auto GetNumFreePages() -> size_t;
+
+  /** @brief Write the changed bitmap pages and the header to disk, and sync the file. */
+  void Flush();
+
+  /**
+   * @brief Drop the free pages at the end of the database file from the map. The caller is expected to truncate the
+   * database file to the returned number of pages.
+   * @return the number of pages of the database file after compaction
+   */
+  auto Compact() -> page_id_t;
+
+ private:
+  static constexpr uint32_t MAGIC = 0x46534d31;  // "FSM1"
+  static constexpr size_t WORDS_PER_PAGE = BUSTUB_PAGE_SIZE / sizeof(uint64_t);
+
+  /** @brief Read the map from fd_, or start an empty one if it holds none. */
+  void Load(page_id_t num_db_pages);
+
+  /** @brief Set or clear the bit of page_id and mark its bitmap page dirty. Caller must hold the latch. */
+  void SetFree(page_id_t page_id, bool is_free);
+
+  /** @brief Grow (or shrink) the bitmap to cover num_pages page ids. Caller must hold the latch. */
+  void Resize(page_id_t num_pages);
+
+  /** @brief Write bitmap page `bitmap_page` to fd_ and sync it, if it changed since it was last written. */
+  void PersistBitmapPage(size_t bitmap_page);
+
+  /** @brief Write bitmap page `bitmap_page` to fd_. Caller must hold the latch. */
+  void WriteBitmapPage(size_t bitmap_page);
+
+  /** @brief Write the header to fd_. Caller must hold the latch. */
+  void WriteHeader();
+
+  std::mutex latch_;
+  /** Serializes Flush() and Compact(), so that an older copy of a bitmap page never overwrites a newer one. */
+  std::mutex flush_latch_;
+  /** File holding the map, -1 for an in-memory map. */
+  int fd_{-1};
+  /** Number of page ids handed out so far; all page ids at or above it are unallocated. */
+  page_id_t num_pages_{0};
+  /** Number of bits set in bits_. */
+  size_t num_free_{0};
+  /** One bit per page id, set if the page is free. Always a whole number of bitmap pages. */
+  std::vector<uint64_t> bits_;
+  /** No word before this one has a bit set. */
+  size_t first_free_word_{0};
+  /** One flag per bitmap page, set if the page changed since it was last written. */
+  std::vector<bool> dirty_pages_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_file.h
+//
+// Identification: src/include/storage/disk/log_file.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LogFile stores the write-ahead log, a stream of bytes addressed by offset, as a sequence of fixed-size segment files
+ * next to a manifest (`foo.log` -> `foo.log.000000`, `foo.log.000001`, ...). Segment n holds the bytes of the log at
+ * offsets [n * segment size, (n + 1) * segment size).
+ *
+ * The manifest holds the segment size and the start of the log: the offset of the oldest record that is kept.
+ * `Truncate()` moves the start forward and deletes the segments before it, so the log does not grow forever. The
+ * manifest is replaced atomically, and only when segments are deleted.
+ *
+ * Every segment is allocated at its full size when it is created, and the segment after the one being written is
+ * created in the background. Appends thus never extend a file, and syncing them never has to write file metadata.
+ * The part of a segment past the end of the log reads as zeros.
+ *
+ * The end of the log is where the last complete record ends, which only recovery can tell: it calls `SetEnd()`. Until
+ * then, appends go to a fresh segment after the existing ones, so they never overwrite anything.
+ */
+class LogFile {
+ public:
+  /**
+   * @brief Opens the log whose manifest is file_name, or starts an empty one if there is none. Files are only created
+   * once something is written.
+   * @param file_name the manifest of the log
+   */
+  explicit LogFile(const std::string &file_name);
+
+  /** @brief Waits for the segment being created, if any, and closes the files. */
+  ~LogFile();
+
+  DISALLOW_COPY_AND_MOVE(LogFile);
+
+  /** @brief Append size bytes at the end of the log and sync them to disk. */
+  void Write(const char *data, size_t size);
+
+  /**
+   * @brief Read size bytes of the log at offset. What lies past the end of the log reads as zeros.
+   * @return false if offset is at or past the end of the log
+   */
+  auto Read(char *data, size_t size, size_t offset) -> bool;
+
+  /** @return the offset of the oldest record kept */
+  auto GetStart() -> size_t;
+
+  /** @return the offset the next write goes to */
+  auto GetEnd() -> size_t;
+
+  /**
+   * @brief Discard the log from offset on, and append at offset from now on. Recovery calls it with the offset where
+   * the complete records end, so that a torn tail does not linger after the records appended next.
+   */
+  void SetEnd(size_t offset);
+
+  /**
+   * @brief Make offset the start of the log, and delete the segments that lie entirely before it.
+   * @param offset the offset of a record, no further than the end of the log
+   */
+  void Truncate(size_t offset);
+
+  /** @return the size of the segments of the log */
+  auto GetSegmentSize() const -> size_t { return segment_size_; }
+
+  /** @return the name of the file of segment n */
+  auto GetSegmentName(size_t segment) const -> std::string;
+
+  /** @brief Delete the log whose manifest is file_name, with all its segments. */
+  static void Remove(const std::string &file_name);
+
+ private:
+  static constexpr uint32_t MAGIC = 0x4c4f4731;  // "LOG1"
+
+  /** @brief Read the manifest into segment_size_ and start_. @return false if there is none, or it is corrupt */
+  auto ReadManifest() -> bool;
+
+  /** @brief Replace the manifest by one holding segment_size_ and start, and make the change durable. */
+  void WriteManifest(size_t start);
+
+  /**
+   * @return the descriptor of segment n, opened on first use. Missing segments are created if create is set, -1
+   * otherwise. Caller must hold the latch.
+   */
+  auto OpenSegment(size_t segment, bool create) -> int;
+
+  /** @brief Start creating the segment after the one being written, in the background. Caller must hold the latch. */
+  void PrepareNextSegment();
+
+  /** @brief Wait for the segment being created in the background, if any. Caller must hold the latch. */
+  void WaitNextSegment();
+
+  /** @brief Create segment n at its full size, replacing any file by that name. @return its descriptor, -1 on error */
+  auto CreateSegment(size_t segment) const -> int;
+
+  /** @brief Make the creation and deletion of files next to the manifest durable. */
+  void SyncDirectory() const;
+
+  std::string file_name_;
+  size_t segment_size_;
+
+  /** Serializes truncations, which write the manifest without holding latch_. */
+  std::mutex truncate_latch_;
+  /** Protects the fields below. */
+  std::mutex latch_;
+  /** Whether the manifest exists, which is written on the first write to an empty log. */
+  bool created_{false};
+  size_t start_{0};
+  size_t end_{0};
+  /** The open segments, by number. */
+  std::map<size_t, int> segments_;
+  /** The segment being created in the background, and its descriptor once it is. */
+  size_t next_segment_{0};
+  std::future<int> next_fd_;
+};
+
+}  // namespace bustub
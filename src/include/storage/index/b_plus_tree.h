@@ -67,7 +67,7 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
-  explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
+  explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPool *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
                      int internal_max_size = INTERNAL_PAGE_SIZE);
 
@@ -87,6 +87,13 @@ class BPlusTree {
   // 获得该键值所在的叶节点
   auto GetLeafPage(const KeyType &key, std::deque<Page *> &transaction, Operation op,
                    std::deque<page_id_t> &parent_page_id) -> BasicPageGuard;
+  /**
+   * Find the leaf holding key without latching the inner pages: they are read through OptimisticPageGuards, and each
+   * one is validated once the next page is pinned. Only the leaf is read latched. The caller holds root_latch_ in read
+   * mode, it is released here. Returns false if writers got in the way OPTIMISTIC_READ_ATTEMPTS times in a row, or if
+   * the buffer pool had no frame for a page on the way.
+   */
+  auto GetLeafPageOptimistic(const KeyType &key, ReadPageGuard *leaf_guard) -> bool;
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
@@ -110,10 +117,10 @@ class BPlusTree {
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   // Print the B+ tree
-  void Print(BufferPoolManager *bpm);
+  void Print(BufferPool *bpm);
 
   // Draw the B+ tree
-  void Draw(BufferPoolManager *bpm, const std::string &outf);
+  void Draw(BufferPool *bpm, const std::string &outf);
 
   /**
    * @brief draw a B+ tree, below is a printed
@@ -150,7 +157,7 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  BufferPoolManager *bpm_;
+  BufferPool *bpm_;
   KeyComparator comparator_;
   std::vector<std::string> log;  // NOLINT
   // std::deque<page_id_t> parent_page_id_;
@@ -159,6 +166,8 @@ class BPlusTree {
   int internal_max_size_;
   // INDEXITERATOR_TYPE end;
   page_id_t header_page_id_;
+  /** Number of optimistic descents GetValue() tries before it latches the inner pages on the way down. */
+  static constexpr int OPTIMISTIC_READ_ATTEMPTS = 4;
   std::mutex latch_;
   std::mutex latch_1_;
   ReaderWriterLatch root_latch_;
@@ -25,7 +25,7 @@ class IndexIterator {
   // you may define your own constructor based on your member variables
   IndexIterator();
   ~IndexIterator();  // NOLINT
-  IndexIterator(page_id_t page_id, page_id_t page_index, BufferPoolManager *bpm, B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page)
+  IndexIterator(page_id_t page_id, page_id_t page_index, BufferPool *bpm, B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page)
       : page_id_(page_id), leaf_page_(leaf_page), page_index_(page_index), bpm_(bpm) {
     // if(page_id != INVALID_PAGE_ID){
     //   page_ = bpm->FetchPageWrite(page_id);
@@ -65,7 +65,7 @@ class IndexIterator {
   page_id_t page_id_ = INVALID_PAGE_ID;
   B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page_ = nullptr;
   int page_index_ = 0;
-  BufferPoolManager *bpm_ = nullptr;
+  BufferPool *bpm_ = nullptr;
 };
 
 }  // namespace bustub
@@ -28,7 +28,7 @@ namespace bustub {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTableIndex : public Index {
  public:
-  LinearProbeHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+  LinearProbeHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPool *buffer_pool_manager,
                             size_t num_buckets, const HashFunction<KeyType> &hash_fn);
 
   ~LinearProbeHashTableIndex() override = default;
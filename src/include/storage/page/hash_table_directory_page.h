@@ -28,7 +28,7 @@ namespace bustub {
  *
  * Directory format (size in byte):
  * --------------------------------------------------------------------------------------------
- * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(BUSTUB_PAGE_SIZE - 2572)
  * --------------------------------------------------------------------------------------------
  */
 class HashTableDirectoryPage {
@@ -194,4 +194,6 @@ class HashTableDirectoryPage {
   page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
 };
 
+static_assert(sizeof(HashTableDirectoryPage) <= BUSTUB_PAGE_SIZE);
+
 }  // namespace bustub
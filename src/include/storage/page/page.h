@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <new>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -30,14 +32,24 @@ class Page {
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() {
-    data_ = new char[BUSTUB_PAGE_SIZE];
+  /** Constructor. Zeros out the page data. The data is page-aligned so that frames can be used for O_DIRECT I/O. */
+  Page() : owns_data_(true) {
+    data_ = new (std::align_val_t{BUSTUB_PAGE_SIZE}) char[BUSTUB_PAGE_SIZE];
     ResetMemory();
   }
 
+  /**
+   * Constructor for a page whose data lives in memory owned by someone else, e.g. a buffer pool's frame arena. The data
+   * must be page-aligned and is expected to be zeroed already.
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) {}
+
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() {
+    if (owns_data_) {
+      operator delete[](data_, std::align_val_t{BUSTUB_PAGE_SIZE});
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -51,11 +63,18 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version of the page is odd until the latch is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -63,12 +82,36 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * @return the version of the page content. It changes every time the write latch is taken or released, and is odd
+   * while a writer holds the latch.
+   */
+  inline auto GetVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * @return true if nobody took the write latch since GetVersion() returned version, so that anything read from the
+   * page in between without latching is consistent
+   */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
   /** Sets the page LSN. */
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
+  /** @return the LSN of the first logged change since the page was last written back, INVALID_LSN if none */
+  inline auto GetRecLSN() -> lsn_t { return rec_lsn_; }
+
+  /** Records lsn as the recLSN, unless an earlier logged change since the page was last written back set it. */
+  inline void SetRecLSN(lsn_t lsn) {
+    lsn_t none = INVALID_LSN;
+    rec_lsn_.compare_exchange_strong(none, lsn);
+  }
+
  protected:
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
@@ -85,14 +128,23 @@ class Page {
   // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
   // we store it as a ptr.
   char *data_;
+  /** False if data_ is owned by someone else. */
+  bool owns_data_;
+  // The book-keeping fields are atomic because buffer pool hits pin and unpin frames without the buffer pool latch.
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /** The pin count of this page, -1 while the buffer pool manager assigns the frame to another page. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** True while the buffer pool manager reads this frame from disk or writes its previous content back. */
+  std::atomic<bool> io_in_progress_ = false;
+  /** See GetRecLSN(). Cleared by the buffer pool manager before it writes the page back. */
+  std::atomic<lsn_t> rec_lsn_ = INVALID_LSN;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Incremented when the write latch is taken and when it is released, see GetVersion(). */
+  std::atomic<uint64_t> version_ = 0;
 };
 
 }  // namespace bustub
@@ -4,13 +4,13 @@
 #include "storage/page/page.h"
 namespace bustub {
 
-class BufferPoolManager;
+class BufferPool;
 
 class BasicPageGuard {
  public:
   BasicPageGuard() = default;
 
-  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {
+  BasicPageGuard(BufferPool *bpm, Page *page) : bpm_(bpm), page_(page) {
     // std::cout << "BasicPageGuard" << std::endl;
   }
 
@@ -80,11 +80,27 @@ class BasicPageGuard {
     return reinterpret_cast<T *>(GetDataMut());
   }
 
+  /**
+   * Set the page LSN once a logged change is made to the page. The first LSN set since the page was last written back
+   * is its recLSN, which checkpoints record in the dirty page table.
+   */
+  void SetLSN(lsn_t lsn) {
+    is_dirty_ = true;
+    page_->SetLSN(lsn);
+    page_->SetRecLSN(lsn);
+  }
+
+  /**
+   * Set the recLSN before a change is logged, to a bound no later than the LSN of its record, so that a checkpoint
+   * taken in between finds the page dirty. No effect if the page already has a recLSN.
+   */
+  void SetRecLSN(lsn_t lsn) { page_->SetRecLSN(lsn); }
+
  public:
   friend class ReadPageGuard;
   friend class WritePageGuard;
 
-  BufferPoolManager *bpm_{nullptr};
+  BufferPool *bpm_{nullptr};
   Page *page_{nullptr};
   bool is_dirty_{false};
 };
@@ -92,7 +108,7 @@ class BasicPageGuard {
 class ReadPageGuard {
  public:
   ReadPageGuard() = default;
-  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+  ReadPageGuard(BufferPool *bpm, Page *page) : guard_(bpm, page) {
     // std::cout << "ReadPageGuard"
     //           << "   " << this << "   " << page->GetPageId() << std::endl;
   }
@@ -155,7 +171,7 @@ class ReadPageGuard {
 class WritePageGuard {
  public:
   WritePageGuard() = default;
-  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+  WritePageGuard(BufferPool *bpm, Page *page) : guard_(bpm, page) {
     // std::cout << "WritePageGuard"
     //           << "   " << this << "   " << page->GetPageId() << std::endl;
     guard_.is_dirty_ = true;
@@ -218,9 +234,63 @@ class WritePageGuard {
     return guard_.AsMut<T>();
   }
 
+  /** Set the page LSN after a logged change, see BasicPageGuard::SetLSN(). */
+  void SetLSN(lsn_t lsn) { guard_.SetLSN(lsn); }
+
+  /** Set the recLSN before a change is logged, see BasicPageGuard::SetRecLSN(). */
+  void SetRecLSN(lsn_t lsn) { guard_.SetRecLSN(lsn); }
+
  private:
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticPageGuard pins a page and remembers its version, but takes no latch. Reads through the guard may race with
+ * a writer and see inconsistent data, so the caller must call Validate() after reading and before acting on anything
+ * it read, and start over if it fails. Anything used to address memory (sizes, indexes) must be bounds-checked before
+ * it is validated.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+  OptimisticPageGuard(BufferPool *bpm, Page *page)
+      : guard_(bpm, page), version_(page == nullptr ? 0 : page->GetVersion()) {}
+  OptimisticPageGuard(const OptimisticPageGuard &) = delete;
+  auto operator=(const OptimisticPageGuard &) -> OptimisticPageGuard & = delete;
+  OptimisticPageGuard(OptimisticPageGuard &&that) noexcept = default;
+  auto operator=(OptimisticPageGuard &&that) noexcept -> OptimisticPageGuard & = default;
+  ~OptimisticPageGuard() = default;
+
+  /** @brief Unpin the page. */
+  void Drop() { guard_.Drop(); }
+
+  /** @return true if the guard holds no page, e.g. because the buffer pool had no frame to fetch it into */
+  auto IsEmpty() -> bool { return guard_.page_ == nullptr; }
+
+  /** @return true if no writer latched the page since the guard was taken */
+  auto Validate() -> bool { return guard_.page_->ValidateVersion(version_); }
+
+  /**
+   * @brief Take the read latch of the page and hand the pin over to a ReadPageGuard, if no writer latched the page
+   * since this guard was taken. The guard is empty afterwards on success, and unchanged on failure.
+   * @param[out] guard the read guard
+   * @return false if the page changed
+   */
+  auto TryUpgradeRead(ReadPageGuard *guard) -> bool;
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+  uint64_t version_{0};
+};
+
 }  // namespace bustub
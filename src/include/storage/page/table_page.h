@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstring>
+#include <limits>
 #include <optional>
 #include <tuple>
 #include <utility>
@@ -27,7 +28,7 @@
 
 namespace bustub {
 
-static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
+static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 12;
 
 /**
  * Slotted page format:
@@ -39,7 +40,7 @@ static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
  *
  *  Header format (size in bytes):
  *  ----------------------------------------------------------------------------
- *  | NextPageId (4)| NumTuples(2) | NumDeletedTuples(2) |
+ *  | NextPageId (4)| LSN (4) | NumTuples(2) | NumDeletedTuples(2) |
  *  ----------------------------------------------------------------------------
  *  ----------------------------------------------------------------
  *  | Tuple_1 offset+size (4) | Tuple_2 offset+size (4) | ... |
@@ -47,6 +48,8 @@ static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
  *
  * Tuple format:
  * | meta | data |
+ *
+ * The LSN is the one of the last log record applied to the page, at the same offset as `Page::GetLSN()` reads it.
  */
 
 class TablePage {
@@ -65,6 +68,12 @@ class TablePage {
   /** Set the page id of the next page in the table. */
   void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+  /** @return the LSN of the last log record applied to this page */
+  auto GetLSN() const -> lsn_t { return lsn_; }
+
+  /** Set the LSN of the last log record applied to this page. */
+  void SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
   /** Get the next offset to insert, return nullopt if this tuple cannot fit in this page */
   auto GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const -> std::optional<uint16_t>;
 
@@ -101,6 +110,7 @@ class TablePage {
   using TupleInfo = std::tuple<uint16_t, uint16_t, TupleMeta>;
   char page_start_[0];
   page_id_t next_page_id_;
+  lsn_t lsn_;
   uint16_t num_tuples_;
   uint16_t num_deleted_tuples_;
   TupleInfo tuple_info_[0];
@@ -110,5 +120,6 @@ class TablePage {
 };
 
 static_assert(sizeof(TablePage) == TABLE_PAGE_HEADER_SIZE);
+static_assert(BUSTUB_PAGE_SIZE <= std::numeric_limits<uint16_t>::max(), "tuple offsets are stored in 16 bits");
 
 }  // namespace bustub
@@ -28,6 +28,9 @@ namespace bustub {
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * With a log manager and logging enabled, every change to a page is logged before it is made, and the page LSN is set
+ * to the LSN of its record while the page is write latched.
  */
 class TableHeap {
   friend class TableIterator;
@@ -38,31 +41,34 @@ class TableHeap {
   /**
    * Create a table heap without a transaction. (open table)
    * @param buffer_pool_manager the buffer pool manager
-   * @param first_page_id the id of the first page
+   * @param log_manager the log manager, nullptr to never log changes
    */
-  explicit TableHeap(BufferPoolManager *bpm);
+  explicit TableHeap(BufferPool *bpm, LogManager *log_manager = nullptr);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return std::nullopt.
    * @param meta tuple meta
    * @param tuple tuple to insert
+   * @param txn the transaction the change is logged for, if any
    * @return rid of the inserted tuple
    */
-  auto InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::optional<RID>;
+  auto InsertTuple(const TupleMeta &meta, const Tuple &tuple, Transaction *txn = nullptr) -> std::optional<RID>;
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
    * @param meta new tuple meta
    * @param[out] rid the rid of the inserted tuple
+   * @param txn the transaction the change is logged for, if any
    */
-  void UpdateTupleMeta(const TupleMeta &meta, RID rid);
+  void UpdateTupleMeta(const TupleMeta &meta, RID rid, Transaction *txn = nullptr);
 
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
+   * @param access_type type of access to the page, AccessType::Scan when called by a table iterator
    * @return the meta and tuple
    */
-  auto GetTuple(RID rid) -> std::pair<TupleMeta, Tuple>;
+  auto GetTuple(RID rid, AccessType access_type = AccessType::Unknown) -> std::pair<TupleMeta, Tuple>;
 
   /**
    * Read a tuple meta from the table. Note: if you want to get tuple and meta together, use `GetTuple` insead
@@ -83,11 +89,26 @@ class TableHeap {
    * @param meta new tuple meta
    * @param tuple  new tuple
    * @param[out] rid the rid of the tuple to be updated
+   * @param txn the transaction the change is logged for, if any
    */
-  void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid);
+  void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid, Transaction *txn = nullptr);
 
  private:
-  BufferPoolManager *bpm_;
+  /** @return true if changes to this table are logged */
+  auto IsLogging() const -> bool { return log_manager_ != nullptr && enable_logging; }
+
+  /**
+   * Append a record for a change made by txn, chaining it to the previous record of txn.
+   * @param txn the transaction making the change, nullptr for none
+   * @param guard the page the change is made to, whose recLSN is set before the record is appended
+   * @param make_record builds the record from the transaction id and previous LSN
+   * @return the LSN of the record
+   */
+  template <typename Guard, typename MakeRecord>
+  auto AppendLogRecord(Transaction *txn, Guard *guard, MakeRecord &&make_record) -> lsn_t;
+
+  BufferPool *bpm_;
+  LogManager *log_manager_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
 
   std::mutex latch_;
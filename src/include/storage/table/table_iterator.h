@@ -24,6 +24,7 @@
 namespace bustub {
 
 class TableHeap;
+struct ReadAheadScan;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
@@ -51,6 +52,9 @@ class TableIterator {
   TableHeap *table_heap_;
   RID rid_;
 
+  // Read-ahead registration of this scan with the buffer pool, see BufferPoolManager::RegisterReadAhead().
+  std::shared_ptr<ReadAheadScan> read_ahead_;
+
   // When creating table iterator, we will record the maximum RID that we should scan.
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
@@ -52,6 +52,7 @@ class Tuple {
   friend class TablePage;
   friend class TableHeap;
   friend class TableIterator;
+  friend class LogRecord;
 
  public:
   // Default constructor (to create a dummy tuple)
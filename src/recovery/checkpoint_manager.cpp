@@ -12,16 +12,97 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace bustub {
 
 void CheckpointManager::BeginCheckpoint() {
-  // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
-  // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
-  // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  LogRecord begin(INVALID_TXN_ID, INVALID_LSN, LogRecordType::CHECKPOINT_BEGIN);
+  begin_lsn_ = log_manager_->AppendLogRecord(&begin);
+
+  // The tables are taken after CHECKPOINT_BEGIN is logged: whatever changes after they are taken is logged after it.
+  auto active_txns = transaction_manager_->GetActiveTransactionTable();
+  auto dirty_pages = buffer_pool_manager_->GetDirtyPageTable();
+
+  // Recovery starting from this checkpoint needs no record before the oldest change redo may have to repeat, nor
+  // before the first record of a transaction undo may have to roll back.
+  truncate_lsn_ = begin_lsn_;
+  for (const auto &[page_id, rec_lsn] : dirty_pages) {
+    truncate_lsn_ = std::min(truncate_lsn_, rec_lsn);
+  }
+  lsn_t oldest_active_lsn = transaction_manager_->GetOldestActiveLSN();
+  if (oldest_active_lsn != INVALID_LSN) {
+    truncate_lsn_ = std::min(truncate_lsn_, oldest_active_lsn);
+  }
+
+  // Split the tables so that every record fits in the log buffer.
+  size_t txn_pos = 0;
+  size_t page_pos = 0;
+  do {
+    size_t room = LogRecord::MAX_CHECKPOINT_ENTRIES;
+    size_t num_txns = std::min(room, active_txns.size() - txn_pos);
+    size_t num_pages = std::min(room - num_txns, dirty_pages.size() - page_pos);
+    LogRecord tables(INVALID_TXN_ID, begin_lsn_, LogRecordType::CHECKPOINT_TABLES,
+                     {active_txns.begin() + txn_pos, active_txns.begin() + txn_pos + num_txns},
+                     {dirty_pages.begin() + page_pos, dirty_pages.begin() + page_pos + num_pages});
+    log_manager_->AppendLogRecord(&tables);
+    txn_pos += num_txns;
+    page_pos += num_pages;
+  } while (txn_pos < active_txns.size() || page_pos < dirty_pages.size());
 }
 
 void CheckpointManager::EndCheckpoint() {
-  // Allow transactions to resume, completing the checkpoint.
+  LogRecord end(INVALID_TXN_ID, begin_lsn_, LogRecordType::CHECKPOINT_END);
+  lsn_t end_lsn = log_manager_->AppendLogRecord(&end);
+  log_manager_->Flush(end_lsn);
+  {
+    std::scoped_lock lock(latch_);
+    last_checkpoint_lsn_ = begin_lsn_;
+  }
+  // Now that the checkpoint is durable, recovery can start from the record it needs first.
+  log_manager_->TruncateBefore(truncate_lsn_);
+
+  // Once these pages are written, redo after the next checkpoint starts no earlier than this one.
+  buffer_pool_manager_->FlushPagesBefore(begin_lsn_);
+}
+
+void CheckpointManager::Checkpoint() {
+  std::scoped_lock lock(checkpoint_latch_);
+  BeginCheckpoint();
+  EndCheckpoint();
+}
+
+void CheckpointManager::RunCheckpointThread(std::chrono::milliseconds interval) {
+  std::scoped_lock lock(latch_);
+  if (checkpoint_thread_.joinable()) {
+    return;
+  }
+  stop_ = false;
+  checkpoint_thread_ = std::thread([this, interval] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!cv_.wait_for(lock, interval, [this] { return stop_; })) {
+      if (!enable_logging) {
+        continue;
+      }
+      lock.unlock();
+      Checkpoint();
+      lock.lock();
+    }
+  });
+}
+
+void CheckpointManager::StopCheckpointThread() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!checkpoint_thread_.joinable()) {
+      return;
+    }
+    stop_ = true;
+  }
+  cv_.notify_one();
+  checkpoint_thread_.join();
 }
 
 }  // namespace bustub
@@ -12,43 +12,201 @@
 
 #include "recovery/log_manager.h"
 
+#include "common/exception.h"
+#include "common/macros.h"
+
 namespace bustub {
+
+LogManager::LogManager(DiskManager *disk_manager)
+    : next_lsn_(0),
+      persistent_lsn_(INVALID_LSN),
+      buffer_offset_(disk_manager->GetLogEnd()),
+      segment_size_(disk_manager->GetLogSegmentSize()),
+      log_writers_(&writers_[0]),
+      flush_writers_(&writers_[1]),
+      disk_manager_(disk_manager) {
+  log_buffer_ = new char[LOG_BUFFER_SIZE];
+  flush_buffer_ = new char[LOG_BUFFER_SIZE];
+}
+
+LogManager::~LogManager() {
+  StopFlushThread();
+  delete[] log_buffer_;
+  delete[] flush_buffer_;
+  log_buffer_ = nullptr;
+  flush_buffer_ = nullptr;
+}
+
 /*
  * set enable_logging = true
  * Start a separate thread to execute flush to disk operation periodically
- * The flush can be triggered when timeout or the log buffer is full or buffer
- * pool manager wants to force flush (it only happens when the flushed page has
- * a larger LSN than persistent LSN)
+ * The flush can be triggered when timeout or the log buffer is full or a
+ * transaction waits for its commit record (see Flush())
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_.joinable()) {
+    return;
+  }
+  stop_ = false;
+  enable_logging = true;
+  flush_thread_ = std::thread([this] { FlushThread(); });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::scoped_lock lock(latch_);
+    if (!flush_thread_.joinable()) {
+      return;
+    }
+    stop_ = true;
+  }
+  cv_.notify_one();
+  flush_thread_.join();
+  enable_logging = false;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t { return INVALID_LSN; }
+auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+  // The size of the header depends on the LSN, which is not known yet: make room for the largest one.
+  auto max_size = static_cast<int>(log_record->payload_size_) + LogRecord::MAX_HEADER_SIZE;
+  if (log_record->payload_size_ > static_cast<size_t>(LOG_BUFFER_SIZE) || max_size > LOG_BUFFER_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "log record does not fit in the log buffer");
+  }
+
+  // Only reserve the room under the latch. LSNs and offsets are handed out in the same order, so a flush that takes
+  // the buffer persists every record up to the last LSN assigned.
+  char *data;
+  std::atomic<int> *writers;
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (log_offset_ + max_size > LOG_BUFFER_SIZE) {
+      if (!flush_thread_.joinable()) {
+        lock.unlock();
+        FlushLogBuffer();
+        lock.lock();
+        continue;
+      }
+      flush_requested_ = true;
+      cv_.notify_one();
+      append_cv_.wait(lock);
+    }
+    log_record->lsn_ = next_lsn_++;
+    log_record->size_ = log_record->SerializedSize();
+    NoteRecordOffsetLocked(log_record->lsn_, buffer_offset_ + log_offset_);
+    data = log_buffer_ + log_offset_;
+    log_offset_ += log_record->size_;
+    writers = log_writers_;
+    writers->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  SerializeLogRecord(*log_record, data);
+  writers->fetch_sub(1, std::memory_order_release);
+  return log_record->lsn_;
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  lsn = std::min<lsn_t>(lsn, next_lsn_ - 1);
+  while (persistent_lsn_ < lsn) {
+    if (!flush_thread_.joinable()) {
+      lock.unlock();
+      FlushLogBuffer();
+      lock.lock();
+      continue;
+    }
+    // Whoever asks while a flush is in progress gets served by the next one, along with everybody else who asked.
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+void LogManager::FlushThread() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!stop_) {
+    cv_.wait_for(lock, log_timeout, [this] { return flush_requested_ || stop_; });
+    lock.unlock();
+    FlushLogBuffer();
+    lock.lock();
+  }
+  // Records may have been appended during the last flush of the loop, they must not be lost.
+  lock.unlock();
+  FlushLogBuffer();
+}
+
+void LogManager::FlushLogBuffer() {
+  std::scoped_lock flush_latch(flush_latch_);
+  int size;
+  lsn_t last_lsn;
+  {
+    std::scoped_lock lock(latch_);
+    std::swap(log_buffer_, flush_buffer_);
+    std::swap(log_writers_, flush_writers_);
+    size = log_offset_;
+    log_offset_ = 0;
+    buffer_offset_ += size;
+    last_lsn = next_lsn_ - 1;
+    flush_requested_ = false;
+  }
+  append_cv_.notify_all();
+
+  // Every record of the buffer was reserved before the swap, but some may still be being copied in.
+  while (flush_writers_->load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+  // The disk manager expects the two buffers in turn, so write even when there is nothing to write.
+  disk_manager_->WriteLog(flush_buffer_, size);
+
+  {
+    std::scoped_lock lock(latch_);
+    persistent_lsn_ = last_lsn;
+  }
+  flushed_cv_.notify_all();
+}
+
+void LogManager::SetNextOffset(size_t offset) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(log_offset_ == 0, "records were appended before the log was recovered");
+  buffer_offset_ = offset;
+}
+
+void LogManager::NoteRecordOffset(lsn_t lsn, size_t offset) {
+  std::scoped_lock lock(latch_);
+  NoteRecordOffsetLocked(lsn, offset);
+}
+
+void LogManager::NoteRecordOffsetLocked(lsn_t lsn, size_t offset) {
+  if (segment_records_.empty() || offset / segment_size_ > segment_records_.back().second / segment_size_) {
+    segment_records_.emplace_back(lsn, offset);
+  }
+}
+
+void LogManager::TruncateBefore(lsn_t lsn) {
+  size_t offset;
+  {
+    std::scoped_lock lock(latch_);
+    // The log may start at the last of these records no later than lsn: every record before it precedes lsn.
+    while (segment_records_.size() > 1 && segment_records_[1].first <= lsn) {
+      segment_records_.pop_front();
+    }
+    if (segment_records_.empty() || segment_records_.front().first > lsn) {
+      return;
+    }
+    offset = segment_records_.front().second;
+  }
+  disk_manager_->TruncateLog(offset);
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *data) { log_record.SerializeTo(data); }
 
 }  // namespace bustub
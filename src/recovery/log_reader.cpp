@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_reader.cpp
+//
+// Identification: src/recovery/log_reader.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/util/crc32c.h"
+#include "common/util/varint.h"
+
+namespace bustub {
+
+auto LogReader::Next(LogRecord *log_record) -> bool {
+  record_offset_ = GetOffset();
+  // Past the end of the file the disk manager reads zeros, which are no valid size.
+  if (!Fill(Varint::MAX_SIZE + sizeof(uint32_t))) {
+    return false;
+  }
+  uint32_t body_size;
+  size_t size_length = Varint::Get(buffer_.data() + pos_, end_ - pos_, &body_size);
+  if (size_length == 0 || body_size == 0 || body_size > static_cast<uint32_t>(LOG_BUFFER_SIZE)) {
+    return false;
+  }
+  size_t record_size = size_length + sizeof(uint32_t) + body_size;
+  if (!Fill(record_size)) {
+    return false;
+  }
+
+  const char *record = buffer_.data() + pos_;
+  const char *body = record + size_length + sizeof(uint32_t);
+  uint32_t checksum;
+  memcpy(&checksum, record + size_length, sizeof(uint32_t));
+  if (checksum != Crc32c::Value(body, body_size) || !log_record->DeserializeBody(body, body_size)) {
+    return false;
+  }
+  log_record->size_ = static_cast<int32_t>(record_size);
+  pos_ += record_size;
+  return true;
+}
+
+auto LogReader::Fill(size_t size) -> bool {
+  if (end_ - pos_ >= size) {
+    return true;
+  }
+  // Keep what is left of the last chunk, and read the next one after it.
+  size_t left = end_ - pos_;
+  if (left > 0) {
+    memmove(buffer_.data(), buffer_.data() + pos_, left);
+  }
+  buffer_offset_ += pos_;
+  pos_ = 0;
+  end_ = left;
+  buffer_.resize(std::max(size, left + chunk_size_));
+  auto to_read = static_cast<int>(buffer_.size() - end_);
+  if (!disk_manager_->ReadLog(buffer_.data() + end_, to_read, buffer_offset_ + end_)) {
+    return false;
+  }
+  end_ += to_read;
+  return end_ >= size;
+}
+
+}  // namespace bustub
@@ -0,0 +1,311 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <cstring>
+
+#include "common/util/crc32c.h"
+#include "common/util/varint.h"
+
+namespace bustub {
+
+namespace {
+
+/** Runs of unchanged bytes shorter than this are logged with the changed ranges around them, which costs less. */
+constexpr uint32_t UPDATE_RANGE_MIN_GAP = 4;
+
+/** Ids and LSNs are stored plus one, so that -1 is stored as 0. */
+auto ToStored(int32_t value) -> uint32_t { return static_cast<uint32_t>(value) + 1; }
+
+auto FromStored(uint32_t value) -> int32_t { return static_cast<int32_t>(value - 1); }
+
+/** @return LSN - prevLSN as stored in the header, 0 without a prevLSN */
+auto PrevLSNDelta(lsn_t lsn, lsn_t prev_lsn) -> uint32_t {
+  return prev_lsn == INVALID_LSN ? 0 : static_cast<uint32_t>(lsn) - static_cast<uint32_t>(prev_lsn);
+}
+
+/** @return the size of the header of a record in the body */
+auto HeaderSize(lsn_t lsn, txn_id_t txn_id, lsn_t prev_lsn) -> size_t {
+  return 1 + Varint::Size(static_cast<uint32_t>(lsn)) + Varint::Size(ToStored(txn_id)) +
+         Varint::Size(PrevLSNDelta(lsn, prev_lsn));
+}
+
+}  // namespace
+
+LogRecord::LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
+                     const Tuple &old_tuple, const Tuple &new_tuple)
+    : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type), update_rid_(update_rid) {
+  if (old_tuple.GetLength() != new_tuple.GetLength()) {
+    old_tuple_ = old_tuple;
+    new_tuple_ = new_tuple;
+    payload_size_ = SerializePayload(nullptr);
+    return;
+  }
+
+  update_is_delta_ = true;
+  update_size_ = old_tuple.GetLength();
+  const char *old_data = old_tuple.GetData();
+  const char *new_data = new_tuple.GetData();
+  uint32_t pos = 0;
+  while (pos < update_size_) {
+    if (old_data[pos] == new_data[pos]) {
+      pos++;
+      continue;
+    }
+    uint32_t end = pos + 1;
+    for (uint32_t i = end; i < update_size_ && i < end + UPDATE_RANGE_MIN_GAP; i++) {
+      if (old_data[i] != new_data[i]) {
+        end = i + 1;
+      }
+    }
+    update_ranges_.push_back({pos, std::string(old_data + pos, end - pos), std::string(new_data + pos, end - pos)});
+    pos = end;
+  }
+  payload_size_ = SerializePayload(nullptr);
+}
+
+auto LogRecord::ApplyUpdate(Tuple *tuple, bool redo) const -> bool {
+  if (!update_is_delta_) {
+    if (tuple->GetLength() != (redo ? old_tuple_ : new_tuple_).GetLength()) {
+      return false;
+    }
+    tuple->data_ = redo ? new_tuple_.data_ : old_tuple_.data_;
+    return true;
+  }
+  if (tuple->GetLength() != update_size_) {
+    return false;
+  }
+  for (const auto &range : update_ranges_) {
+    const std::string &data = redo ? range.new_data_ : range.old_data_;
+    memcpy(tuple->data_.data() + range.offset_, data.data(), data.size());
+  }
+  return true;
+}
+
+auto LogRecord::SerializedSize() const -> int32_t {
+  size_t body_size = HeaderSize(lsn_, txn_id_, prev_lsn_) + payload_size_;
+  return static_cast<int32_t>(Varint::Size(body_size) + sizeof(uint32_t) + body_size);
+}
+
+void LogRecord::SerializeTo(char *data) const {
+  size_t body_size = HeaderSize(lsn_, txn_id_, prev_lsn_) + payload_size_;
+  size_t pos = Varint::Put(data, body_size);
+  char *checksum = data + pos;
+  char *body = checksum + sizeof(uint32_t);
+
+  pos = 0;
+  body[pos++] = static_cast<char>((LOG_FORMAT_VERSION << 5) | static_cast<int>(log_record_type_));
+  pos += Varint::Put(body + pos, static_cast<uint32_t>(lsn_));
+  pos += Varint::Put(body + pos, ToStored(txn_id_));
+  pos += Varint::Put(body + pos, PrevLSNDelta(lsn_, prev_lsn_));
+  pos += SerializePayload(body + pos);
+
+  uint32_t crc = Crc32c::Value(body, pos);
+  memcpy(checksum, &crc, sizeof(uint32_t));
+}
+
+auto LogRecord::SerializePayload(char *data) const -> size_t {
+  size_t pos = 0;
+  auto put = [data, &pos](uint32_t value) {
+    pos += data == nullptr ? Varint::Size(value) : Varint::Put(data + pos, value);
+  };
+  auto put_bytes = [data, &pos](const char *bytes, size_t size) {
+    if (data != nullptr) {
+      memcpy(data + pos, bytes, size);
+    }
+    pos += size;
+  };
+  auto put_rid = [&put](const RID &rid) {
+    put(ToStored(rid.GetPageId()));
+    put(rid.GetSlotNum());
+  };
+
+  switch (log_record_type_) {
+    case LogRecordType::INSERT:
+      put_rid(insert_rid_);
+      put(insert_tuple_.GetLength());
+      put_bytes(insert_tuple_.GetData(), insert_tuple_.GetLength());
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      put_rid(delete_rid_);
+      break;
+    case LogRecordType::UPDATE:
+      put_rid(update_rid_);
+      if (update_is_delta_) {
+        put(update_size_);
+        put(update_size_);
+        put(update_ranges_.size());
+        uint32_t end = 0;
+        for (const auto &range : update_ranges_) {
+          put(range.offset_ - end);
+          put(range.old_data_.size());
+          put_bytes(range.old_data_.data(), range.old_data_.size());
+          put_bytes(range.new_data_.data(), range.new_data_.size());
+          end = range.offset_ + range.old_data_.size();
+        }
+      } else {
+        put(old_tuple_.GetLength());
+        put(new_tuple_.GetLength());
+        put_bytes(old_tuple_.GetData(), old_tuple_.GetLength());
+        put_bytes(new_tuple_.GetData(), new_tuple_.GetLength());
+      }
+      break;
+    case LogRecordType::NEWPAGE:
+      put(ToStored(prev_page_id_));
+      put(ToStored(page_id_));
+      break;
+    case LogRecordType::CHECKPOINT_TABLES:
+      put(active_txns_.size());
+      for (const auto &[txn_id, last_lsn] : active_txns_) {
+        put(ToStored(txn_id));
+        put(ToStored(last_lsn));
+      }
+      put(dirty_pages_.size());
+      for (const auto &[page_id, rec_lsn] : dirty_pages_) {
+        put(ToStored(page_id));
+        put(ToStored(rec_lsn));
+      }
+      break;
+    default:
+      break;
+  }
+  return pos;
+}
+
+auto LogRecord::DeserializeBody(const char *data, size_t size) -> bool {
+  // Never read past the end of the body, even though its checksum matched.
+  size_t pos = 0;
+  auto get = [data, size, &pos](uint32_t *value) {
+    size_t read = Varint::Get(data + pos, size - pos, value);
+    pos += read;
+    return read != 0;
+  };
+  auto get_id = [&get](int32_t *value) {
+    uint32_t stored;
+    if (!get(&stored)) {
+      return false;
+    }
+    *value = FromStored(stored);
+    return true;
+  };
+  auto get_bytes = [data, size, &pos](uint32_t length, const char **bytes) {
+    if (length > size - pos) {
+      return false;
+    }
+    *bytes = data + pos;
+    pos += length;
+    return true;
+  };
+  auto get_rid = [&get, &get_id](RID *rid) {
+    page_id_t page_id;
+    uint32_t slot_num;
+    if (!get_id(&page_id) || !get(&slot_num)) {
+      return false;
+    }
+    *rid = RID(page_id, slot_num);
+    return true;
+  };
+  auto get_tuple = [&get_bytes](uint32_t length, Tuple *tuple) {
+    const char *bytes;
+    if (!get_bytes(length, &bytes)) {
+      return false;
+    }
+    tuple->data_.assign(bytes, bytes + length);
+    return true;
+  };
+
+  if (size == 0) {
+    return false;
+  }
+  auto kind = static_cast<uint8_t>(data[pos++]);
+  int type = kind & 0x1f;
+  if ((kind >> 5) != LOG_FORMAT_VERSION || type <= static_cast<int>(LogRecordType::INVALID) ||
+      type > static_cast<int>(LogRecordType::CHECKPOINT_END)) {
+    return false;
+  }
+  log_record_type_ = static_cast<LogRecordType>(type);
+  uint32_t lsn;
+  uint32_t prev_lsn_delta;
+  if (!get(&lsn) || !get_id(&txn_id_) || !get(&prev_lsn_delta)) {
+    return false;
+  }
+  lsn_ = static_cast<lsn_t>(lsn);
+  prev_lsn_ = prev_lsn_delta == 0 ? INVALID_LSN : static_cast<lsn_t>(lsn - prev_lsn_delta);
+
+  bool ok = true;
+  switch (log_record_type_) {
+    case LogRecordType::INSERT: {
+      uint32_t length;
+      ok = get_rid(&insert_rid_) && get(&length) && get_tuple(length, &insert_tuple_);
+      break;
+    }
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      ok = get_rid(&delete_rid_);
+      break;
+    case LogRecordType::UPDATE: {
+      uint32_t old_size;
+      uint32_t new_size;
+      ok = get_rid(&update_rid_) && get(&old_size) && get(&new_size);
+      update_ranges_.clear();
+      update_is_delta_ = ok && old_size == new_size;
+      if (!update_is_delta_) {
+        ok = ok && get_tuple(old_size, &old_tuple_) && get_tuple(new_size, &new_tuple_);
+        break;
+      }
+      update_size_ = old_size;
+      uint32_t num_ranges;
+      ok = get(&num_ranges) && num_ranges <= size;
+      uint32_t end = 0;
+      for (uint32_t i = 0; ok && i < num_ranges; i++) {
+        uint32_t gap;
+        uint32_t length;
+        const char *old_data;
+        const char *new_data;
+        ok = get(&gap) && get(&length) && static_cast<uint64_t>(end) + gap + length <= update_size_ &&
+             get_bytes(length, &old_data) && get_bytes(length, &new_data);
+        if (ok) {
+          update_ranges_.push_back({end + gap, std::string(old_data, length), std::string(new_data, length)});
+          end += gap + length;
+        }
+      }
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      ok = get_id(&prev_page_id_) && get_id(&page_id_);
+      break;
+    case LogRecordType::CHECKPOINT_TABLES: {
+      uint32_t num_txns;
+      ok = get(&num_txns) && num_txns <= static_cast<uint32_t>(MAX_CHECKPOINT_ENTRIES);
+      active_txns_.resize(ok ? num_txns : 0);
+      for (auto &[txn_id, last_lsn] : active_txns_) {
+        ok = ok && get_id(&txn_id) && get_id(&last_lsn);
+      }
+      uint32_t num_pages;
+      ok = ok && get(&num_pages) && num_pages <= static_cast<uint32_t>(MAX_CHECKPOINT_ENTRIES);
+      dirty_pages_.resize(ok ? num_pages : 0);
+      for (auto &[page_id, rec_lsn] : dirty_pages_) {
+        ok = ok && get_id(&page_id) && get_id(&rec_lsn);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return ok && pos == size;
+}
+
+}  // namespace bustub
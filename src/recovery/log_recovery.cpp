@@ -0,0 +1,358 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_recovery.cpp
+//
+// Identification: src/recovery/log_recovery.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_recovery.h"
+
+#include <optional>
+#include <queue>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <utility>
+
+#include "common/logger.h"
+#include "recovery/log_reader.h"
+#include "storage/page/page_guard.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+/** Undo reads one record at a time, so it reads that much of the log rather than a whole log buffer. */
+static constexpr size_t UNDO_READ_SIZE = 1024;
+
+auto LogRecovery::GetPages(const LogRecord &log_record) -> std::vector<page_id_t> {
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+      return {log_record.insert_rid_.GetPageId()};
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return {log_record.delete_rid_.GetPageId()};
+    case LogRecordType::UPDATE:
+      return {log_record.update_rid_.GetPageId()};
+    case LogRecordType::NEWPAGE:
+      if (log_record.prev_page_id_ == INVALID_PAGE_ID) {
+        return {log_record.page_id_};
+      }
+      return {log_record.prev_page_id_, log_record.page_id_};
+    default:
+      return {};
+  }
+}
+
+void LogRecovery::Analyze() {
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  dirty_page_table_.clear();
+  page_records_.clear();
+  checkpoint_lsn_ = INVALID_LSN;
+
+  // The tables of the checkpoint in progress, which only count once its CHECKPOINT_END is found, and the pages changed
+  // since its CHECKPOINT_BEGIN, which the tables may have missed.
+  lsn_t checkpoint_begin = INVALID_LSN;
+  std::vector<std::pair<txn_id_t, lsn_t>> checkpoint_txns;
+  std::unordered_map<page_id_t, lsn_t> checkpoint_pages;
+  std::unordered_map<page_id_t, lsn_t> pages_since_begin;
+  std::unordered_set<txn_id_t> finished_txns;
+
+  // The log ends past the end of the file, or at a record the crash cut short. It starts with the first record that
+  // checkpoints kept, which precedes a complete checkpoint if any record was dropped.
+  LogReader reader(disk_manager_, disk_manager_->GetLogStart());
+  lsn_t next_lsn = INVALID_LSN;
+  while (true) {
+    LogRecord log_record;
+    if (!reader.Next(&log_record) || (next_lsn != INVALID_LSN && log_record.lsn_ != next_lsn)) {
+      break;
+    }
+    lsn_mapping_[log_record.lsn_] = reader.GetRecordOffset();
+    next_lsn = log_record.lsn_ + 1;
+    if (log_manager_ != nullptr) {
+      log_manager_->NoteRecordOffset(log_record.lsn_, reader.GetRecordOffset());
+    }
+
+    switch (log_record.log_record_type_) {
+      case LogRecordType::CHECKPOINT_BEGIN:
+        checkpoint_begin = log_record.lsn_;
+        checkpoint_txns.clear();
+        checkpoint_pages.clear();
+        pages_since_begin.clear();
+        continue;
+      case LogRecordType::CHECKPOINT_TABLES:
+        if (checkpoint_begin != INVALID_LSN && log_record.prev_lsn_ == checkpoint_begin) {
+          checkpoint_txns.insert(checkpoint_txns.end(), log_record.active_txns_.begin(), log_record.active_txns_.end());
+          for (const auto &[page_id, rec_lsn] : log_record.dirty_pages_) {
+            auto [it, inserted] = checkpoint_pages.emplace(page_id, rec_lsn);
+            if (!inserted) {
+              it->second = std::min(it->second, rec_lsn);
+            }
+          }
+        }
+        continue;
+      case LogRecordType::CHECKPOINT_END:
+        if (checkpoint_begin != INVALID_LSN && log_record.prev_lsn_ == checkpoint_begin) {
+          ApplyCheckpoint(checkpoint_begin, checkpoint_txns, std::move(checkpoint_pages), pages_since_begin,
+                          finished_txns);
+          checkpoint_begin = INVALID_LSN;
+          checkpoint_pages.clear();
+        }
+        continue;
+      default:
+        break;
+    }
+
+    txn_id_t txn_id = log_record.txn_id_;
+    if (txn_id != INVALID_TXN_ID) {
+      if (log_record.log_record_type_ == LogRecordType::COMMIT || log_record.log_record_type_ == LogRecordType::ABORT) {
+        active_txn_.erase(txn_id);
+        finished_txns.insert(txn_id);
+      } else {
+        active_txn_[txn_id] = log_record.lsn_;
+      }
+    }
+    auto pages = GetPages(log_record);
+    if (pages.empty()) {
+      continue;
+    }
+    for (auto page_id : pages) {
+      dirty_page_table_.emplace(page_id, log_record.lsn_);
+      if (checkpoint_begin != INVALID_LSN) {
+        pages_since_begin.emplace(page_id, log_record.lsn_);
+      }
+    }
+    if (log_record.log_record_type_ == LogRecordType::NEWPAGE) {
+      // The free page map may not have been written since the page was allocated.
+      disk_manager_->GetFreePageMap()->MarkAllocated(log_record.page_id_);
+    }
+    page_records_.push_back(std::move(log_record));
+  }
+
+  // New records go right after the last complete one, over whatever the crash left after it.
+  disk_manager_->SetLogEnd(reader.GetRecordOffset());
+  if (log_manager_ != nullptr) {
+    log_manager_->SetNextOffset(reader.GetRecordOffset());
+    if (next_lsn != INVALID_LSN) {
+      log_manager_->SetNextLSN(next_lsn);
+      log_manager_->SetPersistentLSN(next_lsn - 1);
+    }
+  }
+  analyzed_ = true;
+}
+
+void LogRecovery::ApplyCheckpoint(lsn_t begin_lsn, const std::vector<std::pair<txn_id_t, lsn_t>> &active_txns,
+                                  std::unordered_map<page_id_t, lsn_t> dirty_pages,
+                                  const std::unordered_map<page_id_t, lsn_t> &pages_since_begin,
+                                  const std::unordered_set<txn_id_t> &finished_txns) {
+  // A page changed before the checkpoint and missing from its table was written back since: only the checkpoint's
+  // recLSNs and the changes logged after it began need redoing.
+  for (const auto &[page_id, lsn] : pages_since_begin) {
+    dirty_pages.emplace(page_id, lsn);
+  }
+  dirty_page_table_ = std::move(dirty_pages);
+
+  // Transactions whose records precede the part of the log that was read are only known from the checkpoint.
+  for (const auto &[txn_id, last_lsn] : active_txns) {
+    if (finished_txns.count(txn_id) == 0) {
+      active_txn_.emplace(txn_id, last_lsn);
+    }
+  }
+
+  lsn_t redo_lsn = begin_lsn;
+  for (const auto &[page_id, rec_lsn] : dirty_page_table_) {
+    redo_lsn = std::min(redo_lsn, rec_lsn);
+  }
+  page_records_.erase(std::remove_if(page_records_.begin(), page_records_.end(),
+                                     [redo_lsn](const LogRecord &record) { return record.lsn_ < redo_lsn; }),
+                      page_records_.end());
+  checkpoint_lsn_ = begin_lsn;
+}
+
+void LogRecovery::Redo() {
+  if (!analyzed_) {
+    Analyze();
+  }
+
+  // Each thread owns the pages whose id falls in its share, and gets their records in LSN order.
+  std::vector<std::vector<std::pair<page_id_t, const LogRecord *>>> shares(redo_threads_);
+  for (const auto &log_record : page_records_) {
+    for (auto page_id : GetPages(log_record)) {
+      shares[page_id % redo_threads_].emplace_back(page_id, &log_record);
+    }
+  }
+  std::vector<std::thread> threads;
+  for (auto &share : shares) {
+    if (share.empty()) {
+      continue;
+    }
+    threads.emplace_back([this, &share] {
+      for (const auto &[page_id, log_record] : share) {
+        RedoRecord(*log_record, page_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  page_records_.clear();
+  page_records_.shrink_to_fit();
+}
+
+void LogRecovery::RedoRecord(const LogRecord &log_record, page_id_t page_id) {
+  auto dirty_page = dirty_page_table_.find(page_id);
+  if (dirty_page == dirty_page_table_.end() || log_record.lsn_ < dirty_page->second) {
+    return;
+  }
+
+  auto guard = buffer_pool_manager_->FetchPageWrite(page_id);
+  // A page that was never written back reads as zeros, that is with LSN 0, which hides the first record of the log.
+  // That record can only be the NEWPAGE creating the page, and redoing a NEWPAGE twice is harmless.
+  lsn_t page_lsn = guard.As<TablePage>()->GetLSN();
+  bool idempotent = log_record.log_record_type_ == LogRecordType::NEWPAGE;
+  if (page_lsn > log_record.lsn_ || (page_lsn == log_record.lsn_ && !idempotent)) {
+    return;
+  }
+
+  auto page = guard.AsMut<TablePage>();
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT: {
+      const RID &rid = log_record.insert_rid_;
+      auto slot = page->InsertTuple(TupleMeta{log_record.txn_id_, INVALID_TXN_ID, false}, log_record.insert_tuple_);
+      if (!slot.has_value() || *slot != rid.GetSlotNum()) {
+        LOG_WARN("redo of LSN %d did not insert tuple %s", log_record.lsn_, rid.ToString().c_str());
+      }
+      break;
+    }
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE: {
+      const RID &rid = log_record.delete_rid_;
+      if (rid.GetSlotNum() >= page->GetNumTuples()) {
+        LOG_WARN("redo of LSN %d refers to a missing tuple %s", log_record.lsn_, rid.ToString().c_str());
+        return;
+      }
+      auto meta = page->GetTupleMeta(rid);
+      meta.is_deleted_ = log_record.log_record_type_ != LogRecordType::ROLLBACKDELETE;
+      page->UpdateTupleMeta(meta, rid);
+      break;
+    }
+    case LogRecordType::UPDATE: {
+      const RID &rid = log_record.update_rid_;
+      if (rid.GetSlotNum() >= page->GetNumTuples()) {
+        LOG_WARN("redo of LSN %d refers to a missing tuple %s", log_record.lsn_, rid.ToString().c_str());
+        return;
+      }
+      auto [meta, tuple] = page->GetTuple(rid);
+      if (!log_record.ApplyUpdate(&tuple, true)) {
+        LOG_WARN("redo of LSN %d does not fit tuple %s", log_record.lsn_, rid.ToString().c_str());
+        return;
+      }
+      page->UpdateTupleInPlaceUnsafe(meta, tuple, rid);
+      break;
+    }
+    case LogRecordType::NEWPAGE:
+      if (page_id == log_record.page_id_) {
+        page->Init();
+      } else {
+        page->SetNextPageId(log_record.page_id_);
+      }
+      break;
+    default:
+      return;
+  }
+  guard.SetLSN(log_record.lsn_);
+}
+
+void LogRecovery::Undo() {
+  if (!analyzed_) {
+    Analyze();
+  }
+
+  // Undo the records of all losers together, newest first, as each one leads to the previous record of its transaction.
+  std::priority_queue<lsn_t> to_undo;
+  for (const auto &[txn_id, lsn] : active_txn_) {
+    to_undo.push(lsn);
+  }
+  while (!to_undo.empty()) {
+    lsn_t lsn = to_undo.top();
+    to_undo.pop();
+    auto offset = lsn_mapping_.find(lsn);
+    LogRecord log_record;
+    if (offset == lsn_mapping_.end() || !LogReader(disk_manager_, offset->second, UNDO_READ_SIZE).Next(&log_record)) {
+      LOG_WARN("cannot read log record %d to undo", lsn);
+      continue;
+    }
+    UndoRecord(log_record);
+    if (log_record.prev_lsn_ != INVALID_LSN) {
+      to_undo.push(log_record.prev_lsn_);
+    }
+  }
+
+  // The undone pages must be on disk before the ABORT records are, or the next recovery would not undo them again.
+  buffer_pool_manager_->FlushAllPages();
+  if (log_manager_ != nullptr) {
+    lsn_t last_lsn = INVALID_LSN;
+    for (const auto &[txn_id, lsn] : active_txn_) {
+      LogRecord abort(txn_id, lsn, LogRecordType::ABORT);
+      last_lsn = log_manager_->AppendLogRecord(&abort);
+    }
+    log_manager_->Flush(last_lsn);
+  }
+  active_txn_.clear();
+}
+
+void LogRecovery::UndoRecord(const LogRecord &log_record) {
+  RID rid;
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+      rid = log_record.insert_rid_;
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      rid = log_record.delete_rid_;
+      break;
+    case LogRecordType::UPDATE:
+      rid = log_record.update_rid_;
+      break;
+    default:
+      // A new page stays in the table, empty.
+      return;
+  }
+
+  auto guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  auto page = guard.AsMut<TablePage>();
+  if (rid.GetSlotNum() >= page->GetNumTuples()) {
+    LOG_WARN("undo of LSN %d refers to a missing tuple %s", log_record.lsn_, rid.ToString().c_str());
+    return;
+  }
+  auto [meta, tuple] = page->GetTuple(rid);
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+    case LogRecordType::ROLLBACKDELETE:
+      meta.is_deleted_ = true;
+      page->UpdateTupleMeta(meta, rid);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+      meta.is_deleted_ = false;
+      page->UpdateTupleMeta(meta, rid);
+      break;
+    default:
+      if (!log_record.ApplyUpdate(&tuple, false)) {
+        LOG_WARN("undo of LSN %d does not fit tuple %s", log_record.lsn_, rid.ToString().c_str());
+        return;
+      }
+      page->UpdateTupleInPlaceUnsafe(meta, tuple, rid);
+      break;
+  }
+}
+
+}  // namespace bustub
@@ -10,16 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <cassert>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -31,23 +35,9 @@ static char *buffer_used;
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
-  std::string::size_type n = file_name_.rfind('.');
-  if (n == std::string::npos) {
-    LOG_DEBUG("wrong file format");
+  if (!OpenLogFile()) {
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
-
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
 
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
@@ -61,8 +51,11 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
   buffer_used = nullptr;
+  OpenFreePageMap();
 }
 
+DiskManager::~DiskManager() = default;
+
 /**
  * Close all file streams
  */
@@ -71,7 +64,8 @@ void DiskManager::ShutDown() {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
   }
-  log_io_.close();
+  log_file_.reset();
+  free_page_map_->Flush();
 }
 
 /**
@@ -122,6 +116,26 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Write a batch of pages, one at a time
+ */
+void DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  BUSTUB_ASSERT(page_ids.size() == page_data.size(), "one buffer per page");
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    WritePage(page_ids[i], page_data[i]);
+  }
+}
+
+/**
+ * Read a batch of pages, one at a time
+ */
+void DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  BUSTUB_ASSERT(page_ids.size() == page_data.size(), "one buffer per page");
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ReadPage(page_ids[i], page_data[i]);
+  }
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -143,45 +157,40 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  // sequence write, synced so that the records survive a crash once this returns
+  if (log_file_ != nullptr) {
+    log_file_->Write(log_data, size);
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
   flush_log_ = false;
 }
 
 /**
  * Read the contents of the log into the given memory area
- * Always read from the beginning and perform sequence read
+ * Reading past the end of the log gives zeros
  * @return: false means already reach the end
  */
-auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
-  if (offset >= GetFileSize(log_name_)) {
-    // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
-    return false;
-  }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
+auto DiskManager::ReadLog(char *log_data, int size, size_t offset) -> bool {
+  return log_file_ != nullptr && log_file_->Read(log_data, size, offset);
+}
 
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+auto DiskManager::GetLogStart() -> size_t { return log_file_ == nullptr ? 0 : log_file_->GetStart(); }
+
+auto DiskManager::GetLogEnd() -> size_t { return log_file_ == nullptr ? 0 : log_file_->GetEnd(); }
+
+void DiskManager::SetLogEnd(size_t offset) {
+  if (log_file_ != nullptr) {
+    log_file_->SetEnd(offset);
   }
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+}
+
+void DiskManager::TruncateLog(size_t offset) {
+  if (log_file_ != nullptr) {
+    log_file_->Truncate(offset);
   }
+}
 
-  return true;
+auto DiskManager::GetLogSegmentSize() -> size_t {
+  return log_file_ == nullptr ? log_segment_size : log_file_->GetSegmentSize();
 }
 
 /**
@@ -199,6 +208,49 @@ auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
  */
 auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 
+/**
+ * Private helper function to open the log file next to the db file
+ */
+auto DiskManager::OpenLogFile() -> bool {
+  std::string::size_type n = file_name_.rfind('.');
+  if (n == std::string::npos) {
+    LOG_DEBUG("wrong file format");
+    return false;
+  }
+  log_name_ = file_name_.substr(0, n) + ".log";
+  log_file_ = std::make_unique<LogFile>(log_name_);
+  return true;
+}
+
+/**
+ * Private helper function to open the free page map next to the db file
+ */
+void DiskManager::OpenFreePageMap() {
+  std::string::size_type n = file_name_.rfind('.');
+  int db_size = GetFileSize(file_name_);
+  free_page_map_ = std::make_unique<FreePageMap>(file_name_.substr(0, n) + ".fsm",
+                                                 db_size > 0 ? static_cast<page_id_t>(db_size / BUSTUB_PAGE_SIZE) : 0);
+}
+
+/**
+ * Drop trailing free pages from the free page map and truncate the db file to match
+ */
+auto DiskManager::Compact() -> page_id_t {
+  page_id_t num_pages = free_page_map_->Compact();
+  if (file_name_.empty()) {
+    return num_pages;
+  }
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  auto size = static_cast<off_t>(num_pages) * BUSTUB_PAGE_SIZE;
+  if (GetFileSize(file_name_) > size) {
+    db_io_.flush();
+    if (truncate(file_name_.c_str(), size) != 0) {
+      LOG_WARN("failed to truncate %s", file_name_.c_str());
+    }
+  }
+  return num_pages;
+}
+
 /**
  * Private helper function to get disk file size
  */
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file, size_t max_size)
+    : DiskManagerPosix(db_file), max_size_(max_size / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE) {
+  if (db_fd_ < 0) {
+    return;
+  }
+  // Reserve the whole range without backing it, so that the mapping can grow in place. One page more lets us align the
+  // views to BUSTUB_PAGE_SIZE when it is larger than the OS page.
+  reservation_size_ = max_size_ + BUSTUB_PAGE_SIZE;
+  void *reservation = mmap(nullptr, reservation_size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (reservation == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot reserve address space to map the db file");
+  }
+  reservation_ = static_cast<char *>(reservation);
+  auto misalignment = reinterpret_cast<uintptr_t>(reservation_) % BUSTUB_PAGE_SIZE;
+  map_ = misalignment == 0 ? reservation_ : reservation_ + (BUSTUB_PAGE_SIZE - misalignment);
+
+  std::scoped_lock map_latch(map_latch_);
+  ExtendMapping(0);
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  if (reservation_ != nullptr) {
+    munmap(reservation_, reservation_size_);
+  }
+}
+
+auto DiskManagerMmap::GetPageView(page_id_t page_id) -> char * {
+  if (page_id < 0 || map_ == nullptr) {
+    return nullptr;
+  }
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (offset + BUSTUB_PAGE_SIZE > mapped_size_.load(std::memory_order_acquire)) {
+    // The file may have grown since we last looked.
+    std::scoped_lock map_latch(map_latch_);
+    if (!ExtendMapping(offset + BUSTUB_PAGE_SIZE)) {
+      return nullptr;
+    }
+  }
+  return map_ + offset;
+}
+
+void DiskManagerMmap::ReleasePageView(page_id_t page_id) {
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (page_id < 0 || offset + BUSTUB_PAGE_SIZE > mapped_size_.load(std::memory_order_acquire)) {
+    return;
+  }
+  // On a private file mapping, this throws away our copy of the page; the next access reads the file again.
+  if (madvise(map_ + offset, BUSTUB_PAGE_SIZE, MADV_DONTNEED) != 0) {
+    LOG_WARN("failed to drop the private copy of page %d (%s)", page_id, strerror(errno));
+  }
+}
+
+auto DiskManagerMmap::Compact() -> page_id_t {
+  page_id_t num_pages = DiskManagerPosix::Compact();
+  std::scoped_lock map_latch(map_latch_);
+  size_t size = file_size_.load() / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE;
+  size_t mapped_size = mapped_size_.load();
+  if (map_ != nullptr && size < mapped_size) {
+    // Touching the truncated pages would raise SIGBUS, put the reservation back in their place.
+    void *tail = mmap(map_ + size, mapped_size - size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    if (tail == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot unmap the truncated part of the db file");
+    }
+    mapped_size_ = size;
+  }
+  return num_pages;
+}
+
+auto DiskManagerMmap::ExtendMapping(size_t end) -> bool {
+  size_t mapped_size = mapped_size_.load();
+  if (end != 0 && end <= mapped_size) {
+    return true;
+  }
+  if (db_fd_ < 0) {
+    return false;
+  }
+  // Only map whole pages that are in the file: accessing a mapping past the end of the file raises SIGBUS.
+  size_t size = std::min(file_size_.load() / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE, max_size_);
+  if (size > mapped_size) {
+    void *data = mmap(map_ + mapped_size, size - mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, db_fd_,
+                      static_cast<off_t>(mapped_size));
+    if (data == MAP_FAILED) {
+      LOG_WARN("failed to map %s (%s)", file_name_.c_str(), strerror(errno));
+      return false;
+    }
+    mapped_size_.store(size, std::memory_order_release);
+  }
+  return end <= size;
+}
+
+}  // namespace bustub
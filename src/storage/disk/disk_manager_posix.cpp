@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.cpp
+//
+// Identification: src/storage/disk/disk_manager_posix.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/disk/disk_manager_posix.h"
+
+namespace bustub {
+
+DiskManagerPosix::DiskManagerPosix(const std::string &db_file, bool direct_io) {
+  file_name_ = db_file;
+  if (!OpenLogFile()) {
+    return;
+  }
+
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    if (db_fd_ >= 0) {
+      direct_io_ = true;
+    } else if (errno == EINVAL) {
+      // the file system (e.g. tmpfs) does not support O_DIRECT, use the page cache instead
+      LOG_WARN("O_DIRECT is not supported for %s, falling back to buffered I/O", db_file.c_str());
+    }
+  }
+#endif
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    file_size_ = static_cast<size_t>(stat_buf.st_size);
+  }
+  OpenFreePageMap();
+}
+
+DiskManagerPosix::~DiskManagerPosix() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+}
+
+void DiskManagerPosix::ShutDown() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  DiskManager::ShutDown();
+}
+
+auto DiskManagerPosix::Compact() -> page_id_t {
+  page_id_t num_pages = free_page_map_->Compact();
+  size_t size = static_cast<size_t>(num_pages) * BUSTUB_PAGE_SIZE;
+  if (file_size_ > size) {
+    if (ftruncate(db_fd_, static_cast<off_t>(size)) != 0) {
+      LOG_WARN("failed to truncate %s", file_name_.c_str());
+      return num_pages;
+    }
+    file_size_ = size;
+  }
+  return num_pages;
+}
+
+void DiskManagerPosix::WritePage(page_id_t page_id, const char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  const char *buf = page_data;
+  if (direct_io_ && !IsAligned(page_data)) {
+    char *scratch = ScratchPage();
+    memcpy(scratch, page_data, BUSTUB_PAGE_SIZE);
+    buf = scratch;
+  }
+
+  num_writes_ += 1;
+  size_t written = 0;
+  while (written < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pwrite(db_fd_, buf + written, BUSTUB_PAGE_SIZE - written, offset + written);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += rc;
+  }
+
+  // extend the cached file size if the page was appended
+  ExtendFileSize(offset + BUSTUB_PAGE_SIZE);
+}
+
+void DiskManagerPosix::ReadPage(page_id_t page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  // check if read beyond file length
+  if (offset >= file_size_.load()) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+
+  char *buf = direct_io_ && !IsAligned(page_data) ? ScratchPage() : page_data;
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pread(db_fd_, buf + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      break;
+    }
+    if (rc == 0) {
+      // if file ends before reading BUSTUB_PAGE_SIZE
+      LOG_DEBUG("Read less than a page");
+      break;
+    }
+    read_count += rc;
+  }
+  memset(buf + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  if (buf != page_data) {
+    memcpy(page_data, buf, BUSTUB_PAGE_SIZE);
+  }
+}
+
+auto DiskManagerPosix::ScratchPage() -> char * {
+  struct AlignedDeleter {
+    void operator()(char *p) const { std::free(p); }  // NOLINT
+  };
+  thread_local std::unique_ptr<char, AlignedDeleter> scratch{
+      static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE))};
+  return scratch.get();
+}
+
+}  // namespace bustub
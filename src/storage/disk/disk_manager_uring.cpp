@@ -0,0 +1,285 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.cpp
+//
+// Identification: src/storage/disk/disk_manager_uring.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_uring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BUSTUB_HAS_IO_URING 1
+#endif
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file, bool direct_io, uint32_t queue_depth)
+    : DiskManagerPosix(db_file, direct_io) {
+  if (db_fd_ >= 0) {
+    SetUpRing(queue_depth);
+  }
+}
+
+DiskManagerUring::~DiskManagerUring() { TearDownRing(); }
+
+void DiskManagerUring::ShutDown() {
+  {
+    std::scoped_lock ring_latch(ring_latch_);
+    TearDownRing();
+  }
+  DiskManagerPosix::ShutDown();
+}
+
+void DiskManagerUring::WritePage(page_id_t page_id, const char *page_data) {
+  // the buffer is only read by the kernel, the cast just lets reads and writes share the batch path
+  WritePages({page_id}, {const_cast<char *>(page_data)});  // NOLINT
+}
+
+void DiskManagerUring::ReadPage(page_id_t page_id, char *page_data) { ReadPages({page_id}, {page_data}); }
+
+void DiskManagerUring::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  BUSTUB_ASSERT(page_ids.size() == page_data.size(), "one buffer per page");
+  if (!IsUringEnabled()) {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      DiskManagerPosix::WritePage(page_ids[i], page_data[i]);
+    }
+    return;
+  }
+  SubmitAndWait(true, page_ids, page_data);
+}
+
+void DiskManagerUring::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  BUSTUB_ASSERT(page_ids.size() == page_data.size(), "one buffer per page");
+  if (!IsUringEnabled()) {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      DiskManagerPosix::ReadPage(page_ids[i], page_data[i]);
+    }
+    return;
+  }
+  SubmitAndWait(false, page_ids, page_data);
+}
+
+#ifdef BUSTUB_HAS_IO_URING
+
+void DiskManagerUring::SetUpRing(uint32_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+  if (fd < 0) {
+    LOG_WARN("io_uring is not available (%s), falling back to pread / pwrite", strerror(errno));
+    return;
+  }
+
+  sq_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+  sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  cq_ptr_ = single_mmap ? sq_ptr_
+                        : mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                               IORING_OFF_CQ_RING);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  ring_fd_ = fd;
+  if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes == MAP_FAILED) {
+    LOG_WARN("failed to map the io_uring queues, falling back to pread / pwrite");
+    sq_ptr_ = sq_ptr_ == MAP_FAILED ? nullptr : sq_ptr_;
+    cq_ptr_ = cq_ptr_ == MAP_FAILED ? nullptr : cq_ptr_;
+    sqes_ = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe *>(sqes);
+    TearDownRing();
+    return;
+  }
+
+  auto *sq = static_cast<char *>(sq_ptr_);
+  sq_head_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+  sq_entries_ = params.sq_entries;
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *cq = static_cast<char *>(cq_ptr_);
+  cq_head_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+}
+
+void DiskManagerUring::TearDownRing() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+    munmap(cq_ptr_, cq_size_);
+  }
+  cq_ptr_ = nullptr;
+  if (sq_ptr_ != nullptr) {
+    munmap(sq_ptr_, sq_size_);
+    sq_ptr_ = nullptr;
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+}
+
+void DiskManagerUring::SubmitAndWait(bool is_write, const std::vector<page_id_t> &page_ids,
+                                     const std::vector<char *> &page_data) {
+  // requests that cannot go through the ring, finished with pread / pwrite at the end of their round
+  std::vector<size_t> fallback;
+  std::vector<size_t> batch;
+  std::unordered_set<page_id_t> in_round;
+  batch.reserve(std::min<size_t>(page_ids.size(), sq_entries_));
+  // A later round may touch the same pages again, so a round is only over once its fallbacks are done too.
+  auto finish_fallback = [&]() {
+    std::sort(fallback.begin(), fallback.end());
+    fallback.erase(std::unique(fallback.begin(), fallback.end()), fallback.end());
+    for (auto i : fallback) {
+      if (is_write) {
+        DiskManagerPosix::WritePage(page_ids[i], page_data[i]);
+      } else {
+        DiskManagerPosix::ReadPage(page_ids[i], page_data[i]);
+      }
+    }
+    fallback.clear();
+  };
+
+  std::scoped_lock ring_latch(ring_latch_);
+  size_t next = 0;
+  if (ring_fd_ < 0) {
+    for (; next < page_ids.size(); next++) {
+      fallback.push_back(next);
+    }
+  }
+  while (next < page_ids.size()) {
+    // fill the submission ring, at most sq_entries_ requests per round
+    batch.clear();
+    in_round.clear();
+    uint32_t tail = *sq_tail_;
+    for (; next < page_ids.size() && batch.size() < sq_entries_; next++) {
+      // requests in one round may complete in any order, so a page that shows up again starts a new round
+      if (!in_round.insert(page_ids[next]).second) {
+        break;
+      }
+      size_t offset = static_cast<size_t>(page_ids[next]) * BUSTUB_PAGE_SIZE;
+      if (!is_write && offset >= file_size_.load()) {
+        // reading past the end of the file
+        memset(page_data[next], 0, BUSTUB_PAGE_SIZE);
+        continue;
+      }
+      if (direct_io_ && !IsAligned(page_data[next])) {
+        fallback.push_back(next);
+        continue;
+      }
+      uint32_t index = tail & *sq_mask_;
+      io_uring_sqe *sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = is_write ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->fd = db_fd_;
+      sqe->addr = reinterpret_cast<uint64_t>(page_data[next]);
+      sqe->len = BUSTUB_PAGE_SIZE;
+      sqe->off = offset;
+      sqe->user_data = next;
+      sq_array_[index] = index;
+      tail++;
+      batch.push_back(next);
+    }
+    if (batch.empty()) {
+      finish_fallback();
+      continue;
+    }
+    // publish the new entries before the kernel sees the tail
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    // submit the whole round with one syscall and wait for all completions
+    auto to_submit = static_cast<uint32_t>(batch.size());
+    size_t completed = 0;
+    while (completed < batch.size()) {
+      auto wait_nr = static_cast<uint32_t>(batch.size() - completed);
+      int rc = static_cast<int>(
+          syscall(__NR_io_uring_enter, ring_fd_.load(), to_submit, wait_nr, IORING_ENTER_GETEVENTS, nullptr, 0));
+      if (rc < 0 && errno != EINTR) {
+        LOG_WARN("io_uring_enter failed (%s)", strerror(errno));
+        break;
+      }
+      if (rc > 0) {
+        to_submit -= std::min<uint32_t>(to_submit, rc);
+      }
+
+      uint32_t head = __atomic_load_n(cq_head_, __ATOMIC_ACQUIRE);
+      uint32_t cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != cq_tail; head++) {
+        io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+        auto i = static_cast<size_t>(cqe->user_data);
+        if (cqe->res == BUSTUB_PAGE_SIZE) {
+          if (is_write) {
+            num_writes_ += 1;
+            ExtendFileSize(static_cast<size_t>(page_ids[i]) * BUSTUB_PAGE_SIZE + BUSTUB_PAGE_SIZE);
+          }
+        } else {
+          // error or short transfer (e.g. the page straddles the end of the file)
+          fallback.push_back(i);
+        }
+        completed++;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+    if (completed < batch.size()) {
+      // the ring is broken, stop using it and finish everything that is left with pread / pwrite
+      TearDownRing();
+      fallback.insert(fallback.end(), batch.begin(), batch.end());
+      for (; next < page_ids.size(); next++) {
+        fallback.push_back(next);
+      }
+      break;
+    }
+    finish_fallback();
+  }
+  finish_fallback();
+}
+
+#else
+
+void DiskManagerUring::SetUpRing([[maybe_unused]] uint32_t queue_depth) {
+  LOG_WARN("built without io_uring support, falling back to pread / pwrite");
+}
+
+void DiskManagerUring::TearDownRing() {}
+
+void DiskManagerUring::SubmitAndWait(bool is_write, const std::vector<page_id_t> &page_ids,
+                                     const std::vector<char *> &page_data) {
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (is_write) {
+      DiskManagerPosix::WritePage(page_ids[i], page_data[i]);
+    } else {
+      DiskManagerPosix::ReadPage(page_ids[i], page_data[i]);
+    }
+  }
+}
+
+#endif
+
+}  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers) : disk_manager_(disk_manager) {
+  BUSTUB_ENSURE(num_workers > 0, "disk scheduler needs at least one worker");
+  request_queues_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; i++) {
+    request_queues_.emplace_back(std::make_unique<RequestQueue>());
+  }
+  workers_.reserve(num_workers);
+  for (auto &queue : request_queues_) {
+    workers_.emplace_back([this, queue = queue.get()] { StartWorkerThread(queue); });
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  // Put a `std::nullopt` in every queue to signal the workers to exit once the pending requests are done.
+  for (auto &queue : request_queues_) {
+    queue->Put(std::nullopt);
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  std::vector<DiskRequest> batch;
+  batch.emplace_back(std::move(r));
+  QueueOf(batch.front().page_id_)->Put(std::move(batch));
+}
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> requests) {
+  if (request_queues_.size() == 1) {
+    request_queues_.front()->Put(std::move(requests));
+    return;
+  }
+  std::unordered_map<RequestQueue *, std::vector<DiskRequest>> batches;
+  for (auto &r : requests) {
+    batches[QueueOf(r.page_id_)].emplace_back(std::move(r));
+  }
+  for (auto &[queue, batch] : batches) {
+    queue->Put(std::move(batch));
+  }
+}
+
+void DiskScheduler::StartWorkerThread(RequestQueue *queue) {
+  while (true) {
+    auto batch = queue->Get();
+    if (!batch.has_value()) {
+      return;
+    }
+    // Hand each run of reads or writes to the disk manager as one batch, so that backends which can keep several
+    // requests in flight do so. Requests still complete in submission order.
+    std::vector<page_id_t> page_ids;
+    std::vector<char *> page_data;
+    for (size_t begin = 0, end = 0; begin < batch->size(); begin = end) {
+      bool is_write = (*batch)[begin].is_write_;
+      page_ids.clear();
+      page_data.clear();
+      for (end = begin; end < batch->size() && (*batch)[end].is_write_ == is_write; end++) {
+        page_ids.push_back((*batch)[end].page_id_);
+        page_data.push_back((*batch)[end].data_);
+      }
+      if (is_write) {
+        disk_manager_->WritePages(page_ids, page_data);
+      } else {
+        disk_manager_->ReadPages(page_ids, page_data);
+      }
+      for (size_t i = begin; i < end; i++) {
+        (*batch)[i].callback_.set_value(true);
+      }
+    }
+  }
+}
+
+auto DiskScheduler::QueueOf(page_id_t page_id) -> RequestQueue * {
+  return request_queues_[static_cast<size_t>(page_id) % request_queues_.size()].get();
+}
+
+}  // namespace bustub
@@ -0,0 +1,341 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/storage/disk/free_page_map.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** Layout of page 0 of the map file. */
+struct FreePageMapHeader {
+  uint32_t magic_;
+  page_id_t num_pages_;
+};
+
+/** Read size bytes at offset, retrying short reads. Returns false on error or end of file. */
+auto ReadAll(int fd, char *buf, size_t size, size_t offset) -> bool {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pread(fd, buf + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      return false;
+    }
+    done += rc;
+  }
+  return true;
+}
+
+/** Write size bytes at offset, retrying short writes. Returns false on error. */
+auto WriteAll(int fd, const char *buf, size_t size, size_t offset) -> bool {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pwrite(fd, buf + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      return false;
+    }
+    done += rc;
+  }
+  return true;
+}
+
+}  // namespace
+
+FreePageMap::FreePageMap(const std::string &file_name, page_id_t num_db_pages) {
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw Exception("can't open free page map file");
+  }
+  Load(num_db_pages);
+}
+
+FreePageMap::~FreePageMap() {
+  if (fd_ >= 0) {
+    Flush();
+    close(fd_);
+  }
+}
+
+void FreePageMap::Load(page_id_t num_db_pages) {
+  FreePageMapHeader header{};
+  bool valid = num_db_pages > 0 && ReadAll(fd_, reinterpret_cast<char *>(&header), sizeof(header), 0) &&
+               header.magic_ == MAGIC && header.num_pages_ >= 0;
+  if (!valid) {
+    // A fresh database, or one written before free pages were tracked: all of its pages are in use.
+    num_pages_ = std::max(num_db_pages, 0);
+    Resize(num_pages_);
+    if (ftruncate(fd_, 0) != 0) {
+      LOG_WARN("failed to truncate the free page map");
+    }
+    for (size_t i = 0; i < bits_.size() / WORDS_PER_PAGE; i++) {
+      WriteBitmapPage(i);
+    }
+    WriteHeader();
+    return;
+  }
+
+  num_pages_ = std::max(header.num_pages_, num_db_pages);
+  Resize(num_pages_);
+  // Bitmap pages past the end of the file (or past the pages recorded in the header) have no free page.
+  size_t map_pages = (static_cast<size_t>(header.num_pages_) + BITS_PER_PAGE - 1) / BITS_PER_PAGE;
+  for (size_t i = 0; i < map_pages; i++) {
+    if (!ReadAll(fd_, reinterpret_cast<char *>(&bits_[i * WORDS_PER_PAGE]), BUSTUB_PAGE_SIZE,
+                 (i + 1) * BUSTUB_PAGE_SIZE)) {
+      std::fill(bits_.begin() + i * WORDS_PER_PAGE, bits_.begin() + (i + 1) * WORDS_PER_PAGE, 0);
+    }
+  }
+  // Ignore any bit beyond the recorded pages, e.g. left over from an interrupted compaction.
+  for (page_id_t page_id = header.num_pages_; page_id < static_cast<page_id_t>(map_pages * BITS_PER_PAGE);
+       page_id++) {
+    bits_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+  }
+  for (auto word : bits_) {
+    num_free_ += __builtin_popcountll(word);
+  }
+}
+
+auto FreePageMap::AllocatePage(page_id_t offset, page_id_t stride) -> page_id_t {
+  BUSTUB_ASSERT(stride > 0 && offset >= 0 && offset < stride, "invalid page id offset");
+  std::unique_lock<std::mutex> lock(latch_);
+  if (num_free_ > 0) {
+    while (first_free_word_ < bits_.size() && bits_[first_free_word_] == 0) {
+      first_free_word_++;
+    }
+    for (size_t word = first_free_word_; word < bits_.size(); word++) {
+      for (uint64_t bits = bits_[word]; bits != 0; bits &= bits - 1) {
+        auto page_id = static_cast<page_id_t>(word * 64 + __builtin_ctzll(bits));
+        if (page_id % stride == offset) {
+          SetFree(page_id, false);
+          lock.unlock();
+          // The page may hold data of its own soon, it must not be free on disk anymore if we crash after that.
+          PersistBitmapPage(word / WORDS_PER_PAGE);
+          return page_id;
+        }
+      }
+    }
+  }
+
+  // Grow the file by the next page id of the right residue.
+  page_id_t page_id = num_pages_ + (offset - num_pages_ % stride + stride) % stride;
+  page_id_t old_num_pages = num_pages_;
+  num_pages_ = page_id + 1;
+  Resize(num_pages_);
+  for (page_id_t skipped = old_num_pages; skipped < page_id; skipped++) {
+    SetFree(skipped, true);
+  }
+  return page_id;
+}
+
+void FreePageMap::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  if (page_id < 0 || page_id >= num_pages_) {
+    LOG_WARN("deallocating page %d which was never allocated", page_id);
+    return;
+  }
+  if ((bits_[page_id / 64] >> (page_id % 64) & 1) != 0) {
+    LOG_WARN("page %d is already deallocated", page_id);
+    return;
+  }
+  SetFree(page_id, true);
+}
+
+void FreePageMap::MarkAllocated(page_id_t page_id) {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  std::scoped_lock lock(latch_);
+  if (page_id >= num_pages_) {
+    page_id_t old_num_pages = num_pages_;
+    num_pages_ = page_id + 1;
+    Resize(num_pages_);
+    for (page_id_t skipped = old_num_pages; skipped < page_id; skipped++) {
+      SetFree(skipped, true);
+    }
+    return;
+  }
+  if ((bits_[page_id / 64] >> (page_id % 64) & 1) != 0) {
+    SetFree(page_id, false);
+  }
+}
+
+auto FreePageMap::IsFree(page_id_t page_id) -> bool {
+  std::scoped_lock lock(latch_);
+  if (page_id < 0 || page_id >= num_pages_) {
+    return false;
+  }
+  return (bits_[page_id / 64] >> (page_id % 64) & 1) != 0;
+}
+
+auto FreePageMap::GetNumPages() -> page_id_t {
+  std::scoped_lock lock(latch_);
+  return num_pages_;
+}
+
+auto FreePageMap::GetNumFreePages() -> size_t {
+  std::scoped_lock lock(latch_);
+  return num_free_;
+}
+
+void FreePageMap::Flush() {
+  std::scoped_lock flush_lock(flush_latch_);
+  if (fd_ < 0) {
+    return;
+  }
+  // Copy the changed pages under the latch and write them without it, allocations go on meanwhile.
+  std::vector<std::pair<size_t, std::vector<uint64_t>>> pages;
+  FreePageMapHeader header{MAGIC, 0};
+  {
+    std::scoped_lock lock(latch_);
+    for (size_t i = 0; i < dirty_pages_.size(); i++) {
+      if (dirty_pages_[i]) {
+        pages.emplace_back(i, std::vector<uint64_t>(bits_.begin() + i * WORDS_PER_PAGE,
+                                                    bits_.begin() + (i + 1) * WORDS_PER_PAGE));
+        dirty_pages_[i] = false;
+      }
+    }
+    header.num_pages_ = num_pages_;
+  }
+  for (auto &[bitmap_page, words] : pages) {
+    if (!WriteAll(fd_, reinterpret_cast<const char *>(words.data()), BUSTUB_PAGE_SIZE,
+                  (bitmap_page + 1) * BUSTUB_PAGE_SIZE)) {
+      LOG_DEBUG("I/O error while writing the free page map");
+    }
+  }
+  char page[BUSTUB_PAGE_SIZE]{};
+  memcpy(page, &header, sizeof(header));
+  if (!WriteAll(fd_, page, BUSTUB_PAGE_SIZE, 0)) {
+    LOG_DEBUG("I/O error while writing the free page map header");
+  }
+  if (fsync(fd_) != 0) {
+    LOG_WARN("failed to sync the free page map");
+  }
+}
+
+void FreePageMap::PersistBitmapPage(size_t bitmap_page) {
+  std::scoped_lock flush_lock(flush_latch_);
+  if (fd_ < 0) {
+    return;
+  }
+  // Copy the page under flush_latch_, so that a copy taken before it cannot be written after it.
+  std::vector<uint64_t> words;
+  {
+    std::scoped_lock lock(latch_);
+    if (!dirty_pages_[bitmap_page]) {
+      // Written by a Flush() since the change.
+      return;
+    }
+    words.assign(bits_.begin() + bitmap_page * WORDS_PER_PAGE, bits_.begin() + (bitmap_page + 1) * WORDS_PER_PAGE);
+    dirty_pages_[bitmap_page] = false;
+  }
+  if (!WriteAll(fd_, reinterpret_cast<const char *>(words.data()), BUSTUB_PAGE_SIZE,
+                (bitmap_page + 1) * BUSTUB_PAGE_SIZE)) {
+    LOG_DEBUG("I/O error while writing the free page map");
+  }
+  if (fsync(fd_) != 0) {
+    LOG_WARN("failed to sync the free page map");
+  }
+}
+
+auto FreePageMap::Compact() -> page_id_t {
+  std::scoped_lock flush_lock(flush_latch_);
+  std::scoped_lock lock(latch_);
+  page_id_t num_pages = num_pages_;
+  while (num_pages > 0 && (bits_[(num_pages - 1) / 64] >> ((num_pages - 1) % 64) & 1) != 0) {
+    num_pages--;
+  }
+  if (num_pages == num_pages_) {
+    return num_pages_;
+  }
+  // Record the smaller size before dropping the bits: if we crash in between, the stale bits are ignored on load.
+  page_id_t old_num_pages = num_pages_;
+  num_pages_ = num_pages;
+  WriteHeader();
+  for (page_id_t page_id = num_pages; page_id < old_num_pages; page_id++) {
+    bits_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+  }
+  num_free_ -= old_num_pages - num_pages;
+  Resize(num_pages_);
+  if (fd_ >= 0) {
+    size_t map_pages = bits_.size() / WORDS_PER_PAGE;
+    for (size_t i = 0; i < map_pages; i++) {
+      if (dirty_pages_[i] || i == map_pages - 1) {
+        WriteBitmapPage(i);
+        dirty_pages_[i] = false;
+      }
+    }
+    if (ftruncate(fd_, static_cast<off_t>((map_pages + 1) * BUSTUB_PAGE_SIZE)) != 0) {
+      LOG_WARN("failed to truncate the free page map");
+    }
+  }
+  return num_pages_;
+}
+
+void FreePageMap::SetFree(page_id_t page_id, bool is_free) {
+  size_t word = page_id / 64;
+  uint64_t mask = uint64_t{1} << (page_id % 64);
+  if (is_free) {
+    bits_[word] |= mask;
+    num_free_++;
+    first_free_word_ = std::min(first_free_word_, word);
+  } else {
+    bits_[word] &= ~mask;
+    num_free_--;
+  }
+  dirty_pages_[word / WORDS_PER_PAGE] = true;
+}
+
+void FreePageMap::Resize(page_id_t num_pages) {
+  size_t map_pages = (static_cast<size_t>(num_pages) + BITS_PER_PAGE - 1) / BITS_PER_PAGE;
+  bits_.resize(map_pages * WORDS_PER_PAGE, 0);
+  dirty_pages_.resize(map_pages, false);
+  first_free_word_ = std::min(first_free_word_, bits_.size());
+}
+
+void FreePageMap::WriteBitmapPage(size_t bitmap_page) {
+  if (fd_ < 0) {
+    return;
+  }
+  if (!WriteAll(fd_, reinterpret_cast<const char *>(&bits_[bitmap_page * WORDS_PER_PAGE]), BUSTUB_PAGE_SIZE,
+                (bitmap_page + 1) * BUSTUB_PAGE_SIZE)) {
+    LOG_DEBUG("I/O error while writing the free page map");
+  }
+}
+
+void FreePageMap::WriteHeader() {
+  if (fd_ < 0) {
+    return;
+  }
+  char page[BUSTUB_PAGE_SIZE]{};
+  FreePageMapHeader header{MAGIC, num_pages_};
+  memcpy(page, &header, sizeof(header));
+  if (!WriteAll(fd_, page, BUSTUB_PAGE_SIZE, 0)) {
+    LOG_DEBUG("I/O error while writing the free page map header");
+  }
+}
+
+}  // namespace bustub
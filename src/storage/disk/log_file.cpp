@@ -0,0 +1,356 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_file.cpp
+//
+// Identification: src/storage/disk/log_file.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/log_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "common/logger.h"
+#include "common/util/crc32c.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+namespace {
+
+/** Layout of the manifest, followed by the CRC32C of these fields. */
+struct LogManifest {
+  uint32_t magic_;
+  uint32_t reserved_;
+  uint64_t segment_size_;
+  uint64_t start_;
+};
+
+/** Read up to size bytes at offset, retrying short reads. Returns the number of bytes read, -1 on error. */
+auto ReadUpTo(int fd, char *buf, size_t size, size_t offset) -> ssize_t {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pread(fd, buf + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      return -1;
+    }
+    if (rc == 0) {
+      break;
+    }
+    done += rc;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+/** Write size bytes at offset, retrying short writes. Returns false on error. */
+auto WriteAll(int fd, const char *buf, size_t size, size_t offset) -> bool {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pwrite(fd, buf + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      return false;
+    }
+    done += rc;
+  }
+  return true;
+}
+
+}  // namespace
+
+LogFile::LogFile(const std::string &file_name) : file_name_(file_name), segment_size_(log_segment_size) {
+  if (!ReadManifest()) {
+    return;
+  }
+  created_ = true;
+  size_t first = start_ / segment_size_;
+  // Segments a truncation did not get to delete before a crash.
+  for (size_t segment = first; segment > 0 && unlink(GetSegmentName(segment - 1).c_str()) == 0; segment--) {
+  }
+  size_t last = first;
+  while (access(GetSegmentName(last).c_str(), F_OK) == 0) {
+    last++;
+  }
+  end_ = std::max(start_, last * segment_size_);
+}
+
+LogFile::~LogFile() {
+  std::scoped_lock lock(latch_);
+  WaitNextSegment();
+  for (const auto &[segment, fd] : segments_) {
+    close(fd);
+  }
+}
+
+void LogFile::Write(const char *data, size_t size) {
+  std::scoped_lock lock(latch_);
+  if (!created_) {
+    WriteManifest(start_);
+    created_ = true;
+  }
+  int last_fd = -1;
+  while (size > 0) {
+    size_t segment = end_ / segment_size_;
+    size_t segment_offset = end_ % segment_size_;
+    size_t length = std::min(size, segment_size_ - segment_offset);
+    int fd = OpenSegment(segment, true);
+    if (fd < 0 || !WriteAll(fd, data, length, segment_offset)) {
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    // A write that crosses into the next segment syncs both.
+    if (last_fd >= 0 && fdatasync(last_fd) != 0) {
+      LOG_DEBUG("I/O error while syncing log");
+    }
+    last_fd = fd;
+    data += length;
+    size -= length;
+    end_ += length;
+  }
+  if (last_fd >= 0 && fdatasync(last_fd) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
+  PrepareNextSegment();
+}
+
+auto LogFile::Read(char *data, size_t size, size_t offset) -> bool {
+  std::scoped_lock lock(latch_);
+  if (offset >= end_) {
+    return false;
+  }
+  size_t readable = std::min(size, end_ - offset);
+  memset(data + readable, 0, size - readable);
+  while (readable > 0) {
+    size_t segment = offset / segment_size_;
+    size_t segment_offset = offset % segment_size_;
+    size_t length = std::min(readable, segment_size_ - segment_offset);
+    // Segments before the start may be deleted any time.
+    int fd = segment < start_ / segment_size_ ? -1 : OpenSegment(segment, false);
+    ssize_t read = fd < 0 ? 0 : ReadUpTo(fd, data, length, segment_offset);
+    if (read < 0) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    memset(data + read, 0, length - read);
+    data += length;
+    offset += length;
+    readable -= length;
+  }
+  return true;
+}
+
+auto LogFile::GetStart() -> size_t {
+  std::scoped_lock lock(latch_);
+  return start_;
+}
+
+auto LogFile::GetEnd() -> size_t {
+  std::scoped_lock lock(latch_);
+  return end_;
+}
+
+void LogFile::SetEnd(size_t offset) {
+  std::scoped_lock lock(latch_);
+  WaitNextSegment();
+  end_ = offset;
+  if (!created_) {
+    return;
+  }
+
+  size_t segment = offset / segment_size_;
+  for (auto it = segments_.upper_bound(segment); it != segments_.end(); it = segments_.erase(it)) {
+    close(it->second);
+  }
+  for (size_t next = segment + 1; unlink(GetSegmentName(next).c_str()) == 0; next++) {
+  }
+  int fd = OpenSegment(segment, true);
+  if (fd >= 0) {
+    // Cut the segment at offset and allocate it again, which zeros what followed.
+    if (ftruncate(fd, static_cast<off_t>(offset % segment_size_)) != 0 ||
+        posix_fallocate(fd, 0, static_cast<off_t>(segment_size_)) != 0) {
+      LOG_WARN("failed to clear the end of %s", GetSegmentName(segment).c_str());
+    }
+    fdatasync(fd);
+  }
+  SyncDirectory();
+  PrepareNextSegment();
+}
+
+void LogFile::Truncate(size_t offset) {
+  std::scoped_lock truncate_lock(truncate_latch_);
+  size_t first;
+  size_t new_first;
+  {
+    std::scoped_lock lock(latch_);
+    if (!created_ || offset <= start_ || offset > end_) {
+      return;
+    }
+    first = start_ / segment_size_;
+    new_first = offset / segment_size_;
+    start_ = offset;
+    if (new_first == first) {
+      // Reading from the old start works as well, no need to write the manifest.
+      return;
+    }
+    for (auto it = segments_.begin(); it != segments_.end() && it->first < new_first; it = segments_.erase(it)) {
+      close(it->second);
+    }
+  }
+
+  // The manifest moves past the segments before they are deleted. A crash in between leaves them behind, for the next
+  // open to delete, but never leaves a manifest whose start is in a deleted segment.
+  WriteManifest(offset);
+  for (size_t segment = first; segment < new_first; segment++) {
+    if (unlink(GetSegmentName(segment).c_str()) != 0) {
+      LOG_WARN("failed to delete %s", GetSegmentName(segment).c_str());
+    }
+  }
+  SyncDirectory();
+}
+
+auto LogFile::GetSegmentName(size_t segment) const -> std::string {
+  return fmt::format("{}.{:06}", file_name_, segment);
+}
+
+void LogFile::Remove(const std::string &file_name) {
+  size_t first;
+  {
+    LogFile log(file_name);
+    first = log.start_ / log.segment_size_;
+    for (size_t segment = first; unlink(log.GetSegmentName(segment).c_str()) == 0; segment++) {
+    }
+  }
+  std::remove(file_name.c_str());
+  std::remove((file_name + ".tmp").c_str());
+}
+
+auto LogFile::ReadManifest() -> bool {
+  int fd = open(file_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  char data[sizeof(LogManifest) + sizeof(uint32_t)];
+  bool complete = ReadUpTo(fd, data, sizeof(data), 0) == static_cast<ssize_t>(sizeof(data));
+  close(fd);
+
+  LogManifest manifest;
+  uint32_t checksum;
+  memcpy(&manifest, data, sizeof(LogManifest));
+  memcpy(&checksum, data + sizeof(LogManifest), sizeof(uint32_t));
+  if (!complete || manifest.magic_ != MAGIC || checksum != Crc32c::Value(data, sizeof(LogManifest)) ||
+      manifest.segment_size_ == 0) {
+    LOG_WARN("ignoring the corrupt log manifest %s", file_name_.c_str());
+    return false;
+  }
+  segment_size_ = manifest.segment_size_;
+  start_ = manifest.start_;
+  return true;
+}
+
+void LogFile::WriteManifest(size_t start) {
+  char data[sizeof(LogManifest) + sizeof(uint32_t)];
+  LogManifest manifest{MAGIC, 0, segment_size_, start};
+  memcpy(data, &manifest, sizeof(LogManifest));
+  uint32_t checksum = Crc32c::Value(data, sizeof(LogManifest));
+  memcpy(data + sizeof(LogManifest), &checksum, sizeof(uint32_t));
+
+  // Write a new manifest next to the old one, and rename it over the old one once it is on disk.
+  std::string tmp_name = file_name_ + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_WARN("failed to create %s", tmp_name.c_str());
+    return;
+  }
+  bool written = WriteAll(fd, data, sizeof(data), 0) && fsync(fd) == 0;
+  close(fd);
+  if (!written || rename(tmp_name.c_str(), file_name_.c_str()) != 0) {
+    LOG_WARN("failed to write the log manifest %s", file_name_.c_str());
+    return;
+  }
+  SyncDirectory();
+}
+
+auto LogFile::OpenSegment(size_t segment, bool create) -> int {
+  if (next_fd_.valid() && next_segment_ == segment) {
+    WaitNextSegment();
+  }
+  auto it = segments_.find(segment);
+  if (it != segments_.end()) {
+    return it->second;
+  }
+  int fd = open(GetSegmentName(segment).c_str(), O_RDWR);
+  if (fd < 0 && create) {
+    fd = CreateSegment(segment);
+  }
+  if (fd >= 0) {
+    segments_.emplace(segment, fd);
+  }
+  return fd;
+}
+
+void LogFile::PrepareNextSegment() {
+  size_t next = end_ / segment_size_ + 1;
+  if (segments_.count(next) != 0 || (next_fd_.valid() && next_segment_ == next)) {
+    return;
+  }
+  WaitNextSegment();
+  next_segment_ = next;
+  next_fd_ = std::async(std::launch::async, [this, next] { return CreateSegment(next); });
+}
+
+void LogFile::WaitNextSegment() {
+  if (!next_fd_.valid()) {
+    return;
+  }
+  int fd = next_fd_.get();
+  if (fd >= 0 && !segments_.emplace(next_segment_, fd).second) {
+    close(fd);
+  }
+}
+
+auto LogFile::CreateSegment(size_t segment) const -> int {
+  std::string name = GetSegmentName(segment);
+  int fd = open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_WARN("failed to create %s", name.c_str());
+    return -1;
+  }
+  if (posix_fallocate(fd, 0, static_cast<off_t>(segment_size_)) != 0) {
+    // Still reads as zeros, only without the blocks reserved up front.
+    LOG_DEBUG("failed to preallocate %s", name.c_str());
+    if (ftruncate(fd, static_cast<off_t>(segment_size_)) != 0) {
+      LOG_WARN("failed to size %s", name.c_str());
+    }
+  }
+  fsync(fd);
+  SyncDirectory();
+  return fd;
+}
+
+void LogFile::SyncDirectory() const {
+  auto slash = file_name_.rfind('/');
+  std::string directory = slash == std::string::npos ? "." : file_name_.substr(0, std::max<size_t>(slash, 1));
+  int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return;
+  }
+  fsync(fd);
+  close(fd);
+}
+
+}  // namespace bustub
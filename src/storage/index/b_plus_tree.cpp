@@ -10,7 +10,7 @@
 namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
+BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPool *buffer_pool_manager,
                           const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
@@ -126,6 +126,24 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
     return false;
   }
   // std::cout << this->DrawBPlusTree() << std::endl;
+  ReadPageGuard leaf_guard;
+  if (GetLeafPageOptimistic(key, &leaf_guard)) {
+    const auto *leaf_page = leaf_guard.As<LeafPage>();
+    for (int i = 0; i < leaf_page->GetSize(); i++) {
+      if (comparator_(leaf_page->KeyAt(i), key) == 0) {
+        found = true;
+        result->push_back(leaf_page->ValueAt(i));
+      }
+    }
+    return found;
+  }
+
+  // Writers kept changing the pages under us, crab down with read latches instead.
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return false;
+  }
   std::deque<Page *> depage;
   std::deque<page_id_t> nihaoa;
   BasicPageGuard page = GetLeafPage(key, depage, Operation::Read, nihaoa);
@@ -258,6 +276,62 @@ auto BPLUSTREE_TYPE::GetLeafPage(const KeyType &key, std::deque<Page *> &transac
   }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetLeafPageOptimistic(const KeyType &key, ReadPageGuard *leaf_guard) -> bool {
+  // Bound on the size of an internal page, so that a size read while a writer changes the page stays in the page.
+  constexpr int max_internal_size =
+      (BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>);
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_ATTEMPTS; attempt++) {
+    if (attempt > 0) {
+      root_latch_.RLock();
+    }
+    // The root's version is taken before root_latch_ is released: a writer replacing the root latches the old one.
+    OptimisticPageGuard guard = bpm_->FetchPageOptimistic(header_page_id_);
+    root_latch_.RUnlock();
+    if (guard.IsEmpty()) {
+      // no frame to load the page into, retrying would not help
+      return false;
+    }
+
+    while (true) {
+      const auto *tree_page = guard.As<BPlusTreePage>();
+      bool is_leaf = tree_page->IsLeafPage();
+      if (!guard.Validate()) {
+        break;
+      }
+      if (is_leaf) {
+        if (guard.TryUpgradeRead(leaf_guard)) {
+          return true;
+        }
+        break;
+      }
+
+      const auto *internal_page = guard.As<InternalPage>();
+      int size = std::clamp(internal_page->GetSize(), 1, max_internal_size);
+      page_id_t next_page_id = internal_page->ValueAt(size - 1);
+      for (int i = 1; i < size; i++) {
+        if (comparator_(internal_page->KeyAt(i), key) > 0) {
+          next_page_id = internal_page->ValueAt(i - 1);
+          break;
+        }
+      }
+      if (!guard.Validate()) {
+        break;
+      }
+      // Pin the child and take its version before checking that the parent still points to it.
+      OptimisticPageGuard child_guard = bpm_->FetchPageOptimistic(next_page_id);
+      if (child_guard.IsEmpty()) {
+        return false;
+      }
+      if (!guard.Validate()) {
+        break;
+      }
+      guard = std::move(child_guard);
+    }
+  }
+  return false;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::ReleaseOnePages(std::deque<Page *> &transaction) {
   if (!transaction.empty()) {
@@ -968,7 +1042,7 @@ void BPLUSTREE_TYPE::RemoveFromFile(const std::string &file_name, Transaction *t
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Print(BufferPoolManager *bpm) {
+void BPLUSTREE_TYPE::Print(BufferPool *bpm) {
   auto root_page_id = GetRootPageId();
   auto guard = bpm->FetchPageWrite(root_page_id);
   PrintTree(guard.PageId(), guard.template As<BPlusTreePage>());
@@ -1016,7 +1090,7 @@ void BPLUSTREE_TYPE::PrintTree(page_id_t page_id, const BPlusTreePage *page) {
  * This method is used for debug only, You don't need to modify
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Draw(BufferPoolManager *bpm, const std::string &outf) {
+void BPLUSTREE_TYPE::Draw(BufferPool *bpm, const std::string &outf) {
   if (IsEmpty()) {
     LOG_WARN("Drawing an empty tree");
     return;
@@ -16,7 +16,7 @@ namespace bustub {
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPool *buffer_pool_manager)
     : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
   page_id_t header_page_id;
   buffer_pool_manager->NewPage(&header_page_id);
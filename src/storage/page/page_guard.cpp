@@ -1,6 +1,6 @@
 #include "storage/page/page_guard.h"
 #include <iostream>
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool.h"
 
 namespace bustub {
 
@@ -140,4 +140,17 @@ WritePageGuard::~WritePageGuard() {
   // std::cout << guard_.page_->GetPinCount() << std::endl;
 }  // NOLINT
 
+auto OptimisticPageGuard::TryUpgradeRead(ReadPageGuard *guard) -> bool {
+  Page *page = guard_.page_;
+  page->RLatch();
+  // Writers are excluded now, so the version is even and only matches if nobody wrote since we took it.
+  if (page->GetVersion() != version_) {
+    page->RUnlatch();
+    return false;
+  }
+  *guard = ReadPageGuard(guard_.bpm_, page);
+  guard_.page_ = nullptr;
+  return true;
+}
+
 }  // namespace bustub
@@ -24,6 +24,7 @@ namespace bustub {
 
 void TablePage::Init() {
   next_page_id_ = INVALID_PAGE_ID;
+  lsn_ = INVALID_LSN;
   num_tuples_ = 0;
   num_deleted_tuples_ = 0;
 }
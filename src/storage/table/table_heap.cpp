@@ -25,7 +25,19 @@
 
 namespace bustub {
 
-TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
+template <typename Guard, typename MakeRecord>
+auto TableHeap::AppendLogRecord(Transaction *txn, Guard *guard, MakeRecord &&make_record) -> lsn_t {
+  guard->SetRecLSN(log_manager_->GetNextLSN());
+  LogRecord record = txn == nullptr ? make_record(INVALID_TXN_ID, INVALID_LSN)
+                                    : make_record(txn->GetTransactionId(), txn->GetPrevLSN());
+  lsn_t lsn = log_manager_->AppendLogRecord(&record);
+  if (txn != nullptr) {
+    txn->SetPrevLSN(lsn);
+  }
+  return lsn;
+}
+
+TableHeap::TableHeap(BufferPool *bpm, LogManager *log_manager) : bpm_(bpm), log_manager_(log_manager) {
   // Initialize the first table page.
   auto guard = bpm->NewPageGuarded(&first_page_id_);
   last_page_id_ = first_page_id_;
@@ -33,9 +45,14 @@ TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
   first_page->Init();
+  if (IsLogging()) {
+    guard.SetLSN(AppendLogRecord(nullptr, &guard, [this](txn_id_t txn_id, lsn_t prev_lsn) {
+      return LogRecord(txn_id, prev_lsn, LogRecordType::NEWPAGE, INVALID_PAGE_ID, first_page_id_);
+    }));
+  }
 }
 
-auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::optional<RID> {
+auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, Transaction *txn) -> std::optional<RID> {
   std::unique_lock<std::mutex> guard(latch_);
   auto page_guard = bpm_->FetchPageWrite(last_page_id_);
   while (true) {
@@ -51,9 +68,21 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::o
     auto npg = bpm_->NewPage(&next_page_id);
     BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
 
+    // One record covers both the link from the last page and the initialization of the new one.
+    lsn_t lsn = INVALID_LSN;
+    if (IsLogging()) {
+      npg->SetRecLSN(log_manager_->GetNextLSN());
+      lsn = AppendLogRecord(txn, &page_guard, [&](txn_id_t txn_id, lsn_t prev_lsn) {
+        return LogRecord(txn_id, prev_lsn, LogRecordType::NEWPAGE, last_page_id_, next_page_id);
+      });
+    }
+
     // Don't do lock crabbing here: TSAN reports, also as last_page_id_ is only updated
     // later, this page won't be accessed.
     page->SetNextPageId(next_page_id);
+    if (lsn != INVALID_LSN) {
+      page_guard.SetLSN(lsn);
+    }
     // std::cout << "page Drop" << std::endl;
     page_guard.Drop();
     // std::cout << next_page_id << "Wlock" << std::endl;
@@ -61,6 +90,9 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::o
     auto next_page_guard = WritePageGuard{bpm_, npg};
     auto next_page = next_page_guard.AsMut<TablePage>();
     next_page->Init();
+    if (lsn != INVALID_LSN) {
+      next_page_guard.SetLSN(lsn);
+    }
 
     last_page_id_ = next_page_id;
     page_guard = std::move(next_page_guard);
@@ -68,22 +100,48 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::o
   auto last_page_id = last_page_id_;
   guard.unlock();
 
+  // A change is logged, then made, then stamped with its LSN: once the page LSN is set, the change is in the page.
   auto page = page_guard.AsMut<TablePage>();
+  lsn_t lsn = INVALID_LSN;
+  if (IsLogging()) {
+    // Tuples are appended to the page, so the slot is known before the insert.
+    RID rid(last_page_id, page->GetNumTuples());
+    lsn = AppendLogRecord(txn, &page_guard, [&](txn_id_t txn_id, lsn_t prev_lsn) {
+      return LogRecord(txn_id, prev_lsn, LogRecordType::INSERT, rid, tuple);
+    });
+  }
   auto slot_id = *page->InsertTuple(meta, tuple);
+  if (lsn != INVALID_LSN) {
+    page_guard.SetLSN(lsn);
+  }
 
   page_guard.Drop();
 
   return RID(last_page_id, slot_id);
 }
 
-void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
+void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid, Transaction *txn) {
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
   auto page = page_guard.AsMut<TablePage>();
+  lsn_t lsn = INVALID_LSN;
+  if (IsLogging()) {
+    // Only deleting and restoring a tuple is logged, the transaction ids in the meta are not.
+    auto old = page->GetTuple(rid);
+    if (old.first.is_deleted_ != meta.is_deleted_) {
+      auto type = meta.is_deleted_ ? LogRecordType::MARKDELETE : LogRecordType::ROLLBACKDELETE;
+      lsn = AppendLogRecord(txn, &page_guard, [&](txn_id_t txn_id, lsn_t prev_lsn) {
+        return LogRecord(txn_id, prev_lsn, type, rid, old.second);
+      });
+    }
+  }
   page->UpdateTupleMeta(meta, rid);
+  if (lsn != INVALID_LSN) {
+    page_guard.SetLSN(lsn);
+  }
 }
 
-auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
-  auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+auto TableHeap::GetTuple(RID rid, AccessType access_type) -> std::pair<TupleMeta, Tuple> {
+  auto page_guard = bpm_->FetchPageRead(rid.GetPageId(), access_type);
   auto page = page_guard.As<TablePage>();
   auto [meta, tuple] = page->GetTuple(rid);
   tuple.rid_ = rid;
@@ -106,10 +164,20 @@ auto TableHeap::MakeIterator() -> TableIterator {
   return {this, {first_page_id_, 0}, {last_page_id, page->GetNumTuples()}};
 }
 
-void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
+void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid, Transaction *txn) {
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
   auto page = page_guard.AsMut<TablePage>();
+  lsn_t lsn = INVALID_LSN;
+  if (IsLogging()) {
+    auto old_tuple = page->GetTuple(rid).second;
+    lsn = AppendLogRecord(txn, &page_guard, [&](txn_id_t txn_id, lsn_t prev_lsn) {
+      return LogRecord(txn_id, prev_lsn, LogRecordType::UPDATE, rid, old_tuple, tuple);
+    });
+  }
   page->UpdateTupleInPlaceUnsafe(meta, tuple, rid);
+  if (lsn != INVALID_LSN) {
+    page_guard.SetLSN(lsn);
+  }
 }
 
 }  // namespace bustub
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer replacer(4);
+  // Brings a page into a frame and unpins it, the way the buffer pool does.
+  auto load = [&replacer](frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    replacer.RecordAccess(frame_id, access_type, page_id);
+    replacer.SetEvictable(frame_id, true);
+  };
+  int value;
+
+  // Scenario: four new pages enter T1. A second access moves frame 0 to T2.
+  load(0, 100);
+  load(1, 101);
+  load(2, 102);
+  load(3, 103);
+  replacer.RecordAccess(0);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_EQ(0, replacer.GetTarget());
+
+  // Scenario: T1 is larger than its target, so its least recently used frame goes first and its page moves to B1.
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 101 comes back while in B1. T1 was too small: its target grows, and the page enters T2.
+  load(1, 101);
+  ASSERT_EQ(1, replacer.GetTarget());
+  ASSERT_EQ((std::vector<frame_id_t>{2, 0, 1, 3}), replacer.EvictionOrder(4));
+
+  // Scenario: evict from T1 down to its target, then from T2. Page 100 moves to B2.
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 100 comes back while in B2. T2 was too small: the target of T1 shrinks.
+  load(0, 100);
+  ASSERT_EQ(0, replacer.GetTarget());
+
+  // Scenario: a scan brings back page 102 from B1. A scan neither adapts the target nor promotes the page to T2.
+  load(2, 102, AccessType::Scan);
+  replacer.RecordAccess(2, AccessType::Scan);
+  ASSERT_EQ(0, replacer.GetTarget());
+  ASSERT_EQ((std::vector<frame_id_t>{3, 2, 1, 0}), replacer.EvictionOrder(4));
+
+  // Scenario: pinned frames are skipped.
+  replacer.SetEvictable(3, false);
+  ASSERT_EQ(3, replacer.Size());
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+}
+
+}  // namespace bustub
@@ -12,11 +12,20 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <chrono>  // NOLINT
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/hot_page_list.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -181,4 +190,428 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentMissTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_threads = 8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: Create more pages than frames, so the first ones get evicted and written back.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  disk_manager->SetLatency(10);
+
+  // Scenario: Many threads miss on the same page at once. It is read only once, and all of them share the frame.
+  std::vector<Page *> pages(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&bpm, &pages, tid, page_id = page_ids[0]] { pages[tid] = bpm->FetchPage(page_id); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_NE(nullptr, pages[0]);
+  for (auto *page : pages) {
+    EXPECT_EQ(pages[0], page);
+  }
+  EXPECT_EQ(num_threads, pages[0]->GetPinCount());
+  EXPECT_EQ(0, strcmp(pages[0]->GetData(), "page 0"));
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  }
+
+  // Scenario: Concurrent misses on different pages each see their own content.
+  threads.clear();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    threads.emplace_back([&bpm, page_id = page_ids[page_ids.size() - 1 - i]] {
+      auto guard = bpm->FetchPageRead(page_id);
+      EXPECT_EQ(0, strcmp(guard.GetData(), ("page " + std::to_string(page_id)).c_str()));
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+  const size_t num_hot_pages = 4;
+  const size_t num_hit_threads = 4;
+  const size_t num_miss_threads = 2;
+  const size_t rounds = 2000;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: Some threads keep hitting a few hot pages while others miss on cold pages, so frames are evicted and
+  // reassigned under the feet of the lock-free hits. Every fetch must see the page it asked for.
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_hit_threads + num_miss_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      for (size_t round = 0; round < rounds; ++round) {
+        page_id_t page_id = tid < num_hit_threads ? page_ids[gen() % num_hot_pages]
+                                                  : page_ids[num_hot_pages + gen() % (num_pages - num_hot_pages)];
+        auto guard = bpm->FetchPageRead(page_id, AccessType::Get);
+        ASSERT_EQ(page_id, guard.PageId());
+        EXPECT_EQ(0, strcmp(guard.GetData(), ("page " + std::to_string(page_id)).c_str()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: Afterwards no frame is left pinned, and each page is in at most one frame.
+  std::set<page_id_t> resident;
+  for (size_t frame_id = 0; frame_id < buffer_pool_size; ++frame_id) {
+    Page &page = bpm->GetPages()[frame_id];
+    EXPECT_EQ(0, page.GetPinCount());
+    if (page.GetPageId() != INVALID_PAGE_ID) {
+      EXPECT_TRUE(resident.insert(page.GetPageId()).second);
+    }
+  }
+
+  // Scenario: All frames can still be pinned at once, so none was lost to the replacer.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReadAheadTest) {
+  const size_t buffer_pool_size = 32;
+  const size_t num_pages = 12;
+
+  // Scenario: Write a chain of pages, each one storing the id of the next in its first bytes.
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  {
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      page_id_t next_page_id = i + 1 < num_pages ? page_id + 1 : INVALID_PAGE_ID;
+      memcpy(page->GetData(), &next_page_id, sizeof(next_page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+  }
+
+  // Scenario: A fresh buffer pool holds none of the pages. A scan registers for read-ahead with a window of 4 pages.
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  bpm->SetReadAheadWindow(4);
+  EXPECT_EQ(4, bpm->GetReadAheadWindow());
+  auto is_resident = [&bpm](page_id_t page_id) {
+    std::scoped_lock latch(bpm->latch_);
+    frame_id_t frame_id;
+    return bpm->page_table_.Find(page_id, &frame_id);
+  };
+  auto wait_resident = [&is_resident](page_id_t page_id) {
+    for (int i = 0; i < 1000 && !is_resident(page_id); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return is_resident(page_id);
+  };
+  auto scan = bpm->RegisterReadAhead([](const char *page_data) {
+    page_id_t next_page_id;
+    memcpy(&next_page_id, page_data, sizeof(next_page_id));
+    return next_page_id;
+  });
+
+  // Scenario: Entering the first page prefetches the next 4 pages of the chain, but not more.
+  bpm->ReadAhead(scan, 0);
+  EXPECT_TRUE(wait_resident(4));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(is_resident(5));
+
+  // Scenario: The window is only refilled once half of it has been consumed.
+  bpm->ReadAhead(scan, 1);
+  bpm->ReadAhead(scan, 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(is_resident(5));
+  bpm->ReadAhead(scan, 3);
+  EXPECT_TRUE(wait_resident(7));
+
+  // Scenario: Read-ahead stops at the end of the chain, and prefetched pages are not left pinned.
+  for (page_id_t page_id = 4; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    bpm->ReadAhead(scan, page_id);
+  }
+  EXPECT_TRUE(wait_resident(num_pages - 1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: A window of 0 disables read-ahead.
+  bpm->SetReadAheadWindow(0);
+  EXPECT_EQ(0, bpm->GetReadAheadWindow());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlusherTest) {
+  const size_t buffer_pool_size = 10;
+
+  // Scenario: Fill the buffer pool with dirty, unpinned pages.
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: The flusher writes back the coldest dirty pages until half of the frames are clean.
+  bpm->StartFlusher(0.5, std::chrono::milliseconds(1));
+  for (int i = 0; i < 1000 && bpm->GetFlusherStats().pages_flushed_ < buffer_pool_size / 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto stats = bpm->GetFlusherStats();
+  EXPECT_EQ(buffer_pool_size / 2, stats.pages_flushed_);
+  EXPECT_LE(1, stats.flush_rounds_);
+  EXPECT_EQ(0, stats.dirty_evictions_);
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size / 2); ++page_id) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(0, strcmp(data, ("page " + std::to_string(page_id)).c_str()));
+  }
+
+  // Scenario: New pages evict the clean frames without writing anything back.
+  bpm->StopFlusher();
+  for (size_t i = 0; i < buffer_pool_size / 2; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetFlusherStats().dirty_evictions_);
+
+  // Scenario: Once the clean frames are used up, evictions write back dirty pages and are counted.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  EXPECT_EQ(1, bpm->GetFlusherStats().dirty_evictions_);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReplacerTypeTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+
+  for (auto replacer_type : {ReplacerType::LRUK, ReplacerType::LRU, ReplacerType::Clock, ReplacerType::TwoQueue,
+                             ReplacerType::ARC}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr,
+                                                   replacer_type);
+
+    // Scenario: Create more pages than there are frames, so that every policy has to evict.
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      page_ids.push_back(page_id);
+    }
+
+    // Scenario: Pin a full pool. No frame can be evicted, so fetching one more page fails.
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    }
+    EXPECT_EQ(nullptr, bpm->FetchPage(page_ids[buffer_pool_size]));
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+    }
+
+    // Scenario: Every page survives its evictions, with a mix of hot and cold accesses.
+    for (size_t round = 0; round < 3; ++round) {
+      for (size_t i = 0; i < num_pages; ++i) {
+        page_id_t page_id = page_ids[i % 4 == 0 ? 0 : i];
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: New pages that fit in the pool are neither hits nor misses.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_ + stats.misses_ + stats.evictions_ + stats.dirty_flushes_);
+
+  // Scenario: A new page evicts a dirty page and writes it back.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  page_ids.push_back(page_id);
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(1, stats.dirty_flushes_);
+  EXPECT_EQ(1, stats.write_latency_.count_);
+
+  // Scenario: Flushing writes back the other dirty pages, and fetching the evicted page is a miss that needs no
+  // write-back anymore.
+  bpm->FlushAllPages();
+  page_id_t evicted = INVALID_PAGE_ID;
+  for (auto resident : page_ids) {
+    frame_id_t frame_id;
+    if (!bpm->page_table_.Find(resident, &frame_id)) {
+      evicted = resident;
+      continue;
+    }
+    ASSERT_NE(nullptr, bpm->FetchPage(resident));
+    EXPECT_EQ(true, bpm->UnpinPage(resident, false));
+  }
+  ASSERT_NE(INVALID_PAGE_ID, evicted);
+  ASSERT_NE(nullptr, bpm->FetchPage(evicted));
+  EXPECT_EQ(true, bpm->UnpinPage(evicted, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1 + buffer_pool_size, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(1 + buffer_pool_size, stats.dirty_flushes_);
+  EXPECT_EQ(1 + buffer_pool_size, stats.write_latency_.count_);
+  EXPECT_EQ(1, stats.read_latency_.count_);
+  EXPECT_EQ(0, stats.pin_waits_);
+  EXPECT_DOUBLE_EQ(5.0 / 6.0, stats.HitRatio());
+
+  // Scenario: Resetting starts again from zero.
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_ + stats.misses_ + stats.evictions_ + stats.dirty_flushes_ + stats.read_latency_.count_);
+
+  // Scenario: Latencies are counted in power-of-two buckets, percentiles report the upper bound of their bucket.
+  LatencyHistogram histogram;
+  for (uint64_t us : {0, 1, 3, 3, 100}) {
+    histogram.Add(us);
+  }
+  EXPECT_EQ(0, LatencyHistogram::BucketOf(0));
+  EXPECT_EQ(2, LatencyHistogram::BucketOf(3));
+  EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketOf(UINT64_MAX));
+  EXPECT_EQ(4, histogram.Percentile(0.5));
+  EXPECT_EQ(128, histogram.Percentile(0.99));
+  EXPECT_DOUBLE_EQ(107.0 / 5, histogram.Mean());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrewarmTest) {
+  const std::string db_name = "test.db";
+  const std::string hot_page_file = "test.hot";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  remove(hot_page_file.c_str());
+
+  // Scenario: Fill the database with twice as many pages as fit in the pool, so the first half gets evicted.
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: The hot page list starts with the pinned pages, followed by the others from the last to be evicted.
+  for (page_id_t page_id : {12, 15, 17}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(11));
+  EXPECT_EQ((std::vector<page_id_t>{11, 17, 15, 12, 19}), bpm->GetHotPages(5));
+  ASSERT_EQ(true, bpm->DumpHotPages(hot_page_file));
+  auto hot_pages = HotPageList::Read(hot_page_file);
+  ASSERT_EQ(buffer_pool_size, hot_pages.size());
+  EXPECT_EQ((std::vector<page_id_t>{11, 17, 15, 12}), std::vector<page_id_t>(hot_pages.begin(), hot_pages.begin() + 4));
+  EXPECT_EQ(true, bpm->UnpinPage(11, false));
+  bpm->FlushAllPages();
+  bpm.reset();
+  disk_manager->ShutDown();
+
+  // Scenario: After a restart, the hottest pages of the list are loaded within the budget, and fetching them is a hit.
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(4, bpm->StartPrewarm(hot_page_file, 4));
+  EXPECT_EQ(4, bpm->WaitForPrewarm());
+  for (page_id_t page_id : {11, 12, 15, 17}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(4, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+
+  // Scenario: Prewarming skips the pages already in the pool, and only fills free frames.
+  EXPECT_EQ(buffer_pool_size, bpm->StartPrewarm(hot_page_file, 2 * buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size - 4, bpm->WaitForPrewarm());
+  EXPECT_EQ(0, bpm->GetStats().evictions_);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  EXPECT_EQ(buffer_pool_size, bpm->StartPrewarm(hot_page_file, 2 * buffer_pool_size));
+  EXPECT_EQ(0, bpm->WaitForPrewarm());
+
+  // Scenario: A missing or damaged list prewarms nothing.
+  EXPECT_EQ(0, bpm->StartPrewarm("missing.hot", buffer_pool_size));
+  EXPECT_EQ(0, bpm->WaitForPrewarm());
+  FILE *file = fopen(hot_page_file.c_str(), "w");
+  fputs("not a hot page list", file);
+  fclose(file);
+  EXPECT_EQ(0, HotPageList::Read(hot_page_file).size());
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("test.log");
+  remove("test.fsm");
+  remove(hot_page_file.c_str());
+}
+
 }  // namespace bustub
@@ -19,44 +19,77 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
+  // Adds a frame to the replacer the way the buffer pool unpins it.
+  auto unpin = [&clock_replacer](frame_id_t frame_id) {
+    clock_replacer.RecordAccess(frame_id);
+    clock_replacer.SetEvictable(frame_id, true);
+  };
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
-  clock_replacer.Unpin(1);
-  clock_replacer.Unpin(2);
-  clock_replacer.Unpin(3);
-  clock_replacer.Unpin(4);
-  clock_replacer.Unpin(5);
-  clock_replacer.Unpin(6);
-  clock_replacer.Unpin(1);
+  unpin(1);
+  unpin(2);
+  unpin(3);
+  unpin(4);
+  unpin(5);
+  unpin(6);
+  unpin(1);
   EXPECT_EQ(6, clock_replacer.Size());
 
   // Scenario: get three victims from the clock.
   int value;
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(1, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(2, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(3, value);
 
   // Scenario: pin elements in the replacer.
   // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  clock_replacer.Pin(3);
-  clock_replacer.Pin(4);
+  clock_replacer.SetEvictable(3, false);
+  clock_replacer.SetEvictable(4, false);
   EXPECT_EQ(2, clock_replacer.Size());
 
   // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  clock_replacer.Unpin(4);
+  unpin(4);
 
   // Scenario: continue looking for victims. We expect these victims.
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(5, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(6, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(4, value);
+  EXPECT_EQ(0, clock_replacer.Size());
+  EXPECT_FALSE(clock_replacer.Evict(&value));
+}
+
+TEST(ClockReplacerTest, ScanTest) {
+  ClockReplacer clock_replacer(4);
+  int value;
+
+  // Scenario: frames 0 and 1 hold hot pages, frames 2 and 3 were loaded by a scan and have no reference bit.
+  clock_replacer.RecordAccess(0);
+  clock_replacer.RecordAccess(1);
+  clock_replacer.RecordAccess(2, AccessType::Scan);
+  clock_replacer.RecordAccess(3, AccessType::Scan);
+  clock_replacer.RecordAccess(3, AccessType::Scan);
+  for (int i = 0; i < 4; i++) {
+    clock_replacer.SetEvictable(i, true);
+  }
+  EXPECT_EQ((std::vector<frame_id_t>{2, 3, 0, 1}), clock_replacer.EvictionOrder(4));
+
+  // Scenario: the scan frames go first, then the sweep comes back to the frames whose bit it cleared.
+  clock_replacer.Evict(&value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Evict(&value);
+  EXPECT_EQ(3, value);
+  clock_replacer.Remove(0);
+  EXPECT_EQ(1, clock_replacer.Size());
+  clock_replacer.Evict(&value);
+  EXPECT_EQ(1, value);
 }
 
 }  // namespace bustub
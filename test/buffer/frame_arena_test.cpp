@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 1000;
+
+  // Scenario: whatever the system provides, every mode gives contiguous, aligned, zeroed and writable frames.
+  for (auto huge_pages : {HugePageMode::None, HugePageMode::Transparent, HugePageMode::Explicit}) {
+    for (auto numa_node : {NUMA_DEFAULT, NUMA_INTERLEAVE, 0}) {
+      FrameArena arena(num_frames, huge_pages, numa_node);
+      EXPECT_GE(arena.GetSize(), num_frames * BUSTUB_PAGE_SIZE);
+      if (huge_pages == HugePageMode::None) {
+        EXPECT_EQ(HugePageMode::None, arena.GetHugePageMode());
+      }
+      for (size_t frame_id = 0; frame_id < num_frames; frame_id++) {
+        char *frame = arena.GetFrame(frame_id);
+        EXPECT_EQ(arena.GetFrame(0) + frame_id * BUSTUB_PAGE_SIZE, frame);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frame) % BUSTUB_PAGE_SIZE);
+        EXPECT_EQ(0, frame[0]);
+        EXPECT_EQ(0, frame[BUSTUB_PAGE_SIZE - 1]);
+        memset(frame, 0xff, BUSTUB_PAGE_SIZE);
+      }
+    }
+  }
+}
+
+TEST(FrameArenaTest, BufferPoolTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(4, disk_manager.get());
+
+  // Scenario: the pages of a buffer pool are laid out back to back, and keep their content across evictions.
+  Page *pages = bpm->GetPages();
+  for (size_t frame_id = 0; frame_id < 4; frame_id++) {
+    EXPECT_EQ(pages[0].GetData() + frame_id * BUSTUB_PAGE_SIZE, pages[frame_id].GetData());
+  }
+  for (int i = 0; i < 8; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), ("page " + std::to_string(page_id)).c_str()));
+  }
+}
+
+}  // namespace bustub
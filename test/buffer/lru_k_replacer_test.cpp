@@ -94,4 +94,53 @@ TEST(LRUKReplacerTest, SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(7, 2);
+  int value;
+
+  // Scenario: frames 1 and 2 are hot, frame 3 was touched once. Frames 4 and 5 are loaded by a scan.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(5, AccessType::Scan);
+  for (int i = 1; i <= 5; i++) {
+    lru_replacer.SetEvictable(i, true);
+  }
+  ASSERT_EQ(5, lru_replacer.Size());
+
+  // Scenario: the scan keeps touching its frames, and touches hot frame 1 as well. None of this counts as history, so
+  // frame 4 does not reach K accesses and frame 1 does not move.
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+
+  // Scenario: a regular access admits frame 5, which now has two accesses and is ranked by its older one.
+  lru_replacer.RecordAccess(5, AccessType::Get);
+
+  // Scan frames on probation go first even though they are newer, then +inf frames, then LRU-K order [1,2,5].
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(5, value);
+  ASSERT_EQ(0, lru_replacer.Size());
+
+  // Scenario: an evicted scan frame starts over on probation when a scan loads it again.
+  lru_replacer.RecordAccess(6);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.SetEvictable(6, true);
+  lru_replacer.SetEvictable(4, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+}
 }  // namespace bustub
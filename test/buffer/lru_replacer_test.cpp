@@ -19,44 +19,50 @@
 
 namespace bustub {
 
-TEST(LRUReplacerTest, DISABLED_SampleTest) {
+TEST(LRUReplacerTest, SampleTest) {
   LRUReplacer lru_replacer(7);
+  // Adds a frame to the replacer the way the buffer pool unpins it.
+  auto unpin = [&lru_replacer](frame_id_t frame_id) {
+    lru_replacer.RecordAccess(frame_id);
+    lru_replacer.SetEvictable(frame_id, true);
+  };
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  lru_replacer.Unpin(1);
-  lru_replacer.Unpin(2);
-  lru_replacer.Unpin(3);
-  lru_replacer.Unpin(4);
-  lru_replacer.Unpin(5);
-  lru_replacer.Unpin(6);
-  lru_replacer.Unpin(1);
+  // Scenario: unpin six elements, i.e. add them to the replacer. Accessing 1 again makes it the most recent one.
+  unpin(1);
+  unpin(2);
+  unpin(3);
+  unpin(4);
+  unpin(5);
+  unpin(6);
+  unpin(1);
   EXPECT_EQ(6, lru_replacer.Size());
 
   // Scenario: get three victims from the lru.
   int value;
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(1, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(2, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(3, value);
+  lru_replacer.Evict(&value);
+  EXPECT_EQ(4, value);
 
   // Scenario: pin elements in the replacer.
   // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  lru_replacer.Pin(3);
-  lru_replacer.Pin(4);
+  lru_replacer.SetEvictable(3, false);
+  lru_replacer.SetEvictable(5, false);
   EXPECT_EQ(2, lru_replacer.Size());
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  lru_replacer.Unpin(4);
+  // Scenario: unpin 5. Its position is the one of its last access.
+  unpin(5);
 
   // Scenario: continue looking for victims. We expect these victims.
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(5, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(6, value);
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(4, value);
+  lru_replacer.Evict(&value);
+  EXPECT_EQ(1, value);
+  lru_replacer.Evict(&value);
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_replacer.Evict(&value));
 }
 
 }  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/access_buffer.h"
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(16);
+  frame_id_t frame_id;
+
+  // Scenario: map a few pages and look them up again.
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  page_table.Insert(0, 3);
+  page_table.Insert(7, 1);
+  page_table.Insert(42, 2);
+  EXPECT_EQ(3, page_table.Size());
+  ASSERT_TRUE(page_table.Find(7, &frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Scenario: mapping a page again replaces its frame.
+  page_table.Insert(7, 5);
+  EXPECT_EQ(3, page_table.Size());
+  ASSERT_TRUE(page_table.Find(7, &frame_id));
+  EXPECT_EQ(5, frame_id);
+
+  // Scenario: erased pages are gone, the others stay.
+  page_table.Erase(7);
+  page_table.Erase(8);
+  EXPECT_EQ(2, page_table.Size());
+  EXPECT_FALSE(page_table.Find(7, &frame_id));
+  ASSERT_TRUE(page_table.Find(42, &frame_id));
+  EXPECT_EQ(2, frame_id);
+}
+
+TEST(PageTableTest, ChurnTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::mt19937 gen(0);
+
+  // Scenario: keep the table full while pages come and go, so that erasing has to shift entries of long clusters.
+  for (size_t round = 0; round < 10000; ++round) {
+    auto page_id = static_cast<page_id_t>(gen() % 1000);
+    if (expected.count(page_id) > 0) {
+      page_table.Erase(page_id);
+      expected.erase(page_id);
+    } else if (expected.size() < 2 * num_frames) {
+      auto frame_id = static_cast<frame_id_t>(gen() % num_frames);
+      page_table.Insert(page_id, frame_id);
+      expected[page_id] = frame_id;
+    }
+  }
+  EXPECT_EQ(expected.size(), page_table.Size());
+  for (page_id_t page_id = 0; page_id < 1000; ++page_id) {
+    frame_id_t frame_id;
+    bool found = page_table.Find(page_id, &frame_id);
+    ASSERT_EQ(expected.count(page_id) > 0, found);
+    if (found) {
+      EXPECT_EQ(expected[page_id], frame_id);
+    }
+  }
+}
+
+TEST(PageTableTest, ConcurrentReadTest) {
+  const size_t num_frames = 32;
+  PageTable page_table(num_frames);
+  // Pages [0, num_frames) never move; other pages come and go around them.
+  for (size_t i = 0; i < num_frames; ++i) {
+    page_table.Insert(static_cast<page_id_t>(i), static_cast<frame_id_t>(i));
+  }
+
+  // Scenario: lock-free readers never see a wrong frame for a page, even while a writer erases and inserts others.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (size_t tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([&page_table, &stop, tid] {
+      std::mt19937 gen(tid);
+      while (!stop) {
+        auto page_id = static_cast<page_id_t>(gen() % num_frames);
+        frame_id_t frame_id;
+        if (page_table.Find(page_id, &frame_id)) {
+          ASSERT_EQ(page_id, frame_id);
+        }
+      }
+    });
+  }
+  std::mt19937 gen(42);
+  for (size_t round = 0; round < 20000; ++round) {
+    auto page_id = static_cast<page_id_t>(num_frames + gen() % num_frames);
+    page_table.Insert(page_id, -1);
+    page_table.Erase(page_id);
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+TEST(AccessBufferTest, SampleTest) {
+  AccessBuffer access_buffer(8);
+  std::vector<AccessRecord> drained;
+  auto drain = [&] {
+    drained.clear();
+    access_buffer.Drain([&drained](const AccessRecord &record) { drained.push_back(record); });
+  };
+
+  // Scenario: records come out in order, with all their fields.
+  EXPECT_FALSE(access_buffer.Push({1, 10, true, AccessType::Scan}));
+  EXPECT_FALSE(access_buffer.Push({2, 20, false, AccessType::Unknown}));
+  drain();
+  ASSERT_EQ(2, drained.size());
+  EXPECT_EQ(1, drained[0].frame_id_);
+  EXPECT_EQ(10, drained[0].page_id_);
+  EXPECT_TRUE(drained[0].is_access_);
+  EXPECT_EQ(AccessType::Scan, drained[0].access_type_);
+  EXPECT_EQ(2, drained[1].frame_id_);
+  EXPECT_FALSE(drained[1].is_access_);
+  drain();
+  EXPECT_TRUE(drained.empty());
+
+  // Scenario: the buffer asks to be drained once half full, and keeps only the last lap of records.
+  for (frame_id_t frame_id = 0; frame_id < 3; ++frame_id) {
+    EXPECT_FALSE(access_buffer.Push({frame_id, frame_id, true, AccessType::Get}));
+  }
+  EXPECT_TRUE(access_buffer.Push({3, 3, true, AccessType::Get}));
+  for (frame_id_t frame_id = 4; frame_id < 12; ++frame_id) {
+    access_buffer.Push({frame_id, frame_id, true, AccessType::Get});
+  }
+  drain();
+  ASSERT_EQ(8, drained.size());
+  EXPECT_EQ(4, drained.front().frame_id_);
+  EXPECT_EQ(11, drained.back().frame_id_);
+}
+
+}  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: New pages are spread round robin over the instances, so page ids are handed out in order.
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+    EXPECT_EQ(bpm->GetBufferPoolManager(page_id_temp), bpm->GetBufferPoolManager(page_id_temp + num_instances));
+  }
+
+  // Scenario: Once every instance is full of pinned pages, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: Unpinning pages frees frames only in the instances owning them.
+  for (int i = 0; i < static_cast<int>(num_instances); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: Page 0 was evicted from its instance, and must be read back from disk.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(false, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->DeletePage(0));
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentGuardTest) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 8;
+  const size_t num_threads = 4;
+  const size_t num_pages = 64;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    *guard.AsMut<size_t>() = 0;
+    page_ids.push_back(page_id);
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&bpm, &page_ids] {
+      for (auto page_id : page_ids) {
+        auto guard = bpm->FetchPageWrite(page_id);
+        *guard.AsMut<size_t>() += 1;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(num_threads, *guard.As<size_t>());
+  }
+}
+
+}  // namespace bustub
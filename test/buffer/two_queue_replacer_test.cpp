@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  TwoQueueReplacer replacer(8, /*k_in=*/2, /*k_out=*/4);
+  // Brings a page into a frame and unpins it, the way the buffer pool does.
+  auto load = [&replacer](frame_id_t frame_id, page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    replacer.RecordAccess(frame_id, access_type, page_id);
+    replacer.SetEvictable(frame_id, true);
+  };
+  int value;
+
+  // Scenario: four new pages enter A1in. It holds more than k_in frames, so it is evicted from in FIFO order and the
+  // evicted pages are remembered in A1out.
+  load(0, 100);
+  load(1, 101);
+  load(2, 102);
+  load(3, 103);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 100 comes back while in A1out and enters Am. Page 104 is new and enters A1in. Touching frame 2
+  // again is a correlated reference and does not move it.
+  load(0, 100);
+  load(1, 104);
+  replacer.RecordAccess(2);
+  ASSERT_EQ(4, replacer.Size());
+
+  // Scenario: A1in is evicted from until it is down to k_in frames, then Am takes its turn.
+  ASSERT_EQ((std::vector<frame_id_t>{2, 0, 3, 1}), replacer.EvictionOrder(8));
+
+  // Scenario: a scan brings back page 101. Even though it is in A1out, a scan does not prove reuse: it enters A1in.
+  load(4, 101, AccessType::Scan);
+  ASSERT_EQ((std::vector<frame_id_t>{2, 3, 0, 1, 4}), replacer.EvictionOrder(8));
+
+  // Scenario: removing a frame does not remember its page, so page 103 comes back to A1in.
+  replacer.Remove(3);
+  load(3, 103);
+  ASSERT_EQ((std::vector<frame_id_t>{2, 1, 0, 4, 3}), replacer.EvictionOrder(8));
+
+  // Scenario: pinned frames are skipped, and non-evictable frames cannot be removed.
+  replacer.SetEvictable(2, false);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_THROW(replacer.Remove(2), Exception);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+}
+
+}  // namespace bustub
@@ -124,4 +124,199 @@ TEST(LockManagerDeadlockDetectionTest, BasicDeadlockDetectionTest) {
   delete txn0;
   delete txn1;
 }
+
+TEST(LockManagerDeadlockDetectionTest, IncrementalEdgeTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+
+  table_oid_t toid{0};
+  RID rid0{0, 0};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_SHARED, toid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_SHARED, toid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::INTENTION_SHARED, toid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::SHARED, toid, rid0));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::SHARED, toid, rid0));
+
+  // Scenario: A blocked transaction waits for the incompatible holders, not for itself nor for the other waiters.
+  std::thread t2([&] {
+    EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+    EXPECT_TRUE(lock_mgr.LockRow(txn2, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+    txn_mgr.Commit(txn2);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  auto edges = lock_mgr.GetEdgeList();
+  std::sort(edges.begin(), edges.end());
+  EXPECT_EQ((std::vector<std::pair<txn_id_t, txn_id_t>>{{2, 0}, {2, 1}}), edges);
+
+  // Scenario: Releasing a lock drops the edges to the transaction right away, and the waiter's once it gets the lock.
+  txn_mgr.Commit(txn0);
+  EXPECT_EQ((std::vector<std::pair<txn_id_t, txn_id_t>>{{2, 1}}), lock_mgr.GetEdgeList());
+  txn_mgr.Commit(txn1);
+  t2.join();
+  EXPECT_TRUE(lock_mgr.GetEdgeList().empty());
+  EXPECT_EQ(TransactionState::COMMITTED, txn2->GetState());
+
+  delete txn0;
+  delete txn1;
+  delete txn2;
+}
+
+/** txn0 and txn1 lock a row each, then each wants the other's; returns what LockRow returned to each of them */
+auto CrossRowLocks(LockManager *lock_mgr, TransactionManager *txn_mgr) -> std::pair<bool, bool> {
+  table_oid_t toid{0};
+  RID rid0{0, 0};
+  RID rid1{1, 1};
+  auto *txn0 = txn_mgr->Begin();
+  auto *txn1 = txn_mgr->Begin();
+  EXPECT_TRUE(lock_mgr->LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr->LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr->LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+  EXPECT_TRUE(lock_mgr->LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+
+  std::pair<bool, bool> res;
+  std::thread t0([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    res.first = lock_mgr->LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid1);
+    EXPECT_EQ(res.first, txn0->GetState() != TransactionState::ABORTED);
+    if (res.first) {
+      txn_mgr->Commit(txn0);
+    } else {
+      txn_mgr->Abort(txn0);
+    }
+  });
+  std::thread t1([&] {
+    res.second = lock_mgr->LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid0);
+    EXPECT_EQ(res.second, txn1->GetState() != TransactionState::ABORTED);
+    if (res.second) {
+      txn_mgr->Commit(txn1);
+    } else {
+      txn_mgr->Abort(txn1);
+    }
+  });
+  t0.join();
+  t1.join();
+  EXPECT_TRUE(lock_mgr->GetEdgeList().empty());
+
+  delete txn0;
+  delete txn1;
+  return res;
+}
+
+TEST(LockManagerDeadlockDetectionTest, WaitDieTest) {
+  auto saved_policy = deadlock_policy;
+  deadlock_policy = DeadlockPolicy::WaitDie;
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+
+  // Scenario: The younger txn1 dies as soon as it would wait for txn0, which then gets its lock. No detector runs.
+  EXPECT_EQ(std::make_pair(true, false), CrossRowLocks(&lock_mgr, &txn_mgr));
+  deadlock_policy = saved_policy;
+}
+
+TEST(LockManagerDeadlockDetectionTest, WoundWaitTest) {
+  auto saved_policy = deadlock_policy;
+  deadlock_policy = DeadlockPolicy::WoundWait;
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+
+  // Scenario: txn1 waits for the older txn0, until txn0 would wait for it, which aborts txn1.
+  EXPECT_EQ(std::make_pair(true, false), CrossRowLocks(&lock_mgr, &txn_mgr));
+  deadlock_policy = saved_policy;
+}
+
+TEST(LockManagerDeadlockDetectionTest, WoundRunningTest) {
+  auto saved_policy = deadlock_policy;
+  deadlock_policy = DeadlockPolicy::WoundWait;
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t toid{0};
+  RID rid0{0, 0};
+  RID rid1{1, 1};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+
+  // Scenario: txn0 wounds txn1 while txn1 is running rather than waiting, then waits for txn1 to roll back.
+  std::thread t0([&] {
+    EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+    EXPECT_TRUE(txn_mgr.Commit(txn0));
+  });
+  while (txn1->GetState() != TransactionState::ABORTED) {
+    std::this_thread::yield();
+  }
+  // The wounded txn1 never blocks again: it gives up on the lock txn0 holds, and its commit rolls it back instead.
+  EXPECT_FALSE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+  EXPECT_FALSE(txn_mgr.Commit(txn1));
+  EXPECT_EQ(TransactionState::ABORTED, txn1->GetState());
+  t0.join();
+  EXPECT_EQ(TransactionState::COMMITTED, txn0->GetState());
+  EXPECT_TRUE(lock_mgr.GetEdgeList().empty());
+
+  delete txn0;
+  delete txn1;
+  deadlock_policy = saved_policy;
+}
+
+TEST(LockManagerDeadlockDetectionTest, RandomDeadlockTest) {
+  auto saved_policy = deadlock_policy;
+  auto saved_interval = cycle_detection_interval;
+  cycle_detection_interval = std::chrono::milliseconds(5);
+
+  // Scenario: Transactions lock a few of a handful of rows in random order. Whatever the policy, they all finish.
+  for (auto policy : {DeadlockPolicy::Detection, DeadlockPolicy::WaitDie, DeadlockPolicy::WoundWait}) {
+    deadlock_policy = policy;
+    LockManager lock_mgr{};
+    TransactionManager txn_mgr{&lock_mgr};
+    table_oid_t toid{0};
+    const int num_threads = 8;
+    const int num_txns = 50;
+    std::atomic<int> committed{0};
+
+    auto task = [&](int thread_id) {
+      std::mt19937 rng(thread_id);
+      for (int i = 0; i < num_txns; i++) {
+        auto *txn = txn_mgr.Begin();
+        bool ok = lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, toid);
+        for (int j = 0; ok && j < 3; j++) {
+          auto mode = rng() % 2 == 0 ? LockManager::LockMode::SHARED : LockManager::LockMode::EXCLUSIVE;
+          RID rid{static_cast<page_id_t>(rng() % 6), 0};
+          try {
+            ok = lock_mgr.LockRow(txn, mode, toid, rid);
+          } catch (TransactionAbortException &e) {
+            // Downgrading a lock is not allowed.
+            ok = false;
+          }
+        }
+        if (ok && txn->GetState() != TransactionState::ABORTED) {
+          // A wound that comes in after the last lock rolls the transaction back.
+          if (txn_mgr.Commit(txn)) {
+            committed++;
+          }
+        } else {
+          txn_mgr.Abort(txn);
+        }
+        delete txn;
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back(task, i);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_GT(committed, 0);
+    EXPECT_TRUE(lock_mgr.GetEdgeList().empty());
+  }
+
+  deadlock_policy = saved_policy;
+  cycle_detection_interval = saved_interval;
+}
 }  // namespace bustub
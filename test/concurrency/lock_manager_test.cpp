@@ -4,6 +4,7 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <atomic>
 #include <random>
 #include <thread>  // NOLINT
 
@@ -241,4 +242,65 @@ void TwoPLTest1() {
 
 TEST(LockManagerTest, TwoPLTest1) { TwoPLTest1(); }  // NOLINT
 
+void RowLockManyThreadsTest1() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+
+  /** Rows of many pages, so that they fall in different shards, and a few rows every thread wants */
+  const int num_threads = 8;
+  const int num_rounds = 200;
+  const int num_rows = 256;
+  std::vector<std::atomic<int>> holders(num_rows);
+
+  /** Each round, a transaction X-locks a few rows of its own and a few contended ones, in order, then unlocks them */
+  auto task = [&](int thread_id) {
+    for (int round = 0; round < num_rounds; round++) {
+      auto *txn = txn_mgr.Begin();
+      EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+      std::vector<int> rows{round % 4, num_threads * (round % 8) + thread_id + 4};
+      for (int row : rows) {
+        EXPECT_TRUE(lock_mgr.LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{row, 0}));
+        EXPECT_EQ(0, holders[row]++);
+      }
+      CheckTxnRowLockSize(txn, oid, 0, rows.size());
+      for (int row : rows) {
+        EXPECT_EQ(1, holders[row]--);
+      }
+      txn_mgr.Commit(txn);
+      CheckTxnRowLockSize(txn, oid, 0, 0);
+      delete txn;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(std::thread{task, i});
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  /** Nobody holds the rows any more, so unlocking one is an error */
+  auto *txn = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  EXPECT_THROW(lock_mgr.UnlockRow(txn, oid, RID{0, 0}), TransactionAbortException);
+  CheckAborted(txn);
+  txn_mgr.Abort(txn);
+  delete txn;
+
+  /** The rows can be locked again, with the queues that were kept when they were last unlocked */
+  txn = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  for (int row = 0; row < num_rows; row++) {
+    EXPECT_TRUE(lock_mgr.LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{row, 0}));
+  }
+  CheckTxnRowLockSize(txn, oid, 0, num_rows);
+  txn_mgr.Commit(txn);
+  CheckTxnRowLockSize(txn, oid, 0, 0);
+  delete txn;
+}
+TEST(LockManagerTest, RowLockManyThreadsTest1) { RowLockManyThreadsTest1(); }  // NOLINT
+
 }  // namespace bustub
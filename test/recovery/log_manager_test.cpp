@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_manager.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "catalog/schema.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_reader.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AppendAndFlushTest) {
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16}});
+  Tuple tuple({ValueFactory::GetIntegerValue(42), ValueFactory::GetVarcharValue(std::string("hello"))}, &schema);
+
+  // Scenario: Records get consecutive LSNs and stay in memory until flushed.
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  EXPECT_EQ(0, log_manager->AppendLogRecord(&begin));
+  LogRecord insert(0, begin.GetLSN(), LogRecordType::INSERT, RID(3, 7), tuple);
+  EXPECT_EQ(1, log_manager->AppendLogRecord(&insert));
+  LogRecord commit(0, insert.GetLSN(), LogRecordType::COMMIT);
+  EXPECT_EQ(2, log_manager->AppendLogRecord(&commit));
+  EXPECT_EQ(INVALID_LSN, log_manager->GetPersistentLSN());
+  EXPECT_EQ(0, disk_manager->GetNumFlushes());
+
+  // Scenario: Without a flush thread, Flush() writes the log buffer on the caller's thread.
+  log_manager->Flush(commit.GetLSN());
+  EXPECT_EQ(2, log_manager->GetPersistentLSN());
+  EXPECT_EQ(1, disk_manager->GetNumFlushes());
+  log_manager->Flush(commit.GetLSN());
+  EXPECT_EQ(1, disk_manager->GetNumFlushes());
+
+  // Scenario: The records read back as they were appended, one after the other.
+  LogReader reader(disk_manager.get());
+  LogRecord record;
+  ASSERT_TRUE(reader.Next(&record));
+  EXPECT_EQ(0, record.GetLSN());
+  EXPECT_EQ(LogRecordType::BEGIN, record.GetLogRecordType());
+  EXPECT_EQ(begin.GetSize(), record.GetSize());
+  ASSERT_TRUE(reader.Next(&record));
+  EXPECT_EQ(static_cast<size_t>(begin.GetSize()), reader.GetRecordOffset());
+  EXPECT_EQ(1, record.GetLSN());
+  EXPECT_EQ(0, record.GetTxnId());
+  EXPECT_EQ(0, record.GetPrevLSN());
+  EXPECT_EQ(LogRecordType::INSERT, record.GetLogRecordType());
+  EXPECT_EQ(RID(3, 7), record.GetInsertRID());
+  EXPECT_EQ(42, record.GetInsertTuple().GetValue(&schema, 0).GetAs<int32_t>());
+  EXPECT_EQ("hello", record.GetInsertTuple().GetValue(&schema, 1).ToString());
+  ASSERT_TRUE(reader.Next(&record));
+  EXPECT_EQ(2, record.GetLSN());
+  EXPECT_EQ(LogRecordType::COMMIT, record.GetLogRecordType());
+  EXPECT_FALSE(reader.Next(&record));
+
+  log_manager.reset();
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int num_threads = 8;
+  const int commits_per_thread = 50;
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), log_manager.get());
+
+  log_manager->RunFlushThread();
+  ASSERT_TRUE(enable_logging);
+
+  // Scenario: Every commit returns once its record is on disk, and concurrent commits share flushes.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < commits_per_thread; j++) {
+        auto *txn = txn_manager->Begin();
+        txn_manager->Commit(txn);
+        EXPECT_LE(txn->GetPrevLSN(), log_manager->GetPersistentLSN());
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(2 * num_threads * commits_per_thread, log_manager->GetNextLSN());
+  EXPECT_LE(disk_manager->GetNumFlushes(), num_threads * commits_per_thread);
+
+  // Scenario: Appends that overflow the log buffer wait for the flush thread to make room.
+  LogRecord record(0, INVALID_LSN, LogRecordType::BEGIN);
+  log_manager->AppendLogRecord(&record);
+  int num_records = 3 * LOG_BUFFER_SIZE / record.GetSize();
+  for (int i = 0; i < num_records; i++) {
+    log_manager->AppendLogRecord(&record);
+  }
+
+  // Scenario: Stopping the flush thread flushes whatever is left.
+  log_manager->StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  EXPECT_EQ(log_manager->GetNextLSN() - 1, log_manager->GetPersistentLSN());
+  LogReader reader(disk_manager.get());
+  lsn_t last_lsn = INVALID_LSN;
+  while (reader.Next(&record)) {
+    EXPECT_EQ(last_lsn + 1, record.GetLSN());
+    last_lsn = record.GetLSN();
+  }
+  EXPECT_EQ(log_manager->GetNextLSN() - 1, last_lsn);
+
+  txn_manager.reset();
+  log_manager.reset();
+  disk_manager->ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_reader_test.cpp
+//
+// Identification: test/recovery/log_reader_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_reader.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/util/crc32c.h"
+#include "common/util/varint.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogReaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
+  }
+
+  Schema schema_{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}, Column{"c", TypeId::VARCHAR, 128},
+                  Column{"d", TypeId::BIGINT}}};
+
+  auto MakeTuple(int a, int b) -> Tuple {
+    return Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b),
+                  ValueFactory::GetVarcharValue(std::string(100, 'x')), ValueFactory::GetBigIntValue(a)},
+                 &schema_);
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogReaderTest, EncodingTest) {
+  const std::string check = "123456789";
+  EXPECT_EQ(0xe3069283, Crc32c::Value(check.data(), check.size()));
+  EXPECT_EQ(Crc32c::Value(check.data(), check.size()), Crc32c::Extend(Crc32c::Value(check.data(), 4),
+                                                                      check.data() + 4, check.size() - 4));
+
+  char data[Varint::MAX_SIZE];
+  for (uint32_t value : {0U, 1U, 127U, 128U, 300U, 16383U, 16384U, 0xffffffffU}) {
+    size_t size = Varint::Put(data, value);
+    EXPECT_EQ(Varint::Size(value), size);
+    uint32_t read;
+    EXPECT_EQ(size, Varint::Get(data, size, &read));
+    EXPECT_EQ(value, read);
+    EXPECT_EQ(0, Varint::Get(data, size - 1, &read));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogReaderTest, RoundTripTest) {
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+
+  // Enough records that their LSNs take more than one byte, of every type.
+  const int num_rounds = 50;
+  std::vector<LogRecord> records;
+  for (int i = 0; i < num_rounds; i++) {
+    lsn_t prev_lsn = log_manager->GetNextLSN() - 1;
+    records.emplace_back(i, INVALID_LSN, LogRecordType::BEGIN);
+    records.emplace_back(i, prev_lsn + 1, LogRecordType::INSERT, RID(i, 2 * i), MakeTuple(i, 0));
+    records.emplace_back(i, prev_lsn + 2, LogRecordType::MARKDELETE, RID(i, 2 * i), MakeTuple(i, 0));
+    records.emplace_back(i, prev_lsn + 3, LogRecordType::UPDATE, RID(i, 2 * i), MakeTuple(i, 0), MakeTuple(i, 1));
+    records.emplace_back(INVALID_TXN_ID, INVALID_LSN, LogRecordType::NEWPAGE, i == 0 ? INVALID_PAGE_ID : i - 1, i);
+    records.emplace_back(INVALID_TXN_ID, prev_lsn, LogRecordType::CHECKPOINT_TABLES,
+                         std::vector<std::pair<txn_id_t, lsn_t>>{{i, prev_lsn + 4}},
+                         std::vector<std::pair<page_id_t, lsn_t>>{{i, prev_lsn + 2}, {i + 1000, INVALID_LSN}});
+    records.emplace_back(i, prev_lsn + 4, LogRecordType::COMMIT);
+    for (size_t j = records.size() - 7; j < records.size(); j++) {
+      log_manager->AppendLogRecord(&records[j]);
+    }
+  }
+  log_manager->Flush(log_manager->GetNextLSN() - 1);
+
+  // Scenario: Read with chunks much smaller than the records, every record straddles a chunk boundary.
+  for (size_t chunk_size : {size_t{7}, size_t{LOG_BUFFER_SIZE}}) {
+    LogReader reader(disk_manager.get(), 0, chunk_size);
+    size_t offset = 0;
+    for (auto &expected : records) {
+      LogRecord record;
+      ASSERT_TRUE(reader.Next(&record));
+      EXPECT_EQ(offset, reader.GetRecordOffset());
+      offset += expected.GetSize();
+      EXPECT_EQ(expected.GetSize(), record.GetSize());
+      EXPECT_EQ(expected.GetLSN(), record.GetLSN());
+      EXPECT_EQ(expected.GetTxnId(), record.GetTxnId());
+      EXPECT_EQ(expected.GetPrevLSN(), record.GetPrevLSN());
+      ASSERT_EQ(expected.GetLogRecordType(), record.GetLogRecordType());
+      switch (record.GetLogRecordType()) {
+        case LogRecordType::INSERT:
+          EXPECT_EQ(expected.GetInsertRID(), record.GetInsertRID());
+          EXPECT_EQ(expected.GetInsertTuple().GetLength(), record.GetInsertTuple().GetLength());
+          EXPECT_EQ(record.GetTxnId(), record.GetInsertTuple().GetValue(&schema_, 3).GetAs<int64_t>());
+          break;
+        case LogRecordType::MARKDELETE:
+          EXPECT_EQ(expected.GetDeleteRID(), record.GetDeleteRID());
+          break;
+        case LogRecordType::UPDATE: {
+          EXPECT_EQ(expected.GetUpdateRID(), record.GetUpdateRID());
+          Tuple tuple = MakeTuple(record.GetTxnId(), 0);
+          ASSERT_TRUE(record.ApplyUpdate(&tuple, true));
+          EXPECT_EQ(1, tuple.GetValue(&schema_, 1).GetAs<int32_t>());
+          EXPECT_EQ(record.GetTxnId(), tuple.GetValue(&schema_, 0).GetAs<int32_t>());
+          ASSERT_TRUE(record.ApplyUpdate(&tuple, false));
+          EXPECT_EQ(0, tuple.GetValue(&schema_, 1).GetAs<int32_t>());
+          break;
+        }
+        case LogRecordType::NEWPAGE:
+          EXPECT_EQ(expected.GetNewPageRecord(), record.GetNewPageRecord());
+          break;
+        case LogRecordType::CHECKPOINT_TABLES:
+          EXPECT_EQ(expected.GetActiveTxns(), record.GetActiveTxns());
+          EXPECT_EQ(expected.GetDirtyPages(), record.GetDirtyPages());
+          break;
+        default:
+          break;
+      }
+    }
+    LogRecord record;
+    EXPECT_FALSE(reader.Next(&record));
+    EXPECT_EQ(offset, reader.GetOffset());
+  }
+
+  log_manager.reset();
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogReaderTest, UpdateDeltaTest) {
+  // Scenario: A one-column update logs the bytes of that column, not both whole tuples.
+  Tuple old_tuple = MakeTuple(1, 2);
+  Tuple new_tuple = MakeTuple(1, 3);
+  LogRecord update(0, INVALID_LSN, LogRecordType::UPDATE, RID(0, 0), old_tuple, new_tuple);
+  ASSERT_EQ(1, update.GetUpdateRanges().size());
+  EXPECT_EQ(1, update.GetUpdateRanges()[0].new_data_.size());
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  log_manager->AppendLogRecord(&update);
+  EXPECT_LT(update.GetSize(), 24);
+  EXPECT_GT(old_tuple.GetLength(), 100);
+
+  // Scenario: Updates that change the size of the tuple log both tuples.
+  Tuple longer({ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(2),
+                ValueFactory::GetVarcharValue(std::string(120, 'x')), ValueFactory::GetBigIntValue(1)},
+               &schema_);
+  LogRecord resize(0, INVALID_LSN, LogRecordType::UPDATE, RID(0, 0), old_tuple, longer);
+  EXPECT_TRUE(resize.GetUpdateRanges().empty());
+  log_manager->AppendLogRecord(&resize);
+  EXPECT_GT(resize.GetSize(), old_tuple.GetLength() + longer.GetLength());
+  log_manager->Flush(resize.GetLSN());
+
+  LogReader reader(disk_manager.get());
+  LogRecord record;
+  ASSERT_TRUE(reader.Next(&record));
+  Tuple tuple = old_tuple;
+  ASSERT_TRUE(record.ApplyUpdate(&tuple, true));
+  EXPECT_EQ(3, tuple.GetValue(&schema_, 1).GetAs<int32_t>());
+  EXPECT_FALSE(record.ApplyUpdate(&longer, true));
+  ASSERT_TRUE(reader.Next(&record));
+  tuple = old_tuple;
+  ASSERT_TRUE(record.ApplyUpdate(&tuple, true));
+  EXPECT_EQ(longer.GetLength(), tuple.GetLength());
+  ASSERT_TRUE(record.ApplyUpdate(&tuple, false));
+  EXPECT_EQ(old_tuple.GetLength(), tuple.GetLength());
+
+  log_manager.reset();
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogReaderTest, TornRecordTest) {
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  std::vector<LogRecord> records;
+  for (int i = 0; i < 3; i++) {
+    records.emplace_back(0, INVALID_LSN, LogRecordType::INSERT, RID(0, i), MakeTuple(i, i));
+    log_manager->AppendLogRecord(&records.back());
+  }
+  log_manager->Flush(records.back().GetLSN());
+  log_manager.reset();
+  disk_manager->ShutDown();
+
+  // Scenario: A byte of the second record did not make it to disk. Reading stops right before it.
+  {
+    std::fstream log("test.log.000000", std::ios::binary | std::ios::in | std::ios::out);
+    int offset = records[0].GetSize() + records[1].GetSize() / 2;
+    log.seekg(offset);
+    char byte = static_cast<char>(log.get() ^ 0xff);
+    log.seekp(offset);
+    log.put(byte);
+  }
+  disk_manager = std::make_unique<DiskManager>("test.db");
+  LogReader reader(disk_manager.get());
+  LogRecord record;
+  ASSERT_TRUE(reader.Next(&record));
+  EXPECT_EQ(0, record.GetLSN());
+  EXPECT_FALSE(reader.Next(&record));
+  EXPECT_EQ(static_cast<size_t>(records[0].GetSize()), reader.GetOffset());
+
+  disk_manager->ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,320 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_recovery_test.cpp
+//
+// Identification: test/recovery/log_recovery_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_recovery.h"
+
+#include <unistd.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/checkpoint_manager.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogRecoveryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
+  }
+
+  /** @return the tuples of the table starting at first_page_id, following the page links */
+  static auto ReadTable(BufferPoolManager *bpm, page_id_t first_page_id) -> std::vector<std::pair<TupleMeta, Tuple>> {
+    std::vector<std::pair<TupleMeta, Tuple>> tuples;
+    for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+      auto guard = bpm->FetchPageRead(page_id);
+      auto page = guard.As<TablePage>();
+      for (uint32_t slot = 0; slot < page->GetNumTuples(); slot++) {
+        tuples.push_back(page->GetTuple(RID(page_id, slot)));
+      }
+      page_id = page->GetNextPageId();
+    }
+    return tuples;
+  }
+
+  Schema schema_{{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+
+  auto MakeTuple(int a) -> Tuple {
+    std::string b(48, static_cast<char>('a' + (a + 26) % 26));
+    return Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b)}, &schema_);
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogRecoveryTest, RedoUndoTest) {
+  const int num_tuples = 300;
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), LRUK_REPLACER_K, log_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), log_manager.get());
+  log_manager->RunFlushThread();
+
+  // A committed transaction fills several pages, then a loser deletes, updates and inserts tuples.
+  auto heap = std::make_unique<TableHeap>(bpm.get(), log_manager.get());
+  page_id_t first_page_id = heap->GetFirstPageId();
+  auto *winner = txn_manager->Begin();
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    rids.push_back(*heap->InsertTuple(TupleMeta{winner->GetTransactionId(), INVALID_TXN_ID, false}, MakeTuple(i),
+                                      winner));
+  }
+  ASSERT_GT(rids.back().GetPageId(), first_page_id);
+  txn_manager->Commit(winner);
+
+  auto *loser = txn_manager->Begin();
+  heap->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, loser->GetTransactionId(), true}, rids[0], loser);
+  heap->UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(1000 + 1), rids[1],
+                                 loser);
+  heap->InsertTuple(TupleMeta{loser->GetTransactionId(), INVALID_TXN_ID, false}, MakeTuple(-1), loser);
+  // Steal: the loser's changes to the first page reach the disk before it ends.
+  bpm->FlushPage(first_page_id);
+
+  // Scenario: Crash. The log is on disk, up to the loser's last change, but most pages are not.
+  log_manager->StopFlushThread();
+  txn_id_t loser_id = loser->GetTransactionId();
+  lsn_t loser_last_lsn = loser->GetPrevLSN();
+  heap.reset();
+  bpm.reset();
+  txn_manager.reset();
+  log_manager.reset();
+  delete winner;
+  delete loser;
+
+  log_manager = std::make_unique<LogManager>(disk_manager.get());
+  bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), LRUK_REPLACER_K, log_manager.get());
+
+  // Scenario: Analysis finds the loser and every page of the table.
+  LogRecovery recovery(disk_manager.get(), bpm.get(), log_manager.get(), 3);
+  recovery.Analyze();
+  ASSERT_EQ(1, recovery.GetActiveTxns().size());
+  EXPECT_EQ(loser_last_lsn, recovery.GetActiveTxns().at(loser_id));
+  EXPECT_EQ(loser_last_lsn + 1, log_manager->GetNextLSN());
+  EXPECT_EQ(0, recovery.GetDirtyPageTable().at(first_page_id));
+  EXPECT_EQ(1, recovery.GetDirtyPageTable().count(rids.back().GetPageId()));
+
+  // Scenario: Redo brings back every change, including the loser's, on the pages that never made it to disk.
+  recovery.Redo();
+  auto tuples = ReadTable(bpm.get(), first_page_id);
+  ASSERT_EQ(num_tuples + 1, tuples.size());
+  EXPECT_TRUE(tuples[0].first.is_deleted_);
+  EXPECT_EQ(1001, tuples[1].second.GetValue(&schema_, 0).GetAs<int32_t>());
+  EXPECT_EQ(-1, tuples.back().second.GetValue(&schema_, 0).GetAs<int32_t>());
+
+  // Scenario: Undo rolls the loser back, and logs that it is aborted.
+  recovery.Undo();
+  tuples = ReadTable(bpm.get(), first_page_id);
+  ASSERT_EQ(num_tuples + 1, tuples.size());
+  for (int i = 0; i < num_tuples; i++) {
+    EXPECT_FALSE(tuples[i].first.is_deleted_);
+    EXPECT_EQ(i, tuples[i].second.GetValue(&schema_, 0).GetAs<int32_t>());
+    EXPECT_EQ(MakeTuple(i).GetValue(&schema_, 1).ToString(), tuples[i].second.GetValue(&schema_, 1).ToString());
+  }
+  EXPECT_TRUE(tuples.back().first.is_deleted_);
+  EXPECT_EQ(loser_last_lsn + 1, log_manager->GetPersistentLSN());
+
+  // Scenario: Recovering again finds nothing to undo, and redo leaves the pages as they are.
+  bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), LRUK_REPLACER_K, log_manager.get());
+  LogRecovery again(disk_manager.get(), bpm.get(), log_manager.get());
+  again.Redo();
+  EXPECT_TRUE(again.GetActiveTxns().empty());
+  tuples = ReadTable(bpm.get(), first_page_id);
+  ASSERT_EQ(num_tuples + 1, tuples.size());
+  EXPECT_FALSE(tuples[0].first.is_deleted_);
+  EXPECT_EQ(1, tuples[1].second.GetValue(&schema_, 0).GetAs<int32_t>());
+  EXPECT_TRUE(tuples.back().first.is_deleted_);
+
+  bpm.reset();
+  log_manager.reset();
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogRecoveryTest, FuzzyCheckpointTest) {
+  const int num_tuples = 300;
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), LRUK_REPLACER_K, log_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), log_manager.get());
+  auto checkpoint_manager = std::make_unique<CheckpointManager>(txn_manager.get(), log_manager.get(), bpm.get());
+  log_manager->RunFlushThread();
+
+  auto heap = std::make_unique<TableHeap>(bpm.get(), log_manager.get());
+  page_id_t first_page_id = heap->GetFirstPageId();
+  auto *winner = txn_manager->Begin();
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    rids.push_back(*heap->InsertTuple(TupleMeta{winner->GetTransactionId(), INVALID_TXN_ID, false}, MakeTuple(i),
+                                      winner));
+  }
+  page_id_t last_page_id = rids.back().GetPageId();
+  txn_manager->Commit(winner);
+
+  // Scenario: The pages dirty when a checkpoint begins are written back once it ends.
+  auto dirty_pages = bpm->GetDirtyPageTable();
+  ASSERT_FALSE(dirty_pages.empty());
+  checkpoint_manager->Checkpoint();
+  lsn_t first_checkpoint_lsn = checkpoint_manager->GetLastCheckpointLSN();
+  ASSERT_NE(INVALID_LSN, first_checkpoint_lsn);
+  for (const auto &[page_id, rec_lsn] : dirty_pages) {
+    EXPECT_LT(rec_lsn, first_checkpoint_lsn);
+  }
+  EXPECT_TRUE(bpm->GetDirtyPageTable().empty());
+
+  // Scenario: A checkpoint taken while a transaction is running records it, and the page it changed, without waiting.
+  auto *loser = txn_manager->Begin();
+  heap->UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(1000 + 1), rids[1],
+                                 loser);
+  lsn_t update_lsn = loser->GetPrevLSN();
+  ASSERT_EQ(1, txn_manager->GetActiveTransactionTable().size());
+  checkpoint_manager->Checkpoint();
+  lsn_t checkpoint_lsn = checkpoint_manager->GetLastCheckpointLSN();
+  EXPECT_GT(checkpoint_lsn, update_lsn);
+  heap->InsertTuple(TupleMeta{loser->GetTransactionId(), INVALID_TXN_ID, false}, MakeTuple(-1), loser);
+  lsn_t insert_lsn = loser->GetPrevLSN();
+  ASSERT_EQ(1, bpm->GetDirtyPageTable().size());
+
+  // Scenario: Crash.
+  log_manager->StopFlushThread();
+  txn_id_t loser_id = loser->GetTransactionId();
+  checkpoint_manager.reset();
+  heap.reset();
+  bpm.reset();
+  txn_manager.reset();
+  log_manager.reset();
+  delete winner;
+  delete loser;
+
+  log_manager = std::make_unique<LogManager>(disk_manager.get());
+  bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), LRUK_REPLACER_K, log_manager.get());
+
+  // Scenario: Analysis takes the tables of the last checkpoint, plus the pages changed since it began.
+  LogRecovery recovery(disk_manager.get(), bpm.get(), log_manager.get());
+  recovery.Analyze();
+  EXPECT_EQ(checkpoint_lsn, recovery.GetCheckpointLSN());
+  ASSERT_EQ(1, recovery.GetActiveTxns().size());
+  EXPECT_EQ(insert_lsn, recovery.GetActiveTxns().at(loser_id));
+  const auto &dirty_page_table = recovery.GetDirtyPageTable();
+  EXPECT_EQ(update_lsn, dirty_page_table.at(rids[1].GetPageId()));
+  EXPECT_EQ(insert_lsn, dirty_page_table.at(last_page_id));
+  EXPECT_LE(dirty_page_table.size(), 2);
+
+  // Scenario: Redo and undo leave the table as the winner committed it.
+  recovery.Redo();
+  recovery.Undo();
+  auto tuples = ReadTable(bpm.get(), first_page_id);
+  ASSERT_EQ(num_tuples + 1, tuples.size());
+  for (int i = 0; i < num_tuples; i++) {
+    EXPECT_FALSE(tuples[i].first.is_deleted_);
+    EXPECT_EQ(i, tuples[i].second.GetValue(&schema_, 0).GetAs<int32_t>());
+  }
+  EXPECT_TRUE(tuples.back().first.is_deleted_);
+
+  bpm.reset();
+  log_manager.reset();
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogRecoveryTest, TruncateTest) {
+  const int num_rounds = 30;
+  const int tuples_per_round = 100;
+  const int loser_round = num_rounds - 5;
+  size_t saved_segment_size = log_segment_size;
+  log_segment_size = 4 * BUSTUB_PAGE_SIZE;
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), LRUK_REPLACER_K, log_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), log_manager.get());
+  auto checkpoint_manager = std::make_unique<CheckpointManager>(txn_manager.get(), log_manager.get(), bpm.get());
+  log_manager->RunFlushThread();
+
+  // Scenario: A checkpoint after each round of inserts drops the segments only the rounds before it need, but none
+  // that a transaction still running needs.
+  auto heap = std::make_unique<TableHeap>(bpm.get(), log_manager.get());
+  page_id_t first_page_id = heap->GetFirstPageId();
+  Transaction *loser = nullptr;
+  for (int round = 0; round < num_rounds; round++) {
+    if (round == loser_round) {
+      loser = txn_manager->Begin();
+      heap->InsertTuple(TupleMeta{loser->GetTransactionId(), INVALID_TXN_ID, false}, MakeTuple(-1), loser);
+    }
+    auto *txn = txn_manager->Begin();
+    for (int i = 0; i < tuples_per_round; i++) {
+      heap->InsertTuple(TupleMeta{txn->GetTransactionId(), INVALID_TXN_ID, false},
+                        MakeTuple(round * tuples_per_round + i), txn);
+    }
+    txn_manager->Commit(txn);
+    delete txn;
+    checkpoint_manager->Checkpoint();
+  }
+  lsn_t checkpoint_lsn = checkpoint_manager->GetLastCheckpointLSN();
+  EXPECT_GT(disk_manager->GetLogStart(), 0U);
+  EXPECT_NE(0, access("test.log.000000", F_OK));
+
+  // Scenario: Crash, and restart.
+  log_manager->StopFlushThread();
+  txn_id_t loser_id = loser->GetTransactionId();
+  checkpoint_manager.reset();
+  heap.reset();
+  bpm.reset();
+  txn_manager.reset();
+  log_manager.reset();
+  delete loser;
+  disk_manager->ShutDown();
+  disk_manager = std::make_unique<DiskManager>("test.db");
+  log_manager = std::make_unique<LogManager>(disk_manager.get());
+  bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get(), LRUK_REPLACER_K, log_manager.get());
+
+  // Scenario: Recovery reads what is left of the log, and rolls the loser back from its first record.
+  LogRecovery recovery(disk_manager.get(), bpm.get(), log_manager.get());
+  recovery.Analyze();
+  EXPECT_EQ(checkpoint_lsn, recovery.GetCheckpointLSN());
+  ASSERT_EQ(1, recovery.GetActiveTxns().size());
+  EXPECT_EQ(1, recovery.GetActiveTxns().count(loser_id));
+  recovery.Redo();
+  recovery.Undo();
+  int expected = 0;
+  for (const auto &[meta, tuple] : ReadTable(bpm.get(), first_page_id)) {
+    int value = tuple.GetValue(&schema_, 0).GetAs<int32_t>();
+    EXPECT_EQ(value == -1, meta.is_deleted_);
+    if (!meta.is_deleted_) {
+      EXPECT_EQ(expected++, value);
+    }
+  }
+  EXPECT_EQ(num_rounds * tuples_per_round, expected);
+
+  bpm.reset();
+  log_manager.reset();
+  disk_manager->ShutDown();
+  log_segment_size = saved_segment_size;
+}
+
+}  // namespace bustub
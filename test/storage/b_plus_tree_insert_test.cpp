@@ -125,9 +125,6 @@ TEST(BPlusTreeTests, InsertTest2) {
   EXPECT_EQ(size, keys.size());
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  for (auto i : bpm->replacer_->node_store_) {
-    std::cout << i.second.is_evictable_ << std::endl;
-  }
   delete transaction;
   delete bpm;
 }
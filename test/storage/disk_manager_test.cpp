@@ -10,11 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <vector>
 
+#include "buffer/buffer_pool_manager.h"
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_posix.h"
+#include "storage/disk/disk_manager_uring.h"
 
 namespace bustub {
 
@@ -23,13 +30,15 @@ class DiskManagerTest : public ::testing::Test {
   // This function is called before every test.
   void SetUp() override {
     remove("test.db");
-    remove("test.log");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
-    remove("test.log");
+    LogFile::Remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -72,6 +81,215 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixReadWritePageTest) {
+  for (bool direct_io : {false, true}) {
+    char buf[BUSTUB_PAGE_SIZE] = {0};
+    char data[BUSTUB_PAGE_SIZE] = {0};
+    std::string db_file("test.db");
+    auto dm = DiskManagerPosix(db_file, direct_io);
+    std::strncpy(data, "A test string.", sizeof(data));
+
+    dm.ReadPage(0, buf);  // tolerate empty read
+
+    dm.WritePage(0, data);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+    // pages that were never written read as zeros, even inside the file
+    std::memset(buf, 0, sizeof(buf));
+    dm.WritePage(5, data);
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(buf[0], 0);
+    dm.ReadPage(6, buf);
+    EXPECT_EQ(buf[0], 0);
+    EXPECT_EQ(dm.GetNumWrites(), 2);
+
+    dm.ShutDown();
+
+    // the pages are persisted and readable through the fstream disk manager
+    auto dm2 = DiskManager(db_file);
+    dm2.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm2.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, UringReadWritePagesTest) {
+  const size_t num_pages = 100;
+  std::string db_file("test.db");
+  auto dm = DiskManagerUring(db_file, false, 16);
+
+  // a batch larger than the ring is split into several submissions
+  std::vector<std::string> pages(num_pages, std::string(BUSTUB_PAGE_SIZE, '\0'));
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> page_data;
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    page_ids.push_back(static_cast<page_id_t>(num_pages - 1 - i));
+    page_data.push_back(pages[num_pages - 1 - i].data());
+  }
+  dm.WritePages(page_ids, page_data);
+
+  // duplicate pages in a batch are written in order
+  std::string last(BUSTUB_PAGE_SIZE, 'x');
+  dm.WritePages({3, 3}, {pages[4].data(), last.data()});
+
+  std::vector<std::string> bufs(num_pages + 2, std::string(BUSTUB_PAGE_SIZE, 'y'));
+  page_ids.clear();
+  page_data.clear();
+  for (size_t i = 0; i < num_pages + 2; i++) {
+    page_ids.push_back(static_cast<page_id_t>(i));
+    page_data.push_back(bufs[i].data());
+  }
+  dm.ReadPages(page_ids, page_data);
+  for (size_t i = 0; i < num_pages; i++) {
+    EXPECT_EQ(bufs[i], i == 3 ? last : pages[i]);
+  }
+  // pages past the end of the file read as zeros
+  EXPECT_EQ(bufs[num_pages], std::string(BUSTUB_PAGE_SIZE, '\0'));
+
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  dm.ReadPage(7, buf);
+  EXPECT_EQ(std::memcmp(buf, pages[7].data(), sizeof(buf)), 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, UringFallbackOrderTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManagerUring(db_file, true, 16);
+
+  // With O_DIRECT the unaligned buffer goes through pwrite, it must still land before the later write of the page.
+  std::vector<char> unaligned(BUSTUB_PAGE_SIZE + 1, 'u');
+  auto *aligned = static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE));
+  memset(aligned, 'a', BUSTUB_PAGE_SIZE);
+  dm.WritePages({5, 5}, {unaligned.data() + 1, aligned});
+
+  std::string buf(BUSTUB_PAGE_SIZE, '\0');
+  dm.ReadPage(5, buf.data());
+  EXPECT_EQ(buf, std::string(BUSTUB_PAGE_SIZE, 'a'));
+
+  std::free(aligned);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapPageViewTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  auto dm = DiskManagerMmap("test.db");
+
+  // pages past the end of the file have no view, and show up once they are written
+  EXPECT_EQ(nullptr, dm.GetPageView(0));
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    EXPECT_EQ(page_id, dm.GetFreePageMap()->AllocatePage());
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+  char *view = dm.GetPageView(2);
+  ASSERT_NE(nullptr, view);
+  EXPECT_STREQ("page 2", view);
+  EXPECT_EQ(dm.GetPageView(0) + 2 * BUSTUB_PAGE_SIZE, view);
+
+  // the view sees writes to the file, and changes made through it stay private until they are written back
+  snprintf(data, sizeof(data), "page 2 v2");
+  dm.WritePage(2, data);
+  EXPECT_STREQ("page 2 v2", view);
+  snprintf(view, BUSTUB_PAGE_SIZE, "page 2 v3");
+  dm.ReadPage(2, buf);
+  EXPECT_STREQ("page 2 v2", buf);
+  dm.WritePage(2, view);
+  dm.ReleasePageView(2);
+  EXPECT_STREQ("page 2 v3", view);
+  dm.ReadPage(2, buf);
+  EXPECT_STREQ("page 2 v3", buf);
+
+  // changes that are not written back are dropped on release
+  snprintf(view, BUSTUB_PAGE_SIZE, "scratch");
+  dm.ReleasePageView(2);
+  EXPECT_STREQ("page 2 v3", view);
+
+  // compaction unmaps the pages it truncates
+  EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, dm.GetMappedSize());
+  dm.GetFreePageMap()->DeallocatePage(3);
+  EXPECT_EQ(3, dm.Compact());
+  EXPECT_EQ(3 * BUSTUB_PAGE_SIZE, dm.GetMappedSize());
+  EXPECT_EQ(nullptr, dm.GetPageView(3));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapBufferPoolTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 16;
+  auto dm = DiskManagerMmap("test.db");
+  {
+    BufferPoolManager bpm(buffer_pool_size, &dm);
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto guard = bpm.NewPageGuarded(&page_id);
+      snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    }
+    bpm.FlushAllPages();
+  }
+
+  // Scenario: misses on pages of the file use the mapping and read nothing.
+  BufferPoolManager bpm(buffer_pool_size, &dm);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); page_id++) {
+    auto guard = bpm.FetchPageRead(page_id);
+    EXPECT_EQ(dm.GetPageView(page_id), guard.GetData());
+    EXPECT_EQ(0, strcmp(guard.GetData(), ("page " + std::to_string(page_id)).c_str()));
+  }
+  auto stats = bpm.GetStats();
+  EXPECT_EQ(num_pages, stats.misses_);
+  EXPECT_EQ(0, stats.read_latency_.count_);
+
+  // Scenario: a page modified through its view is written back on eviction, and its private copy dropped.
+  {
+    auto guard = bpm.FetchPageWrite(0);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page 0 modified");
+  }
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(num_pages); page_id++) {
+    bpm.FetchPageRead(page_id);
+  }
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  dm.ReadPage(0, buf);
+  EXPECT_STREQ("page 0 modified", buf);
+  EXPECT_STREQ("page 0 modified", bpm.FetchPageRead(0).GetData());
+
+  // Scenario: a modified page written back before it is evicted clean still has its private copy dropped, so the view
+  // shows the file again.
+  {
+    auto guard = bpm.FetchPageWrite(2);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "page 2 modified");
+  }
+  EXPECT_TRUE(bpm.FlushPage(2));
+  for (page_id_t page_id = 3; page_id < static_cast<page_id_t>(num_pages); page_id++) {
+    bpm.FetchPageRead(page_id);
+  }
+  snprintf(buf, BUSTUB_PAGE_SIZE, "page 2 rewritten");
+  dm.WritePage(2, buf);
+  EXPECT_STREQ("page 2 rewritten", dm.GetPageView(2));
+
+  // Scenario: new pages past the end of the file live in the frames, and deleted pages lose their view.
+  page_id_t page_id;
+  {
+    auto guard = bpm.NewPageGuarded(&page_id);
+    EXPECT_EQ(num_pages, page_id);
+    EXPECT_EQ(nullptr, dm.GetPageView(page_id));
+    EXPECT_LE(bpm.frame_arena_->GetFrame(0), guard.GetData());
+    EXPECT_GT(bpm.frame_arena_->GetFrame(buffer_pool_size), guard.GetData());
+  }
+  EXPECT_TRUE(bpm.DeletePage(1));
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto promise1 = disk_scheduler->CreatePromise();
+  auto future1 = promise1.get_future();
+  auto promise2 = disk_scheduler->CreatePromise();
+  auto future2 = promise2.get_future();
+
+  // Requests for the same page are executed in order, so the read sees the write.
+  disk_scheduler->Schedule({/*is_write=*/true, data, /*page_id=*/0, std::move(promise1)});
+  disk_scheduler->Schedule({/*is_write=*/false, buf, /*page_id=*/0, std::move(promise2)});
+
+  ASSERT_TRUE(future1.get());
+  ASSERT_TRUE(future2.get());
+
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  disk_scheduler = nullptr;  // Call the DiskScheduler destructor to finish all scheduled jobs.
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleBatchTest) {
+  const size_t num_pages = 16;
+  const size_t num_workers = 4;
+
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get(), num_workers);
+  ASSERT_EQ(num_workers, disk_scheduler->GetNumWorkers());
+
+  std::vector<std::string> pages(num_pages, std::string(BUSTUB_PAGE_SIZE, '\0'));
+  std::vector<std::string> bufs(num_pages, std::string(BUSTUB_PAGE_SIZE, '\0'));
+  std::vector<DiskRequest> writes;
+  std::vector<std::future<bool>> futures;
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    auto promise = disk_scheduler->CreatePromise();
+    futures.push_back(promise.get_future());
+    writes.push_back({true, pages[i].data(), static_cast<page_id_t>(i), std::move(promise)});
+  }
+  disk_scheduler->Schedule(std::move(writes));
+
+  std::vector<DiskRequest> reads;
+  for (size_t i = 0; i < num_pages; i++) {
+    auto promise = disk_scheduler->CreatePromise();
+    futures.push_back(promise.get_future());
+    reads.push_back({false, bufs[i].data(), static_cast<page_id_t>(i), std::move(promise)});
+  }
+  disk_scheduler->Schedule(std::move(reads));
+
+  for (auto &future : futures) {
+    ASSERT_TRUE(future.get());
+  }
+  for (size_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(pages[i], bufs[i]);
+  }
+
+  disk_scheduler = nullptr;
+  dm->ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,181 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map_test.cpp
+//
+// Identification: test/storage/free_page_map_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/free_page_map.h"
+
+namespace bustub {
+
+class FreePageMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override { RemoveFiles(); }
+
+  void TearDown() override { RemoveFiles(); }
+
+  static void RemoveFiles() {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, ReuseTest) {
+  FreePageMap free_page_map;
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    EXPECT_EQ(page_id, free_page_map.AllocatePage());
+  }
+  EXPECT_EQ(10, free_page_map.GetNumPages());
+  EXPECT_EQ(0, free_page_map.GetNumFreePages());
+
+  // Deallocated pages are handed out again, lowest first, before the file grows.
+  free_page_map.DeallocatePage(7);
+  free_page_map.DeallocatePage(3);
+  free_page_map.DeallocatePage(3);
+  free_page_map.DeallocatePage(42);
+  EXPECT_EQ(2, free_page_map.GetNumFreePages());
+  EXPECT_TRUE(free_page_map.IsFree(3));
+  EXPECT_FALSE(free_page_map.IsFree(4));
+  EXPECT_EQ(3, free_page_map.AllocatePage());
+  EXPECT_EQ(7, free_page_map.AllocatePage());
+  EXPECT_EQ(10, free_page_map.AllocatePage());
+
+  // With a stride, only page ids of the requested residue are handed out; skipped ones become free for the others.
+  EXPECT_EQ(13, free_page_map.AllocatePage(1, 4));
+  EXPECT_EQ(2, free_page_map.GetNumFreePages());
+  EXPECT_EQ(12, free_page_map.AllocatePage(0, 4));
+  EXPECT_EQ(17, free_page_map.AllocatePage(1, 4));
+  EXPECT_EQ(11, free_page_map.AllocatePage());
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, PersistAndCompactTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  {
+    DiskManager disk_manager("test.db");
+    auto *free_page_map = disk_manager.GetFreePageMap();
+    for (page_id_t page_id = 0; page_id < 6; page_id++) {
+      ASSERT_EQ(page_id, free_page_map->AllocatePage());
+      disk_manager.WritePage(page_id, data);
+    }
+    free_page_map->DeallocatePage(1);
+    free_page_map->DeallocatePage(4);
+    free_page_map->DeallocatePage(5);
+    disk_manager.ShutDown();
+  }
+
+  // The free pages survive a restart.
+  {
+    DiskManager disk_manager("test.db");
+    auto *free_page_map = disk_manager.GetFreePageMap();
+    EXPECT_EQ(6, free_page_map->GetNumPages());
+    EXPECT_EQ(3, free_page_map->GetNumFreePages());
+    EXPECT_TRUE(free_page_map->IsFree(1));
+    EXPECT_TRUE(free_page_map->IsFree(5));
+
+    // Compaction drops the trailing free pages and truncates the database file.
+    EXPECT_EQ(4, disk_manager.Compact());
+    EXPECT_EQ(1, free_page_map->GetNumFreePages());
+    struct stat stat_buf;
+    ASSERT_EQ(0, stat("test.db", &stat_buf));
+    EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, stat_buf.st_size);
+    disk_manager.ShutDown();
+  }
+
+  {
+    DiskManager disk_manager("test.db");
+    auto *free_page_map = disk_manager.GetFreePageMap();
+    EXPECT_EQ(4, free_page_map->GetNumPages());
+    EXPECT_EQ(1, free_page_map->AllocatePage());
+    EXPECT_EQ(4, free_page_map->AllocatePage());
+    disk_manager.ShutDown();
+  }
+
+  // A map left behind by a deleted database file is discarded.
+  remove("test.db");
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(0, disk_manager.GetFreePageMap()->GetNumPages());
+    disk_manager.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, BatchedWriteTest) {
+  FreePageMap free_page_map("test.fsm", 0);
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    ASSERT_EQ(page_id, free_page_map.AllocatePage());
+  }
+  free_page_map.Flush();
+  free_page_map.DeallocatePage(2);
+
+  // Deallocations stay in memory until the next flush.
+  {
+    FreePageMap on_disk("test.fsm", 4);
+    EXPECT_EQ(0, on_disk.GetNumFreePages());
+  }
+  free_page_map.Flush();
+  {
+    FreePageMap on_disk("test.fsm", 4);
+    EXPECT_TRUE(on_disk.IsFree(2));
+  }
+
+  // Reusing a page is on disk right away, so a crash cannot hand the page out twice.
+  ASSERT_EQ(2, free_page_map.AllocatePage());
+  {
+    FreePageMap on_disk("test.fsm", 4);
+    EXPECT_FALSE(on_disk.IsFree(2));
+    EXPECT_EQ(0, on_disk.GetNumFreePages());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, BufferPoolReuseTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(4, disk_manager.get());
+
+  page_id_t page_id0;
+  page_id_t page_id1;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id0));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id1));
+  EXPECT_TRUE(bpm->UnpinPage(page_id0, true));
+  EXPECT_TRUE(bpm->UnpinPage(page_id1, true));
+
+  // A deleted page id is reused by the next new page, whether or not the page was resident.
+  EXPECT_TRUE(bpm->DeletePage(page_id0));
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(page_id0, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  bpm->FlushAllPages();
+  bpm = std::make_unique<BufferPoolManager>(4, disk_manager.get());
+  EXPECT_TRUE(bpm->DeletePage(page_id1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(page_id1, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // A buffer pool on the same disk manager continues after the pages allocated before.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(2, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+}
+
+}  // namespace bustub
@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_file_test.cpp
+//
+// Identification: test/storage/log_file_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/log_file.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+class LogFileTest : public ::testing::Test {
+ protected:
+  static constexpr size_t SEGMENT_SIZE = 4096;
+
+  void SetUp() override {
+    LogFile::Remove("test.log");
+    saved_segment_size_ = log_segment_size;
+    log_segment_size = SEGMENT_SIZE;
+  }
+
+  void TearDown() override {
+    log_segment_size = saved_segment_size_;
+    LogFile::Remove("test.log");
+  }
+
+  static auto SegmentName(size_t segment) -> std::string { return fmt::format("test.log.{:06}", segment); }
+
+  static auto FileSize(const std::string &file_name) -> int64_t {
+    struct stat stat_buf;
+    return stat(file_name.c_str(), &stat_buf) == 0 ? stat_buf.st_size : -1;
+  }
+
+  /** @return size bytes of the log, where byte i is i % 251 */
+  static auto MakeData(size_t offset, size_t size) -> std::vector<char> {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++) {
+      data[i] = static_cast<char>((offset + i) % 251);
+    }
+    return data;
+  }
+
+  size_t saved_segment_size_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogFileTest, SegmentTest) {
+  auto log = std::make_unique<LogFile>("test.log");
+  char buf[100];
+  EXPECT_FALSE(log->Read(buf, sizeof(buf), 0));
+  // Scenario: Nothing is created before the first write.
+  EXPECT_EQ(-1, FileSize("test.log"));
+  EXPECT_EQ(-1, FileSize(SegmentName(0)));
+
+  // Scenario: Writes fill the segments one after the other, and straddle them.
+  size_t size = 0;
+  for (size_t write_size : {1000, 4000, 3000}) {
+    auto data = MakeData(size, write_size);
+    log->Write(data.data(), data.size());
+    size += write_size;
+  }
+  EXPECT_EQ(size, log->GetEnd());
+  auto all = std::vector<char>(size + 100);
+  ASSERT_TRUE(log->Read(all.data(), all.size(), 0));
+  auto expected = MakeData(0, size);
+  EXPECT_EQ(0, memcmp(expected.data(), all.data(), size));
+  EXPECT_EQ(std::vector<char>(100, 0), std::vector<char>(all.begin() + size, all.end()));
+  EXPECT_FALSE(log->Read(buf, sizeof(buf), size));
+
+  // Scenario: Every segment has its full size from the start, the one after the end included.
+  log.reset();
+  for (size_t segment = 0; segment <= size / SEGMENT_SIZE + 1; segment++) {
+    EXPECT_EQ(SEGMENT_SIZE, FileSize(SegmentName(segment)));
+  }
+  EXPECT_EQ(-1, FileSize(SegmentName(size / SEGMENT_SIZE + 2)));
+
+  // Scenario: A log opened again without being told where it ends appends in a new segment, after the old ones.
+  log_segment_size = 2 * SEGMENT_SIZE;
+  log = std::make_unique<LogFile>("test.log");
+  EXPECT_EQ(SEGMENT_SIZE, log->GetSegmentSize());
+  EXPECT_EQ((size / SEGMENT_SIZE + 2) * SEGMENT_SIZE, log->GetEnd());
+
+  // Scenario: Recovery sets the end, which zeros what follows it in its segment, and appends go there.
+  log->SetEnd(5000);
+  EXPECT_EQ(5000, log->GetEnd());
+  auto data = MakeData(5000, 10);
+  log->Write(data.data(), data.size());
+  log.reset();
+  std::vector<char> segment(SEGMENT_SIZE);
+  FILE *file = fopen(SegmentName(1).c_str(), "rb");
+  ASSERT_NE(nullptr, file);
+  ASSERT_EQ(SEGMENT_SIZE, fread(segment.data(), 1, SEGMENT_SIZE, file));
+  fclose(file);
+  expected = MakeData(SEGMENT_SIZE, 5010 - SEGMENT_SIZE);
+  EXPECT_EQ(0, memcmp(expected.data(), segment.data(), expected.size()));
+  EXPECT_EQ(std::vector<char>(segment.begin() + expected.size(), segment.end()),
+            std::vector<char>(SEGMENT_SIZE - expected.size(), 0));
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogFileTest, TruncateTest) {
+  auto log = std::make_unique<LogFile>("test.log");
+  auto data = MakeData(0, 5 * SEGMENT_SIZE + 100);
+  log->Write(data.data(), data.size());
+
+  // Scenario: Truncating within the first segment deletes nothing.
+  log->Truncate(100);
+  EXPECT_EQ(100, log->GetStart());
+  EXPECT_EQ(SEGMENT_SIZE, FileSize(SegmentName(0)));
+
+  // Scenario: Truncating further deletes the segments entirely before the new start, and only those.
+  log->Truncate(2 * SEGMENT_SIZE + 10);
+  EXPECT_EQ(2 * SEGMENT_SIZE + 10, log->GetStart());
+  EXPECT_EQ(-1, FileSize(SegmentName(0)));
+  EXPECT_EQ(-1, FileSize(SegmentName(1)));
+  EXPECT_EQ(SEGMENT_SIZE, FileSize(SegmentName(2)));
+
+  // Scenario: The log cannot be truncated backwards, nor past its end.
+  log->Truncate(SEGMENT_SIZE);
+  log->Truncate(6 * SEGMENT_SIZE);
+  EXPECT_EQ(2 * SEGMENT_SIZE + 10, log->GetStart());
+
+  // Scenario: The start survives reopening, and the log reads the same from there on.
+  log.reset();
+  log = std::make_unique<LogFile>("test.log");
+  EXPECT_EQ(2 * SEGMENT_SIZE + 10, log->GetStart());
+  log->SetEnd(data.size());
+  std::vector<char> buf(data.size() - log->GetStart());
+  ASSERT_TRUE(log->Read(buf.data(), buf.size(), log->GetStart()));
+  EXPECT_EQ(0, memcmp(data.data() + log->GetStart(), buf.data(), buf.size()));
+
+  // Scenario: Removing the log deletes all its files.
+  log.reset();
+  LogFile::Remove("test.log");
+  EXPECT_EQ(-1, FileSize("test.log"));
+  for (size_t segment = 0; segment < 8; segment++) {
+    EXPECT_EQ(-1, FileSize(SegmentName(segment)));
+  }
+}
+
+}  // namespace bustub
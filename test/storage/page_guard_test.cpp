@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
 
@@ -82,7 +83,7 @@ TEST(PageGuardTest, SampleTest) {
   // auto NewPageWrite = bpm->FetchPageWrite(0);
   // auto NewPageWrite1 = bpm->FetchPageWrite(0);
 
-  auto *page0 = bpm->NewPage(&page_id_temp);
+  [[maybe_unused]] auto *page0 = bpm->NewPage(&page_id_temp);
   auto *page1 = bpm->NewPage(&page_id_temp);
   // auto *page2 = bpm->NewPage(&page_id_temp);
 
@@ -109,4 +110,53 @@ TEST(PageGuardTest, SampleTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
 }
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticTest) {
+  const size_t buffer_pool_size = 5;
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "hello");
+  bpm->UnpinPage(page_id, true);
+
+  // Scenario: without writers, an optimistic read validates and the guard holds a pin but no latch.
+  {
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(guard.GetData(), "hello"));
+    EXPECT_TRUE(guard.Validate());
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    EXPECT_FALSE(guard.Validate());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: a write that started before the guard was taken, or completed since, fails validation.
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    EXPECT_FALSE(guard.Validate());
+  }
+  auto guard = bpm->FetchPageOptimistic(page_id);
+  { auto write_guard = bpm->FetchPageWrite(page_id); }
+  EXPECT_FALSE(guard.Validate());
+  ReadPageGuard read_guard;
+  EXPECT_FALSE(guard.TryUpgradeRead(&read_guard));
+
+  // Scenario: upgrading an unchanged page hands the pin over to a read guard, which excludes writers.
+  guard = bpm->FetchPageOptimistic(page_id);
+  EXPECT_EQ(1, page->GetPinCount());
+  ASSERT_TRUE(guard.TryUpgradeRead(&read_guard));
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_EQ(0, strcmp(read_guard.GetData(), "hello"));
+  auto other_guard = bpm->FetchPageOptimistic(page_id);
+  EXPECT_TRUE(other_guard.Validate());
+  other_guard.Drop();
+  read_guard.Drop();
+  EXPECT_EQ(0, page->GetPinCount());
+
+  disk_manager->ShutDown();
+}
 }  // namespace bustub
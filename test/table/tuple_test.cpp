@@ -56,6 +56,7 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   disk_manager->ShutDown();
   remove("test.db");  // remove db file
   remove("test.log");
+  remove("test.fsm");
   delete table;
   delete buffer_pool_manager;
   delete disk_manager;
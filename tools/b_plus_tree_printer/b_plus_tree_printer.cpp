@@ -133,6 +133,7 @@ auto main(int argc, char **argv) -> int {
   delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fsm");
 
   return 0;
 }
@@ -14,6 +14,7 @@
 #include "binder/binder.h"
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -60,6 +61,7 @@ struct BpmTotalMetrics {
     auto get_per_sec = get_cnt_ / static_cast<double>(elsped) * 1000;
 
     fmt::print("<<< BEGIN\n");
+    fmt::print("page_size: {}\n", bustub::BUSTUB_PAGE_SIZE);
     fmt::print("scan: {}\n", scan_per_sec);
     fmt::print("get: {}\n", get_per_sec);
     fmt::print(">>> END\n");
@@ -103,13 +105,21 @@ struct BpmMetrics {
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
+  using bustub::BufferPool;
   using bustub::BufferPoolManager;
   using bustub::DiskManagerUnlimitedMemory;
+  using bustub::HugePageMode;
+  using bustub::ParallelBufferPoolManager;
+  using bustub::ReplacerType;
   using bustub::page_id_t;
 
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
   program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--bpm-instances").help("partition the buffer pool into n instances");
+  program.add_argument("--replacer").help("replacement policy: lru-k (default), lru, clock, 2q or arc");
+  program.add_argument("--huge-pages").help("back the frames with huge pages: none, thp (default) or explicit");
+  program.add_argument("--numa").help("place the frames on a NUMA node: a node number or interleave");
 
   try {
     program.parse_args(argc, argv);
@@ -129,12 +139,68 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
+  size_t bpm_instances = 1;
+  if (program.present("--bpm-instances")) {
+    bpm_instances = std::stoi(program.get("--bpm-instances"));
+  }
+
+  std::string replacer = "lru-k";
+  if (program.present("--replacer")) {
+    replacer = program.get("--replacer");
+  }
+  ReplacerType replacer_type;
+  if (replacer == "lru-k") {
+    replacer_type = ReplacerType::LRUK;
+  } else if (replacer == "lru") {
+    replacer_type = ReplacerType::LRU;
+  } else if (replacer == "clock") {
+    replacer_type = ReplacerType::Clock;
+  } else if (replacer == "2q") {
+    replacer_type = ReplacerType::TwoQueue;
+  } else if (replacer == "arc") {
+    replacer_type = ReplacerType::ARC;
+  } else {
+    std::cerr << "unknown replacer " << replacer << std::endl;
+    return 1;
+  }
+
+  std::string huge_pages = "thp";
+  if (program.present("--huge-pages")) {
+    huge_pages = program.get("--huge-pages");
+  }
+  if (huge_pages == "none") {
+    bustub::frame_huge_pages = HugePageMode::None;
+  } else if (huge_pages == "thp") {
+    bustub::frame_huge_pages = HugePageMode::Transparent;
+  } else if (huge_pages == "explicit") {
+    bustub::frame_huge_pages = HugePageMode::Explicit;
+  } else {
+    std::cerr << "unknown huge page mode " << huge_pages << std::endl;
+    return 1;
+  }
+
+  std::string numa = "default";
+  if (program.present("--numa")) {
+    numa = program.get("--numa");
+    bustub::frame_numa_node = numa == "interleave" ? bustub::NUMA_INTERLEAVE : std::stoi(numa);
+  }
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  std::unique_ptr<BufferPool> bpm;
+  if (bpm_instances > 1) {
+    // Keep the total number of frames the same as with a single instance.
+    bpm = std::make_unique<ParallelBufferPoolManager>(bpm_instances, BUSTUB_BPM_SIZE / bpm_instances,
+                                                      disk_manager.get(), LRU_K_SIZE, nullptr, replacer_type);
+  } else {
+    bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr, replacer_type);
+  }
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, page_size={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, "
+             "bpm_instances={}, replacer={}, huge_pages={}, numa={}\n",
+             BUSTUB_PAGE_CNT, bustub::BUSTUB_PAGE_SIZE, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE,
+             bpm_instances, replacer, huge_pages, numa);
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -149,8 +215,9 @@ auto main(int argc, char **argv) -> int {
     page_ids.push_back(page_id);
   }
 
-  // enable disk latency after creating all pages
+  // enable disk latency after creating all pages, and only count what the benchmark does
   disk_manager->SetLatency(latency_ms);
+  bpm->ResetStats();
 
   fmt::print(stderr, "[info] benchmark start\n");
 
@@ -227,6 +294,7 @@ auto main(int argc, char **argv) -> int {
   }
 
   total_metrics.Report();
+  fmt::print(stderr, "[info] bpm stats:\n{}\n", bpm->GetStats().ToString());
 
   return 0;
 }
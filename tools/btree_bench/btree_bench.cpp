@@ -64,6 +64,7 @@ struct BTreeTotalMetrics {
     auto read_per_sec = read_cnt_ / static_cast<double>(elsped) * 1000;
 
     fmt::print("<<< BEGIN\n");
+    fmt::print("page_size: {}\n", bustub::BUSTUB_PAGE_SIZE);
     fmt::print("write: {}\n", write_per_sec);
     fmt::print("read: {}\n", read_per_sec);
     fmt::print(">>> END\n");
@@ -136,8 +137,8 @@ auto main(int argc, char **argv) -> int {
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
   auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] total_keys={}, page_size={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS,
+             bustub::BUSTUB_PAGE_SIZE, duration_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// commit_bench.cpp
+//
+// Identification: tools/commit_bench/commit_bench.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/core.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+
+// Measures how many transactions per second can commit durably. Every commit waits for its commit record to be synced
+// to the log; with group commit, transactions committing at the same time share one sync. `--serial` commits one
+// transaction at a time instead, so that every commit pays for its own sync.
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::DiskManager;
+  using bustub::LockManager;
+  using bustub::LogFile;
+  using bustub::LogManager;
+  using bustub::TransactionManager;
+
+  argparse::ArgumentParser program("bustub-commit-bench");
+  program.add_argument("--duration").help("run commit bench for n milliseconds");
+  program.add_argument("--threads").help("number of committing threads");
+  program.add_argument("--db").help("database file, the log goes next to it");
+  program.add_argument("--serial").help("commit one transaction at a time").default_value(false).implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 10000;
+  if (program.present("--duration")) {
+    duration_ms = std::stoi(program.get("--duration"));
+  }
+
+  size_t num_threads = 8;
+  if (program.present("--threads")) {
+    num_threads = std::stoi(program.get("--threads"));
+  }
+
+  std::string db_file = "commit_bench.db";
+  if (program.present("--db")) {
+    db_file = program.get("--db");
+  }
+  std::string log_file = db_file.substr(0, db_file.rfind('.')) + ".log";
+  std::string fsm_file = db_file.substr(0, db_file.rfind('.')) + ".fsm";
+
+  bool serial = program.get<bool>("--serial");
+
+  fmt::print(stderr, "[info] duration_ms={}, threads={}, db={}, serial={}\n", duration_ms, num_threads, db_file,
+             serial);
+
+  auto disk_manager = std::make_unique<DiskManager>(db_file);
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  auto lock_manager = std::make_unique<LockManager>();
+  auto txn_manager = std::make_unique<TransactionManager>(lock_manager.get(), log_manager.get());
+  log_manager->RunFlushThread();
+
+  fmt::print(stderr, "[info] benchmark start\n");
+
+  std::mutex serial_latch;
+  std::atomic<uint64_t> commits{0};
+  std::atomic<uint64_t> total_latency_us{0};
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + std::chrono::milliseconds(duration_ms);
+
+  std::vector<std::thread> threads;
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&] {
+      uint64_t thread_commits = 0;
+      uint64_t thread_latency_us = 0;
+      while (std::chrono::steady_clock::now() < deadline) {
+        auto begin = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(serial_latch, std::defer_lock);
+        if (serial) {
+          lock.lock();
+        }
+        auto *txn = txn_manager->Begin();
+        txn_manager->Commit(txn);
+        if (serial) {
+          lock.unlock();
+        }
+        delete txn;
+        thread_latency_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - begin)
+                                 .count();
+        thread_commits++;
+      }
+      commits += thread_commits;
+      total_latency_us += thread_latency_us;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+  log_manager->StopFlushThread();
+  int flushes = disk_manager->GetNumFlushes();
+  fmt::print(stderr, "[info] commits={}, log_flushes={}\n", commits.load(), flushes);
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("commits_per_sec: {:.1f}\n", commits / static_cast<double>(elapsed_ms) * 1000);
+  fmt::print("commits_per_flush: {:.2f}\n", flushes == 0 ? 0 : commits / static_cast<double>(flushes));
+  fmt::print("avg_commit_latency_us: {:.1f}\n", commits == 0 ? 0 : total_latency_us / static_cast<double>(commits));
+  fmt::print(">>> END\n");
+
+  txn_manager.reset();
+  lock_manager.reset();
+  log_manager.reset();
+  disk_manager->ShutDown();
+  disk_manager.reset();
+  std::remove(db_file.c_str());
+  LogFile::Remove(log_file);
+  std::remove(fsm_file.c_str());
+  return 0;
+}
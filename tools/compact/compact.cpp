@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compact.cpp
+//
+// Identification: tools/compact/compact.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "argparse/argparse.hpp"
+#include "common/exception.h"
+#include "storage/disk/disk_manager.h"
+
+// Shrinks a database file by dropping the free pages at its end. The database must not be open elsewhere.
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-compact");
+  program.add_argument("db_file").help("the database file to compact, e.g. test.db");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto db_file = program.get("db_file");
+  if (!std::ifstream(db_file).good()) {
+    std::cerr << "cannot open " << db_file << std::endl;
+    return 1;
+  }
+
+  try {
+    bustub::DiskManager disk_manager(db_file);
+    auto *free_page_map = disk_manager.GetFreePageMap();
+    auto old_num_pages = free_page_map->GetNumPages();
+    auto num_pages = disk_manager.Compact();
+    std::cout << db_file << ": " << old_num_pages << " -> " << num_pages << " pages, "
+              << free_page_map->GetNumFreePages() << " free pages left" << std::endl;
+    disk_manager.ShutDown();
+  } catch (bustub::Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -175,6 +175,9 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   program.add_argument("--verbose").help("increase output verbosity").default_value(false).implicit_value(true);
   program.add_argument("-d", "--diff").help("write diff file").default_value(false).implicit_value(true);
   program.add_argument("--in-memory").help("use in-memory backend").default_value(false).implicit_value(true);
+  program.add_argument("--disk-manager")
+      .help("file backend of the database file: fstream, posix, direct, uring or mmap")
+      .default_value(std::string("fstream"));
   try {
     program.parse_args(argc, argv);
   } catch (const std::runtime_error &err) {
@@ -203,7 +206,21 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   if (program.get<bool>("--in-memory")) {
     bustub = std::make_unique<bustub::BustubInstance>();
   } else {
-    bustub = std::make_unique<bustub::BustubInstance>("test.db");
+    auto disk_manager = program.get<std::string>("--disk-manager");
+    auto disk_manager_type = bustub::DiskManagerType::FStream;
+    if (disk_manager == "posix") {
+      disk_manager_type = bustub::DiskManagerType::Posix;
+    } else if (disk_manager == "direct") {
+      disk_manager_type = bustub::DiskManagerType::PosixDirect;
+    } else if (disk_manager == "uring") {
+      disk_manager_type = bustub::DiskManagerType::IoUring;
+    } else if (disk_manager == "mmap") {
+      disk_manager_type = bustub::DiskManagerType::Mmap;
+    } else if (disk_manager != "fstream") {
+      std::cerr << "Unknown disk manager " << disk_manager << std::endl;
+      return 1;
+    }
+    bustub = std::make_unique<bustub::BustubInstance>("test.db", 1, disk_manager_type);
   }
 
   bustub->GenerateMockTable();
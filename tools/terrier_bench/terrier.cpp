@@ -60,6 +60,7 @@ struct TerrierTotalMetrics {
     auto update_txn_per_sec = committed_update_txn_cnt_ / static_cast<double>(elsped) * 1000;
 
     fmt::print("<<< BEGIN\n");
+    fmt::print("page_size: {}\n", bustub::BUSTUB_PAGE_SIZE);
     fmt::print("update: {}\n", update_txn_per_sec);
     fmt::print("count: {}\n", count_txn_per_sec);
     fmt::print(">>> END\n");